@@ -0,0 +1,172 @@
+#include "asyncstorepool_p.h"
+#include "datastore.h"
+#include "datastore_p.h"
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+
+using namespace QtDataSync;
+
+namespace {
+
+class LaneRunnable : public QRunnable
+{
+public:
+	LaneRunnable(std::function<void()> fn) :
+		_fn{std::move(fn)}
+	{}
+
+	void run() override {
+		_fn();
+	}
+
+private:
+	std::function<void()> _fn;
+};
+
+}
+
+Q_GLOBAL_STATIC(AsyncStorePool, asyncStorePool)
+
+const int AsyncStorePool::LaneCount = 16;
+
+AsyncStorePool::AsyncStorePool()
+{
+	_pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+	_pool.setExpiryTimeout(-1); //keep the threads, and with them their stores, alive
+	_lanes.reserve(LaneCount);
+	for(auto i = 0; i < LaneCount; i++)
+		_lanes.append(QSharedPointer<Lane>::create());
+}
+
+AsyncStorePool::~AsyncStorePool()
+{
+	_pool.waitForDone();
+}
+
+AsyncStorePool *AsyncStorePool::instance()
+{
+	return asyncStorePool;
+}
+
+void AsyncStorePool::enqueue(const QString &setupName, const ObjectKey &orderKey, Task task)
+{
+	//all tasks for the same key end up in the same lane, which runs them in order
+	auto lane = _lanes[static_cast<int>(qHash(orderKey) % LaneCount)].data();
+	QMutexLocker _(&lane->mutex);
+	lane->tasks.enqueue({setupName, std::move(task)});
+	if(!lane->running) {
+		lane->running = true;
+		_pool.start(new LaneRunnable{[this, lane](){
+			drain(lane);
+		}});
+	}
+}
+
+bool AsyncStorePool::dropStores(const QString &setupName)
+{
+	if(asyncStorePool.exists())
+		return asyncStorePool->releaseStores(setupName);
+	else
+		return false;
+}
+
+void AsyncStorePool::drain(AsyncStorePool::Lane *lane)
+{
+	//stores are kept per thread, so the database connections and statement caches stay open
+	auto &stores = _stores.localData();
+	sweepStores(stores);
+	forever {
+		QPair<QString, Task> next;
+		{
+			QMutexLocker _(&lane->mutex);
+			if(lane->tasks.isEmpty()) {
+				lane->running = false;
+				break;
+			}
+			next = lane->tasks.dequeue();
+		}
+		next.second(obtainStore(stores, next.first));
+	}
+}
+
+DataStore *AsyncStorePool::obtainStore(StoreHolder &stores, const QString &setupName)
+{
+	quint64 generation;
+	{
+		QMutexLocker _(&_storesMutex);
+		generation = _generations.value(setupName);
+	}
+
+	auto it = stores.find(setupName);
+	if(it != stores.end()) {
+		if(it->generation == generation)
+			return it->store;
+		//the setup was removed and possibly created again since
+		deleteStore(setupName, it->store);
+		stores.erase(it);
+	}
+
+	try {
+		auto store = new DataStore{setupName};
+		//the thread has no eventloop, so it must not receive change signals
+		store->d->store->detachChanges();
+		stores.insert(setupName, {store, generation});
+		QMutexLocker _(&_storesMutex);
+		_storeCounts[setupName]++;
+		return store;
+	} catch(QException &) {
+		return nullptr; //reported to the future by the task itself
+	}
+}
+
+void AsyncStorePool::sweepStores(StoreHolder &stores)
+{
+	//stores of removed setups are deleted lazily, by their own threads
+	for(auto it = stores.begin(); it != stores.end();) {
+		quint64 generation;
+		{
+			QMutexLocker _(&_storesMutex);
+			generation = _generations.value(it.key());
+		}
+		if(it->generation != generation) {
+			deleteStore(it.key(), it->store);
+			it = stores.erase(it);
+		} else
+			++it;
+	}
+}
+
+void AsyncStorePool::deleteStore(const QString &setupName, DataStore *store)
+{
+	delete store;
+	QMutexLocker _(&_storesMutex);
+	if(--_storeCounts[setupName] <= 0)
+		_storeCounts.remove(setupName);
+}
+
+bool AsyncStorePool::releaseStores(const QString &setupName)
+{
+	//never waits for the pool threads, they drop their stores before they run the next task.
+	//Idle threads are woken up to do so, but it is not guaranteed to reach every thread
+	QMutexLocker _(&_storesMutex);
+	_generations[setupName]++;
+	const auto pooled = _storeCounts.value(setupName) > 0;
+	_.unlock();
+	if(pooled) {
+		for(auto i = 0; i < _pool.maxThreadCount(); i++) {
+			_pool.start(new LaneRunnable{[this](){
+				sweepStores(_stores.localData());
+			}});
+		}
+	}
+	return pooled;
+}
+
+
+
+AsyncStorePool::StoreHolder::~StoreHolder()
+{
+	for(const auto &pooled : qAsConst(*this))
+		delete pooled.store;
+}
@@ -0,0 +1,72 @@
+#ifndef QTDATASYNC_ASYNCSTOREPOOL_P_H
+#define QTDATASYNC_ASYNCSTOREPOOL_P_H
+
+#include <functional>
+
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QThreadPool>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVector>
+#include <QtCore/QSharedPointer>
+
+#include "qtdatasync_global.h"
+#include "objectkey.h"
+
+namespace QtDataSync {
+
+class DataStore;
+
+//no export needed
+class AsyncStorePool
+{
+	Q_DISABLE_COPY(AsyncStorePool)
+
+public:
+	using Task = std::function<void(DataStore*)>;
+
+	AsyncStorePool();
+	~AsyncStorePool();
+
+	static AsyncStorePool *instance();
+
+	void enqueue(const QString &setupName, const ObjectKey &orderKey, Task task);
+	static bool dropStores(const QString &setupName);
+
+private:
+	static const int LaneCount;
+
+	struct Lane {
+		QMutex mutex;
+		QQueue<QPair<QString, Task>> tasks;
+		bool running = false;
+	};
+
+	struct PooledStore {
+		DataStore *store = nullptr;
+		quint64 generation = 0;
+	};
+
+	//stores are bound to the thread that created them, as their database connections are
+	struct StoreHolder : public QHash<QString, PooledStore>
+	{
+		~StoreHolder();
+	};
+
+	QThreadPool _pool;
+	QVector<QSharedPointer<Lane>> _lanes;
+	QThreadStorage<StoreHolder> _stores;
+	QMutex _storesMutex;
+	QHash<QString, quint64> _generations; //increased whenever a setup is removed
+	QHash<QString, int> _storeCounts; //the number of pooled stores per setup
+
+	void drain(Lane *lane);
+	DataStore *obtainStore(StoreHolder &stores, const QString &setupName);
+	void sweepStores(StoreHolder &stores);
+	void deleteStore(const QString &setupName, DataStore *store);
+	bool releaseStores(const QString &setupName);
+};
+
+}
+
+#endif // QTDATASYNC_ASYNCSTOREPOOL_P_H
@@ -51,6 +51,25 @@ void ChangeController::updateUploadLimit(quint32 limit)
 	_uploadLimit = static_cast<int>(limit);
 }
 
+void ChangeController::updatePayloadFormat(SyncHelper::PayloadFormat format)
+{
+	logDebug() << "Updated payload format to:" << (format == SyncHelper::CborPayload ? "cbor" : "json");
+	auto downgraded = _payloadFormat == SyncHelper::CborPayload &&
+					  format == SyncHelper::JsonPayload;
+	_payloadFormat = format;
+
+	//the server drops cbor changes it receives before the downgrade was confirmed -> upload them again
+	if(downgraded && _uploadingEnabled) {
+		for(auto it = _activeUploads.begin(); it != _activeUploads.end();) {
+			if(it.key().optionalDevice.isNull())
+				it = _activeUploads.erase(it);
+			else
+				++it;
+		}
+		uploadNext(false);
+	}
+}
+
 void ChangeController::uploadDone(const QByteArray &key)
 {
 	if(!_activeUploads.contains(key)) {
@@ -176,11 +195,12 @@ void ChangeController::uploadNext(bool emitStarted)
 				try {
 					auto json = _store->readJson(key, file);
 					if(deviceId.isNull()) {
-						emit uploadChange(keyHash, SyncHelper::combine(key, version, json));
+						emit uploadChange(keyHash, SyncHelper::combine(key, version, json, _payloadFormat));
 						logDebug() << "Started upload of changed" << key
 								   << "( Active uploads:" << _activeUploads.size() << ")";
 					} else {
-						emit uploadDeviceChange(keyHash, deviceId, SyncHelper::combine(key, version, json));
+						//device uploads are always json, as the target device may not have told the server its version yet
+						emit uploadDeviceChange(keyHash, deviceId, SyncHelper::combine(key, version, json, SyncHelper::JsonPayload));
 						logDebug() << "Started device upload of changed"
 								   << key << "for device" << deviceId
 								   << "( Active uploads:" << _activeUploads.size() << ")";
@@ -9,6 +9,7 @@
 #include "objectkey.h"
 #include "controller_p.h"
 #include "localstore_p.h"
+#include "synchelper_p.h"
 
 namespace QtDataSync {
 
@@ -54,6 +55,7 @@ public Q_SLOTS:
 	void setUploadingEnabled(bool uploading);
 	void clearUploads();
 	void updateUploadLimit(quint32 limit);
+	void updatePayloadFormat(QtDataSync::SyncHelper::PayloadFormat format);
 
 	void uploadDone(const QByteArray &key);
 	void deviceUploadDone(const QByteArray &key, QUuid deviceId);
@@ -79,6 +81,7 @@ private:
 	ChangeEmitter *_emitter = nullptr;
 	bool _uploadingEnabled = false;
 	int _uploadLimit = 10;
+	SyncHelper::PayloadFormat _payloadFormat = SyncHelper::JsonPayload;
 	QHash<CachedObjectKey, UploadInfo> _activeUploads;
 	quint32 _changeEstimate = 0;
 };
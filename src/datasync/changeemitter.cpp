@@ -3,28 +3,39 @@ using namespace QtDataSync;
 
 ChangeEmitter::ChangeEmitter(const Defaults &defaults, QObject *parent) :
 	ChangeEmitterSource{parent},
-	_cache{defaults.cacheHandle().value<QSharedPointer<EmitterAdapter::CacheInfo>>()}
-{}
+	_cache{defaults.cacheHandle().value<QSharedPointer<StoreCache>>()},
+	_flushTimer{new QTimer(this)}
+{
+	//collect all changes of one event loop iteration before notifying the stores
+	_flushTimer->setSingleShot(true);
+	_flushTimer->setInterval(0);
+	connect(_flushTimer, &QTimer::timeout,
+			this, &ChangeEmitter::flushChanges);
+}
 
 void ChangeEmitter::triggerChange(QObject *origin, const ObjectKey &key, bool deleted, bool changed)
 {
 	if(changed)
 		emit uploadNeeded();
-	emit dataChanged(origin, key, deleted);
-	emit remoteDataChanged(key, deleted);
+	enqueueChanges(origin, key.typeName, {key.id}, deleted);
+}
+
+void ChangeEmitter::triggerChanges(QObject *origin, const QByteArray &typeName, const QStringList &ids, bool deleted, bool changed)
+{
+	if(changed)
+		emit uploadNeeded();
+	enqueueChanges(origin, typeName, ids, deleted);
 }
 
 void ChangeEmitter::triggerClear(QObject *origin, const QByteArray &typeName, const QStringList &ids)
 {
 	emit uploadNeeded();
-	for(const auto &id : ids) {
-		emit dataChanged(origin, {typeName, id}, true);
-		emit remoteDataChanged({typeName, id}, true);
-	}
+	enqueueChanges(origin, typeName, ids, true);
 }
 
 void ChangeEmitter::triggerReset(QObject *origin)
 {
+	flushChanges();
 	emit uploadNeeded();
 	emit dataResetted(origin);
 	emit remoteDataResetted();
@@ -37,46 +48,70 @@ void ChangeEmitter::triggerUpload()
 
 void ChangeEmitter::triggerRemoteChange(const ObjectKey &key, bool deleted, bool changed)
 {
-	if(_cache) {
-		auto contains = false;
-		//check if cached
-		{
-			QReadLocker _(&_cache->lock);
-			contains = _cache->cache.contains(key);
-		}
-		//if chached, remove
-		if(contains) {
-			QWriteLocker _(&_cache->lock);
-			_cache->cache.remove(key);
-		}
-	}
+	if(_cache)
+		_cache->remove(key);
+	if(changed)
+		emit uploadNeeded();
+	enqueueChanges(nullptr, key.typeName, {key.id}, deleted);
+}
+
+void ChangeEmitter::triggerRemoteChanges(const QByteArray &typeName, const QStringList &ids, bool deleted, bool changed)
+{
+	if(_cache)
+		_cache->remove(typeName, ids);
 	if(changed)
 		emit uploadNeeded();
-	emit dataChanged(nullptr, key, deleted);
-	emit remoteDataChanged(key, deleted);
+	enqueueChanges(nullptr, typeName, ids, deleted);
 }
 
 void ChangeEmitter::triggerRemoteClear(const QByteArray &typeName, const QStringList &ids)
 {
-	if(_cache) {
-		QWriteLocker _(&_cache->lock);
-		for(const auto &id : ids)
-			_cache->cache.remove({typeName, id});
-	}
+	if(_cache)
+		_cache->remove(typeName, ids);
 	emit uploadNeeded();
-	for(const auto &id : ids) {
-		emit dataChanged(nullptr, {typeName, id}, true);
-		emit remoteDataChanged({typeName, id}, true);
-	}
+	enqueueChanges(nullptr, typeName, ids, true);
 }
 
 void ChangeEmitter::triggerRemoteReset()
 {
-	if(_cache) {
-		QWriteLocker _(&_cache->lock);
-		_cache->cache.clear();
-	}
+	if(_cache)
+		_cache->clear();
+	flushChanges();
 	emit uploadNeeded();
 	emit dataResetted(nullptr);
 	emit remoteDataResetted();
 }
+
+void ChangeEmitter::flushChanges()
+{
+	_flushTimer->stop();
+	const auto batches = std::move(_pendingBatches);
+	_pendingBatches.clear();
+	for(const auto &batch : batches) {
+		emit dataChanged(batch.origin, batch.typeName, batch.ids, batch.deleted);
+		emit remoteDataChanged(batch.typeName, batch.ids, batch.deleted);
+	}
+}
+
+void ChangeEmitter::enqueueChanges(QObject *origin, const QByteArray &typeName, const QStringList &ids, bool deleted)
+{
+	if(ids.isEmpty())
+		return;
+
+	//only merge with the last batch, so the order of the changes is kept
+	if(_pendingBatches.isEmpty() ||
+	   _pendingBatches.last().origin != origin ||
+	   _pendingBatches.last().typeName != typeName ||
+	   _pendingBatches.last().deleted != deleted)
+		_pendingBatches.append({origin, typeName, {}, {}, deleted});
+	auto &batch = _pendingBatches.last();
+	for(const auto &id : ids) {
+		if(!batch.idSet.contains(id)) {
+			batch.idSet.insert(id);
+			batch.ids.append(id);
+		}
+	}
+
+	if(!_flushTimer->isActive())
+		_flushTimer->start();
+}
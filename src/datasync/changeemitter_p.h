@@ -3,6 +3,8 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QJsonObject>
+#include <QtCore/QTimer>
+#include <QtCore/QSet>
 
 #include "qtdatasync_global.h"
 #include "defaults.h"
@@ -25,6 +27,11 @@ public Q_SLOTS:
 					   const QtDataSync::ObjectKey &key,
 					   bool deleted,
 					   bool changed);
+	void triggerChanges(QObject *origin,
+						const QByteArray &typeName,
+						const QStringList &ids,
+						bool deleted,
+						bool changed);
 	void triggerClear(QObject *origin, const QByteArray &typeName, const QStringList &ids);
 	void triggerReset(QObject *origin);
 	void triggerUpload() override;
@@ -32,17 +39,33 @@ public Q_SLOTS:
 Q_SIGNALS:
 	void uploadNeeded();
 
-	void dataChanged(QObject *origin, const QtDataSync::ObjectKey &key, bool deleted);
+	void dataChanged(QObject *origin, const QByteArray &typeName, const QStringList &ids, bool deleted);
 	void dataResetted(QObject *origin);
 
 protected Q_SLOTS:
 	//remcon interface
 	void triggerRemoteChange(const ObjectKey &key, bool deleted, bool changed) override;
+	void triggerRemoteChanges(const QByteArray &typeName, const QStringList &ids, bool deleted, bool changed) override;
 	void triggerRemoteClear(const QByteArray &typeName, const QStringList &ids) override;
 	void triggerRemoteReset() override;
 
+private Q_SLOTS:
+	void flushChanges();
+
 private:
-	QSharedPointer<EmitterAdapter::CacheInfo> _cache;//needed to clear cache on remote changes
+	struct PendingBatch {
+		QObject *origin;
+		QByteArray typeName;
+		QStringList ids;
+		QSet<QString> idSet;
+		bool deleted;
+	};
+
+	QSharedPointer<StoreCache> _cache;//needed to clear cache on remote changes
+	QTimer *_flushTimer;
+	QList<PendingBatch> _pendingBatches;
+
+	void enqueueChanges(QObject *origin, const QByteArray &typeName, const QStringList &ids, bool deleted);
 };
 
 }
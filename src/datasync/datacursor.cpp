@@ -0,0 +1,157 @@
+#include "datacursor.h"
+#include "datacursor_p.h"
+
+#include <QtJsonSerializer/QJsonSerializer>
+
+using namespace QtDataSync;
+
+#define QTDATASYNC_LOG logger
+
+const int DataCursorPrivate::DefaultChunkSize = 100;
+
+DataCursor::DataCursor(const Defaults &defaults, int metaTypeId, const QByteArray &typeName, QObject *parent) :
+	QObject{parent},
+	d{new DataCursorPrivate {
+		defaults,
+		defaults.createLogger("datacursor", this),
+		new LocalStore{defaults, this},
+		metaTypeId,
+		typeName
+	}}
+{}
+
+DataCursor::~DataCursor() = default;
+
+QString DataCursor::setupName() const
+{
+	return d->defaults.setupName();
+}
+
+int DataCursor::typeId() const
+{
+	return d->metaTypeId;
+}
+
+bool DataCursor::isValid() const
+{
+	return d->valid;
+}
+
+QString DataCursor::key() const
+{
+	return d->key;
+}
+
+QVariant DataCursor::value() const
+{
+	return d->value;
+}
+
+int DataCursor::chunkSize() const
+{
+	return d->chunkSize;
+}
+
+bool DataCursor::skipBroken() const
+{
+	return d->skipBroken;
+}
+
+bool DataCursor::next()
+{
+	auto wasValid = d->valid;
+	auto res = d->next();
+	if(res || wasValid)
+		emit positionChanged({});
+	return res;
+}
+
+void DataCursor::setChunkSize(int chunkSize)
+{
+	chunkSize = qMax(chunkSize, 1);
+	if(d->chunkSize == chunkSize)
+		return;
+
+	d->chunkSize = chunkSize;
+	emit chunkSizeChanged(d->chunkSize, {});
+}
+
+void DataCursor::setSkipBroken(bool skipBroken)
+{
+	if(d->skipBroken == skipBroken)
+		return;
+
+	d->skipBroken = skipBroken;
+	emit skipBrokenChanged(d->skipBroken, {});
+}
+
+// ------------- PRIVATE IMPLEMENTATION -------------
+
+DataCursorPrivate::DataCursorPrivate(Defaults defaults, Logger *logger, LocalStore *store, int metaTypeId, QByteArray typeName) :
+	defaults{std::move(defaults)},
+	logger{logger},
+	serializer{this->defaults.serializer()},
+	store{store},
+	metaTypeId{metaTypeId},
+	typeName{std::move(typeName)}
+{
+	//datasets that are already read but not yet reached might be outdated after a change
+	_changedConnection = QObject::connect(store, &LocalStore::dataChanged,
+										  store, [this](const ObjectKey &key) {
+		if(key.typeName == this->typeName)
+			dropChunk();
+	});
+	_resettedConnection = QObject::connect(store, &LocalStore::dataResetted,
+										   store, [this]() {
+		dropChunk();
+	});
+}
+
+DataCursorPrivate::~DataCursorPrivate()
+{
+	QObject::disconnect(_changedConnection);
+	QObject::disconnect(_resettedConnection);
+}
+
+bool DataCursorPrivate::next()
+{
+	valid = false;
+	key.clear();
+	value.clear();
+
+	forever {
+		//read the next chunk of raw datasets in a single transaction
+		if(_chunk.isEmpty()) {
+			if(_atEnd)
+				return false;
+			_chunk = store->loadChunk(typeName, _lastId, chunkSize);
+			if(_chunk.size() < chunkSize)
+				_atEnd = true;
+			if(_chunk.isEmpty())
+				return false;
+		}
+
+		//only deserialize the dataset the cursor is moved to
+		auto entry = _chunk.takeFirst();
+		_lastId = entry.id;
+		try {
+			if(entry.error)
+				entry.error->raise();
+			value = serializer->deserialize(entry.data, metaTypeId);
+			key = entry.id;
+			valid = true;
+			return true;
+		} catch(QException &e) {
+			if(!skipBroken)
+				throw;
+			logWarning() << "Ignoring error on store iteration:" << e.what();
+		}
+	}
+}
+
+void DataCursorPrivate::dropChunk()
+{
+	//the next chunk is read again, starting after the current dataset
+	_chunk.clear();
+	_atEnd = false;
+}
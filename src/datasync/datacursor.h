@@ -0,0 +1,83 @@
+#ifndef QTDATASYNC_DATACURSOR_H
+#define QTDATASYNC_DATACURSOR_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qvariant.h>
+
+#include "QtDataSync/qtdatasync_global.h"
+
+namespace QtDataSync {
+
+class Defaults;
+
+class DataCursorPrivate;
+//! A forward only cursor to stream over all datasets of a type
+class Q_DATASYNC_EXPORT DataCursor : public QObject
+{
+	Q_OBJECT
+
+	//! Holds the name of the setup this cursor operates on
+	Q_PROPERTY(QString setupName READ setupName CONSTANT)
+	//! Holds the QMetaType type id of the datasets this cursor iterates over
+	Q_PROPERTY(int typeId READ typeId CONSTANT)
+
+	//! Holds whether the cursor is positioned on a valid dataset
+	Q_PROPERTY(bool valid READ isValid NOTIFY positionChanged)
+	//! Holds the key of the dataset this cursor is positioned on
+	Q_PROPERTY(QString key READ key NOTIFY positionChanged)
+	//! Holds the dataset this cursor is positioned on
+	Q_PROPERTY(QVariant value READ value NOTIFY positionChanged)
+
+	//! The number of datasets read from the store at once
+	Q_PROPERTY(int chunkSize READ chunkSize WRITE setChunkSize NOTIFY chunkSizeChanged)
+	//! Specify if the cursor should skip datasets that cannot be loaded instead of throwing
+	Q_PROPERTY(bool skipBroken READ skipBroken WRITE setSkipBroken NOTIFY skipBrokenChanged)
+
+public:
+	~DataCursor() override;
+
+	//! @readAcFn{DataCursor::setupName}
+	QString setupName() const;
+	//! @readAcFn{DataCursor::typeId}
+	int typeId() const;
+
+	//! @readAcFn{DataCursor::valid}
+	bool isValid() const;
+	//! @readAcFn{DataCursor::key}
+	QString key() const;
+	//! @readAcFn{DataCursor::value}
+	QVariant value() const;
+
+	//! @readAcFn{DataCursor::chunkSize}
+	int chunkSize() const;
+	//! @readAcFn{DataCursor::skipBroken}
+	bool skipBroken() const;
+
+	//! Advances the cursor to the next dataset, if one exists
+	Q_INVOKABLE bool next();
+
+public Q_SLOTS:
+	//! @writeAcFn{DataCursor::chunkSize}
+	void setChunkSize(int chunkSize);
+	//! @writeAcFn{DataCursor::skipBroken}
+	void setSkipBroken(bool skipBroken);
+
+Q_SIGNALS:
+	//! @notifyAcFn{DataCursor::key}
+	void positionChanged(QPrivateSignal);
+	//! @notifyAcFn{DataCursor::chunkSize}
+	void chunkSizeChanged(int chunkSize, QPrivateSignal);
+	//! @notifyAcFn{DataCursor::skipBroken}
+	void skipBrokenChanged(bool skipBroken, QPrivateSignal);
+
+private:
+	friend class DataStore;
+	QScopedPointer<DataCursorPrivate> d;
+
+	explicit DataCursor(const Defaults &defaults, int metaTypeId, const QByteArray &typeName, QObject *parent = nullptr);
+};
+
+}
+
+#endif // QTDATASYNC_DATACURSOR_H
@@ -0,0 +1,55 @@
+#ifndef QTDATASYNC_DATACURSOR_P_H
+#define QTDATASYNC_DATACURSOR_P_H
+
+#include <QtCore/QPointer>
+
+#include "qtdatasync_global.h"
+#include "datacursor.h"
+#include "defaults.h"
+#include "logger.h"
+#include "localstore_p.h"
+
+namespace QtDataSync {
+
+//no export needed
+class DataCursorPrivate
+{
+public:
+	static const int DefaultChunkSize;
+
+	DataCursorPrivate(Defaults defaults,
+					  Logger *logger,
+					  LocalStore *store,
+					  int metaTypeId,
+					  QByteArray typeName);
+	~DataCursorPrivate();
+
+	bool next();
+
+	Defaults defaults;
+	Logger *logger;
+	QPointer<const QJsonSerializer> serializer;
+	LocalStore *store;
+	int metaTypeId;
+	QByteArray typeName;
+
+	int chunkSize = DefaultChunkSize;
+	bool skipBroken = false;
+
+	bool valid = false;
+	QString key;
+	QVariant value;
+
+private:
+	QList<LocalStore::ChunkEntry> _chunk;
+	QString _lastId;
+	bool _atEnd = false;
+	QMetaObject::Connection _changedConnection;
+	QMetaObject::Connection _resettedConnection;
+
+	void dropChunk();
+};
+
+}
+
+#endif // QTDATASYNC_DATACURSOR_P_H
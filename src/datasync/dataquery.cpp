@@ -0,0 +1,74 @@
+#include "dataquery.h"
+#include "dataquery_p.h"
+using namespace QtDataSync;
+
+DataQuery::DataQuery() :
+	d{new DataQueryPrivate{}}
+{}
+
+DataQuery::DataQuery(const DataQuery &other) = default;
+
+DataQuery::DataQuery(DataQuery &&other) noexcept = default;
+
+DataQuery::~DataQuery() = default;
+
+DataQuery &DataQuery::operator=(const DataQuery &other) = default;
+
+DataQuery &DataQuery::operator=(DataQuery &&other) noexcept = default;
+
+DataQuery &DataQuery::where(const QString &property, const QVariant &value)
+{
+	return where(property, Equal, value);
+}
+
+DataQuery &DataQuery::where(const QString &property, DataQuery::Operator op, const QVariant &value)
+{
+	d->conditions.append({property, op, value});
+	return *this;
+}
+
+DataQuery &DataQuery::orderBy(const QString &property, Qt::SortOrder order)
+{
+	d->sortOrders.append({property, order});
+	return *this;
+}
+
+DataQuery &DataQuery::setLimit(int limit)
+{
+	d->limit = limit;
+	return *this;
+}
+
+DataQuery &DataQuery::setOffset(int offset)
+{
+	d->offset = offset;
+	return *this;
+}
+
+QList<DataQuery::Condition> DataQuery::conditions() const
+{
+	return d->conditions;
+}
+
+QList<DataQuery::SortOrder> DataQuery::sortOrders() const
+{
+	return d->sortOrders;
+}
+
+int DataQuery::limit() const
+{
+	return d->limit;
+}
+
+int DataQuery::offset() const
+{
+	return d->offset;
+}
+
+
+
+DataQueryPrivate::DataQueryPrivate() :
+	QSharedData{}
+{}
+
+DataQueryPrivate::DataQueryPrivate(const DataQueryPrivate &other) = default;
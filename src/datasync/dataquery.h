@@ -0,0 +1,87 @@
+#ifndef QTDATASYNC_DATAQUERY_H
+#define QTDATASYNC_DATAQUERY_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qvariant.h>
+
+#include "QtDataSync/qtdatasync_global.h"
+
+namespace QtDataSync {
+
+class DataQueryPrivate;
+//! A query on the datasets of a type that is evaluated by the local database
+class Q_DATASYNC_EXPORT DataQuery
+{
+	Q_GADGET
+
+public:
+	//! The comparison operators that can be used for conditions
+	enum Operator {
+		Equal, //!< The property must equal the value
+		NotEqual, //!< The property must not equal the value
+		Less, //!< The property must be less than the value
+		LessEqual, //!< The property must be less than or equal to the value
+		Greater, //!< The property must be greater than the value
+		GreaterEqual, //!< The property must be greater than or equal to the value
+		Like //!< The property must match the value as SQL LIKE pattern (with % and _)
+	};
+	Q_ENUM(Operator)
+
+	//! A single condition of a query
+	struct Condition {
+		//! The name of the indexed property to be compared
+		QString property;
+		//! The operator used to compare the property with the value
+		Operator op;
+		//! The value to compare the property with
+		QVariant value;
+	};
+
+	//! Typedef for a single sort order of a query
+	using SortOrder = QPair<QString, Qt::SortOrder>;
+
+	//! Default constructor
+	DataQuery();
+	//! Copy constructor
+	DataQuery(const DataQuery &other);
+	//! Move constructor
+	DataQuery(DataQuery &&other) noexcept;
+	~DataQuery();
+
+	//! Copy-Assignment operator
+	DataQuery &operator=(const DataQuery &other);
+	//! Move-Assignment operator
+	DataQuery &operator=(DataQuery &&other) noexcept;
+
+	//! Adds a condition that the given property must equal the value
+	DataQuery &where(const QString &property, const QVariant &value);
+	//! Adds a condition that compares the given property with the value
+	DataQuery &where(const QString &property, Operator op, const QVariant &value);
+	//! Adds a sort order by the given property
+	DataQuery &orderBy(const QString &property, Qt::SortOrder order = Qt::AscendingOrder);
+	//! Limits the number of datasets returned by the query
+	DataQuery &setLimit(int limit);
+	//! Skips the given number of datasets before returning any
+	DataQuery &setOffset(int offset);
+
+	//! Returns all conditions of the query
+	QList<Condition> conditions() const;
+	//! Returns all sort orders of the query, in order of priority
+	QList<SortOrder> sortOrders() const;
+	//! Returns the maximum number of datasets returned by the query, or -1 if unlimited
+	int limit() const;
+	//! Returns the number of datasets skipped by the query
+	int offset() const;
+
+private:
+	QSharedDataPointer<DataQueryPrivate> d;
+};
+
+}
+
+Q_DECLARE_METATYPE(QtDataSync::DataQuery)
+Q_DECLARE_TYPEINFO(QtDataSync::DataQuery, Q_MOVABLE_TYPE);
+
+#endif // QTDATASYNC_DATAQUERY_H
@@ -0,0 +1,24 @@
+#ifndef QTDATASYNC_DATAQUERY_P_H
+#define QTDATASYNC_DATAQUERY_P_H
+
+#include "qtdatasync_global.h"
+#include "dataquery.h"
+
+namespace QtDataSync {
+
+//no export needed
+class DataQueryPrivate : public QSharedData
+{
+public:
+	DataQueryPrivate();
+	DataQueryPrivate(const DataQueryPrivate &other);
+
+	QList<DataQuery::Condition> conditions;
+	QList<DataQuery::SortOrder> sortOrders;
+	int limit = -1;
+	int offset = 0;
+};
+
+}
+
+#endif // QTDATASYNC_DATAQUERY_P_H
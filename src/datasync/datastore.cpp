@@ -1,6 +1,10 @@
 #include "datastore.h"
 #include "datastore_p.h"
 #include "defaults_p.h"
+#include "datacursor_p.h"
+#include "asyncstorepool_p.h"
+
+#include <QtCore/QMetaProperty>
 
 #include <QtJsonSerializer/QJsonSerializer>
 
@@ -39,8 +43,17 @@ void DataStore::initStore(const QString &setupName)
 			this, [this](const ObjectKey &key, bool deleted) {
 		emit dataChanged(QMetaType::type(key.typeName), key.id, deleted, {});
 	});
+	connect(d->store, &LocalStore::dataChangedBatch,
+			this, [this](const QByteArray &typeName, const QStringList &ids, bool deleted) {
+		emit dataChangedBatch(QMetaType::type(typeName), ids, deleted, {});
+		updateCount(typeName);
+	});
 	connect(d->store, &LocalStore::dataResetted,
-			this, PSIG(&DataStore::dataResetted));
+			this, [this]() {
+		emit dataResetted({});
+		for(const auto &typeName : d->counts.keys())
+			updateCount(typeName);
+	});
 }
 
 DataStore::~DataStore() = default;
@@ -72,44 +85,55 @@ bool DataStore::contains(int metaTypeId, const QString &key) const
 
 QVariant DataStore::load(int metaTypeId, const QString &key) const
 {
-	auto data = d->store->load({d->typeName(metaTypeId), key});
-	return d->serializer->deserialize(data, metaTypeId);
+	const ObjectKey objKey{d->typeName(metaTypeId), key};
+	QVariant value;
+	if(d->store->loadCachedValue(objKey, metaTypeId, value))
+		return value;
+
+	auto data = d->store->load(objKey);
+	value = d->serializer->deserialize(data, metaTypeId);
+	d->store->cacheValue(objKey, data, metaTypeId, value);
+	return value;
 }
 
-void DataStore::save(int metaTypeId, QVariant value)
+QVariantMap DataStore::loadProperties(int metaTypeId, const QString &key, const QStringList &properties) const
 {
 	auto typeName = d->typeName(metaTypeId);
-	if(!value.convert(metaTypeId))
-		throw InvalidDataException(d->defaults, typeName, QStringLiteral("Failed to convert passed variant to the target type"));
-
-	auto meta = QMetaType::metaObjectForType(metaTypeId);
-	if(!meta)
+	auto metaObject = QMetaType::metaObjectForType(metaTypeId);
+	if(!metaObject)
 		throw InvalidDataException(d->defaults, typeName, QStringLiteral("Type does not have a meta object"));
-	auto userProp = meta->userProperty();
-	if(!userProp.isValid())
-		throw InvalidDataException(d->defaults, typeName, QStringLiteral("Type does not have a user property"));
 
+	//only the requested values are extracted from the stored data, the object itself is never created
+	const auto json = d->store->loadProperties({typeName, key}, properties);
+	QVariantMap resMap;
+	for(auto it = json.constBegin(); it != json.constEnd(); it++) {
+		auto pIndex = metaObject->indexOfProperty(qUtf8Printable(it.key()));
+		if(pIndex == -1)
+			continue;
+		resMap.insert(it.key(), d->serializer->deserialize(it.value(), metaObject->property(pIndex).userType()));
+	}
+	return resMap;
+}
+
+void DataStore::save(int metaTypeId, QVariant value)
+{
+	auto typeName = d->typeName(metaTypeId);
 	QString key;
-	auto flags = QMetaType::typeFlags(metaTypeId);
-	if(flags.testFlag(QMetaType::IsGadget))
-		key = userProp.readOnGadget(value.data()).toString();
-	else if(flags.testFlag(QMetaType::PointerToQObject))
-		key = userProp.read(value.value<QObject*>()).toString();
-	else if(flags.testFlag(QMetaType::SharedPointerToQObject))
-		key = userProp.read(value.value<QSharedPointer<QObject>>().data()).toString();
-	else if(flags.testFlag(QMetaType::WeakPointerToQObject))
-		key = userProp.read(value.value<QWeakPointer<QObject>>().data()).toString();
-	else if(flags.testFlag(QMetaType::TrackingPointerToQObject))
-		key = userProp.read(value.value<QPointer<QObject>>().data()).toString();
-	else
-		throw InvalidDataException(d->defaults, typeName, QStringLiteral("Type is neither a gadget nor a pointer to an object"));
+	auto json = d->serialize(metaTypeId, typeName, std::move(value), key);
+	d->store->save({typeName, key}, json);
+}
 
-	if(key.isEmpty())
-		throw InvalidDataException(d->defaults, typeName, QStringLiteral("Failed to convert USER property to a string"));
-	auto json = d->serializer->serialize(value);
-	if(!json.isObject())
-		throw InvalidDataException(d->defaults, typeName, QStringLiteral("Serialization converted to invalid json type. Only json objects are allowed"));
-	d->store->save({typeName, key}, json.toObject());
+void DataStore::saveAll(int metaTypeId, const QVariantList &values)
+{
+	auto typeName = d->typeName(metaTypeId);
+	QHash<QString, QJsonObject> data;
+	data.reserve(values.size());
+	for(const auto &value : values) {
+		QString key;
+		auto json = d->serialize(metaTypeId, typeName, value, key);
+		data.insert(key, json);
+	}
+	d->store->saveAll(typeName, data);
 }
 
 bool DataStore::remove(int metaTypeId, const QString &key)
@@ -117,6 +141,11 @@ bool DataStore::remove(int metaTypeId, const QString &key)
 	return d->store->remove({d->typeName(metaTypeId), key});
 }
 
+int DataStore::removeAll(int metaTypeId, const QStringList &keys)
+{
+	return d->store->removeAll(d->typeName(metaTypeId), keys);
+}
+
 void DataStore::update(int metaTypeId, QObject *object) const
 {
 	auto typeName = d->typeName(metaTypeId);
@@ -156,6 +185,51 @@ QVariantList DataStore::search(int metaTypeId, const QString &query, SearchMode
 	return resList;
 }
 
+QList<DataStore::SearchMatch> DataStore::searchMatches(int metaTypeId, const QString &query, int limit) const
+{
+	return d->store->fullTextMatches(d->typeName(metaTypeId), query, limit);
+}
+
+QStringList DataStore::keysByIndex(int metaTypeId, const QString &property, const QVariant &value) const
+{
+	return d->store->indexedKeys(d->typeName(metaTypeId), property, value);
+}
+
+QVariantList DataStore::loadByIndex(int metaTypeId, const QString &property, const QVariant &value) const
+{
+	const auto dataList = d->store->loadIndexed(d->typeName(metaTypeId), property, value);
+	QVariantList resList;
+	resList.reserve(dataList.size());
+	for(const auto &val : dataList)
+		resList.append(d->serializer->deserialize(val, metaTypeId));
+	return resList;
+}
+
+quint64 DataStore::count(int metaTypeId, const DataQuery &query) const
+{
+	return d->store->count(d->typeName(metaTypeId), query);
+}
+
+QStringList DataStore::keys(int metaTypeId, const DataQuery &query) const
+{
+	return d->store->keys(d->typeName(metaTypeId), query);
+}
+
+QVariantList DataStore::query(int metaTypeId, const DataQuery &query) const
+{
+	const auto dataList = d->store->query(d->typeName(metaTypeId), query);
+	QVariantList resList;
+	resList.reserve(dataList.size());
+	for(const auto &val : dataList)
+		resList.append(d->serializer->deserialize(val, metaTypeId));
+	return resList;
+}
+
+DataCursor *DataStore::cursor(int metaTypeId, QObject *parent) const
+{
+	return new DataCursor{d->defaults, metaTypeId, d->typeName(metaTypeId), parent};
+}
+
 void DataStore::iterate(int metaTypeId, const function<bool (QVariant)> &iterator) const
 {
 	iterate(metaTypeId, iterator, false);
@@ -163,12 +237,13 @@ void DataStore::iterate(int metaTypeId, const function<bool (QVariant)> &iterato
 
 void DataStore::iterate(int metaTypeId, const std::function<bool (QVariant)> &iterator, bool skipBroken) const
 {
-	for(const auto &key : keys(metaTypeId)) { // clazy:exclude=range-loop
+	//stream the datasets in chunks instead of loading them one by one
+	DataCursorPrivate cursor{d->defaults, d->logger, d->store, metaTypeId, d->typeName(metaTypeId)};
+	cursor.skipBroken = skipBroken;
+	while(cursor.next()) {
 		try {
-			if(!iterator(load(metaTypeId, key)))
+			if(!iterator(cursor.value))
 				break;
-		} catch(NoDataException &) {
-			//no data is not considered an error in this scenario
 		} catch (QException &e) {
 			if(skipBroken)
 				logWarning() << "Ignoring error on store iteration:" << e.what();
@@ -178,11 +253,106 @@ void DataStore::iterate(int metaTypeId, const std::function<bool (QVariant)> &it
 	}
 }
 
+void DataStore::updateCount(const QByteArray &typeName)
+{
+	//counts are only reported to someone who is interested in them
+	if(!isSignalConnected(QMetaMethod::fromSignal(&DataStore::countChanged)))
+		return;
+
+	try {
+		const auto count = static_cast<qint64>(d->store->count(typeName));
+		auto it = d->counts.find(typeName);
+		if(it != d->counts.end() && *it == count)
+			return;
+		d->counts.insert(typeName, count);
+		emit countChanged(QMetaType::type(typeName), count, {});
+	} catch(QException &e) {
+		logWarning() << "Failed to update count of type" << typeName
+					 << "with error:" << e.what();
+	}
+}
+
 void DataStore::clear(int metaTypeId)
 {
 	d->store->clear(d->typeName(metaTypeId));
 }
 
+DataStore::CacheStatistics DataStore::cacheStatistics(int metaTypeId) const
+{
+	return d->store->cacheStatistics(d->typeName(metaTypeId));
+}
+
+QFuture<qint64> DataStore::countAsync(int metaTypeId) const
+{
+	return runAsync<qint64>(ObjectKey{d->typeName(metaTypeId)}, [metaTypeId](DataStore *store) {
+		return store->count(metaTypeId);
+	});
+}
+
+QFuture<QStringList> DataStore::keysAsync(int metaTypeId) const
+{
+	return runAsync<QStringList>(ObjectKey{d->typeName(metaTypeId)}, [metaTypeId](DataStore *store) {
+		return store->keys(metaTypeId);
+	});
+}
+
+QFuture<QVariantList> DataStore::loadAllAsync(int metaTypeId) const
+{
+	return runAsync<QVariantList>(ObjectKey{d->typeName(metaTypeId)}, [metaTypeId](DataStore *store) {
+		return store->loadAll(metaTypeId);
+	});
+}
+
+QFuture<QVariant> DataStore::loadAsync(int metaTypeId, const QString &key) const
+{
+	return runAsync<QVariant>(ObjectKey{d->typeName(metaTypeId), key}, [metaTypeId, key](DataStore *store) {
+		return store->load(metaTypeId, key);
+	});
+}
+
+QFuture<void> DataStore::saveAsync(int metaTypeId, QVariant value)
+{
+	//serialize on the calling thread, as the value might not be safe to access from others
+	auto typeName = d->typeName(metaTypeId);
+	QString key;
+	auto json = d->serialize(metaTypeId, typeName, std::move(value), key);
+	return runAsync<void>(ObjectKey{typeName, key}, [typeName, key, json](DataStore *store) {
+		store->d->store->save({typeName, key}, json);
+	});
+}
+
+QFuture<bool> DataStore::removeAsync(int metaTypeId, const QString &key)
+{
+	return runAsync<bool>(ObjectKey{d->typeName(metaTypeId), key}, [metaTypeId, key](DataStore *store) {
+		return store->remove(metaTypeId, key);
+	});
+}
+
+QFuture<QVariantList> DataStore::searchAsync(int metaTypeId, const QString &query, SearchMode mode) const
+{
+	return runAsync<QVariantList>(ObjectKey{d->typeName(metaTypeId)}, [metaTypeId, query, mode](DataStore *store) {
+		return store->search(metaTypeId, query, mode);
+	});
+}
+
+void DataStore::enqueueAsync(const ObjectKey &orderKey, std::function<void(DataStore*)> task) const
+{
+	AsyncStorePool::instance()->enqueue(d->defaults.setupName(), orderKey, std::move(task));
+}
+
+void __helpertypes::moveToThread(QVariant &value, QThread *thread)
+{
+	auto flags = QMetaType::typeFlags(value.userType());
+	if(flags.testFlag(QMetaType::PointerToQObject)) {
+		auto object = value.value<QObject*>();
+		if(object)
+			object->moveToThread(thread);
+	} else if(value.userType() == QMetaType::QVariantList) {
+		auto list = value.toList();
+		moveToThread(list, thread);
+	}
+}
+
 // ------------- PRIVATE IMPLEMENTATION -------------
 
 DataStorePrivate::DataStorePrivate(DataStore *q, const QString &setupName) :
@@ -201,6 +371,40 @@ QByteArray DataStorePrivate::typeName(int metaTypeId) const
 		throw InvalidDataException(defaults, "type_" + QByteArray::number(metaTypeId), QStringLiteral("Not a valid metatype id"));
 }
 
+QJsonObject DataStorePrivate::serialize(int metaTypeId, const QByteArray &typeName, QVariant value, QString &key) const
+{
+	if(!value.convert(metaTypeId))
+		throw InvalidDataException(defaults, typeName, QStringLiteral("Failed to convert passed variant to the target type"));
+
+	auto meta = QMetaType::metaObjectForType(metaTypeId);
+	if(!meta)
+		throw InvalidDataException(defaults, typeName, QStringLiteral("Type does not have a meta object"));
+	auto userProp = meta->userProperty();
+	if(!userProp.isValid())
+		throw InvalidDataException(defaults, typeName, QStringLiteral("Type does not have a user property"));
+
+	auto flags = QMetaType::typeFlags(metaTypeId);
+	if(flags.testFlag(QMetaType::IsGadget))
+		key = userProp.readOnGadget(value.data()).toString();
+	else if(flags.testFlag(QMetaType::PointerToQObject))
+		key = userProp.read(value.value<QObject*>()).toString();
+	else if(flags.testFlag(QMetaType::SharedPointerToQObject))
+		key = userProp.read(value.value<QSharedPointer<QObject>>().data()).toString();
+	else if(flags.testFlag(QMetaType::WeakPointerToQObject))
+		key = userProp.read(value.value<QWeakPointer<QObject>>().data()).toString();
+	else if(flags.testFlag(QMetaType::TrackingPointerToQObject))
+		key = userProp.read(value.value<QPointer<QObject>>().data()).toString();
+	else
+		throw InvalidDataException(defaults, typeName, QStringLiteral("Type is neither a gadget nor a pointer to an object"));
+
+	if(key.isEmpty())
+		throw InvalidDataException(defaults, typeName, QStringLiteral("Failed to convert USER property to a string"));
+	auto json = serializer->serialize(value);
+	if(!json.isObject())
+		throw InvalidDataException(defaults, typeName, QStringLiteral("Serialization converted to invalid json type. Only json objects are allowed"));
+	return json.toObject();
+}
+
 // ------------- Exceptions -------------
 
 DataStoreException::DataStoreException(const Defaults &defaults, const QString &message) :
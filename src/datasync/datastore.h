@@ -6,11 +6,16 @@
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
 #include <QtCore/qvariant.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qfutureinterface.h>
+#include <QtCore/qthread.h>
 
 #include "QtDataSync/qtdatasync_global.h"
 #include "QtDataSync/objectkey.h"
 #include "QtDataSync/exception.h"
 #include "QtDataSync/qtdatasync_helpertypes.h"
+#include "QtDataSync/dataquery.h"
+#include "QtDataSync/datacursor.h"
 
 namespace QtDataSync {
 
@@ -22,6 +27,9 @@ class Q_DATASYNC_EXPORT DataStore : public QObject
 {
 	Q_OBJECT
 	friend class DataStoreModel;
+	friend class DataStoreModelPrivate;
+	friend class AsyncStorePool;
+	friend class CachingDataTypeStoreBase;
 
 public:
 	//! Possible pattern modes for the search mechanism
@@ -31,10 +39,27 @@ public:
 		WildcardMode, //!< Interpret the search string as a wildcard string (with * and ?)
 		ContainsMode, //!< The data key must contain the search string
 		StartsWithMode, //!< The data key must start with the search string
-		EndsWithMode //!< The data key must end with the search string
+		EndsWithMode, //!< The data key must end with the search string
+		FullTextMode //!< Match the search string as full text query against the full text properties of the type
 	};
 	Q_ENUM(SearchMode)
 
+	//! A single ranked result of a full text search
+	struct SearchMatch {
+		QString key; //!< The key of the matching dataset
+		QString snippet; //!< An excerpt of the matched text with the matches highlighted
+		double rank; //!< The relevance of the match. Lower values are better matches
+	};
+
+	//! Usage statistics of the dataset cache for a single type
+	struct CacheStatistics {
+		quint64 hits; //!< The number of loads that were served from the cache
+		quint64 misses; //!< The number of loads that had to read the database
+		quint64 evictions; //!< The number of datasets dropped to make room for others
+		qint64 residentBytes; //!< The estimated memory currently used by the cached datasets
+		int entries; //!< The number of currently cached datasets
+	};
+
 	//! Default constructor, uses the default setup
 	explicit DataStore(QObject *parent = nullptr);
 	//! Constructor with an explicit setup
@@ -62,18 +87,42 @@ public:
 	inline QVariant load(int metaTypeId, const QVariant &key) const {
 		return load(metaTypeId, key.toString());
 	}
+	//! @copybrief DataStore::loadProperties(const QString &, const QStringList &) const
+	QVariantMap loadProperties(int metaTypeId, const QString &key, const QStringList &properties) const;
+	//! @copybrief DataStore::loadProperties(const QString &, const QStringList &) const
+	inline QVariantMap loadProperties(int metaTypeId, const QVariant &key, const QStringList &properties) const {
+		return loadProperties(metaTypeId, key.toString(), properties);
+	}
 	//! @copybrief DataStore::save(const T &)
 	void save(int metaTypeId, QVariant value);
+	//! @copybrief DataStore::saveAll(const QList<T> &)
+	void saveAll(int metaTypeId, const QVariantList &values);
 	//! @copybrief DataStore::remove(const QString &)
 	bool remove(int metaTypeId, const QString &key);
 	//! @copybrief DataStore::remove(int, const QString &)
 	inline bool remove(int metaTypeId, const QVariant &key) {
 		return remove(metaTypeId, key.toString());
 	}
+	//! @copybrief DataStore::removeAll(const QStringList &)
+	int removeAll(int metaTypeId, const QStringList &keys);
 	//! @copybrief DataStore::update(T) const
 	void update(int metaTypeId, QObject *object) const;
 	//! @copybrief DataStore::search(const QString &, SearchMode) const
 	QVariantList search(int metaTypeId, const QString &query, SearchMode mode = RegexpMode) const;
+	//! @copybrief DataStore::searchMatches(const QString &, int) const
+	QList<SearchMatch> searchMatches(int metaTypeId, const QString &query, int limit = -1) const;
+	//! @copybrief DataStore::keysByIndex(const QString &, const QVariant &) const
+	QStringList keysByIndex(int metaTypeId, const QString &property, const QVariant &value) const;
+	//! @copybrief DataStore::loadByIndex(const QString &, const QVariant &) const
+	QVariantList loadByIndex(int metaTypeId, const QString &property, const QVariant &value) const;
+	//! @copybrief DataStore::count(const DataQuery &) const
+	quint64 count(int metaTypeId, const DataQuery &query) const;
+	//! @copybrief DataStore::keys(const DataQuery &) const
+	QStringList keys(int metaTypeId, const DataQuery &query) const;
+	//! @copybrief DataStore::query(const DataQuery &) const
+	QVariantList query(int metaTypeId, const DataQuery &query) const;
+	//! @copybrief DataStore::cursor(QObject *) const
+	DataCursor *cursor(int metaTypeId, QObject *parent = nullptr) const;
 	//! @copybrief DataStore::iterate(const std::function<bool(T)> &, bool) const
 	void iterate(int metaTypeId,
 				 const std::function<bool(QVariant)> &iterator) const;
@@ -83,6 +132,23 @@ public:
 				 bool skipBroken) const; //MAJOR merge overloads
 	//! @copybrief DataStore::clear()
 	void clear(int metaTypeId);
+	//! @copybrief DataStore::cacheStatistics() const
+	CacheStatistics cacheStatistics(int metaTypeId) const;
+
+	//! @copybrief DataStore::countAsync() const
+	QFuture<qint64> countAsync(int metaTypeId) const;
+	//! @copybrief DataStore::keysAsync() const
+	QFuture<QStringList> keysAsync(int metaTypeId) const;
+	//! @copybrief DataStore::loadAllAsync() const
+	QFuture<QVariantList> loadAllAsync(int metaTypeId) const;
+	//! @copybrief DataStore::loadAsync(const QString &) const
+	QFuture<QVariant> loadAsync(int metaTypeId, const QString &key) const;
+	//! @copybrief DataStore::saveAsync(const T &)
+	QFuture<void> saveAsync(int metaTypeId, QVariant value);
+	//! @copybrief DataStore::removeAsync(const QString &)
+	QFuture<bool> removeAsync(int metaTypeId, const QString &key);
+	//! @copybrief DataStore::searchAsync(const QString &, SearchMode) const
+	QFuture<QVariantList> searchAsync(int metaTypeId, const QString &query, SearchMode mode = RegexpMode) const;
 
 	//! Counts the number of datasets for the given type
 	template<typename T>
@@ -112,35 +178,100 @@ public:
 	//! @copybrief DataStore::load(const QString &) const
 	template<typename T, typename K>
 	T load(const K &key) const;
+	//! Loads only the given properties of the dataset with the given key for the given type
+	template<typename T>
+	QVariantMap loadProperties(const QString &key, const QStringList &properties) const;
+	//! @copybrief DataStore::loadProperties(const QString &, const QStringList &) const
+	template<typename T, typename K>
+	QVariantMap loadProperties(const K &key, const QStringList &properties) const;
 	//! Saves the given dataset in the store
 	template<typename T>
 	void save(const T &value);
+	//! Saves all of the given datasets in the store at once
+	template<typename T>
+	void saveAll(const QList<T> &values);
 	//! Removes the dataset with the given key for the given type
 	template<typename T>
 	bool remove(const QString &key);
 	//! @copybrief DataStore::remove(const QString &)
 	template<typename T, typename K>
 	bool remove(const K &key);
+	//! Removes all datasets with the given keys for the given type at once
+	template<typename T>
+	int removeAll(const QStringList &keys);
+	//! @copybrief DataStore::removeAll(const QStringList &)
+	template<typename T, typename K>
+	int removeAll(const QList<K> &keys);
 	//! Loads the dataset with the given key for the given type into the existing object by updating it's properties
 	template<typename T>
 	void update(T object) const;
 	//! Searches the store for datasets of the given type where the key matches the query
 	template<typename T>
 	QList<T> search(const QString &query, SearchMode mode = RegexpMode) const;
+	//! Returns the ranked matches of a full text search for datasets of the given type
+	template<typename T>
+	QList<SearchMatch> searchMatches(const QString &query, int limit = -1) const;
+	//! Returns the keys of all datasets of the given type where the indexed property has the given value
+	template<typename T>
+	QStringList keysByIndex(const QString &property, const QVariant &value) const;
+	//! Loads all datasets of the given type where the indexed property has the given value
+	template<typename T>
+	QList<T> loadByIndex(const QString &property, const QVariant &value) const;
+	//! Counts the number of datasets of the given type that match the query
+	template<typename T>
+	quint64 count(const DataQuery &query) const;
+	//! Returns the keys of all datasets of the given type that match the query
+	template<typename T>
+	QStringList keys(const DataQuery &query) const;
+	//! Loads all datasets of the given type that match the query
+	template<typename T>
+	QList<T> query(const DataQuery &query) const;
+	//! Creates a cursor to stream over all existing datasets of the given type
+	template<typename T>
+	DataCursor *cursor(QObject *parent = nullptr) const;
 	//! Iterates over all existing datasets of the given types
 	template<typename T>
 	void iterate(const std::function<bool(T)> &iterator, bool skipBroken = false) const;
 	//! Removes all datasets of the given type from the store
 	template<typename T>
 	void clear();
+	//! Returns the usage statistics of the dataset cache for the given type
+	template<typename T>
+	CacheStatistics cacheStatistics() const;
+
+	//! Asynchronously counts the number of datasets for the given type
+	template<typename T>
+	QFuture<qint64> countAsync() const;
+	//! Asynchronously returns all saved keys for the given type
+	template<typename T>
+	QFuture<QStringList> keysAsync() const;
+	//! Asynchronously loads all existing datasets for the given type
+	template<typename T>
+	QFuture<QList<T>> loadAllAsync() const;
+	//! Asynchronously loads the dataset with the given key for the given type
+	template<typename T>
+	QFuture<T> loadAsync(const QString &key) const;
+	//! Asynchronously saves the given dataset in the store
+	template<typename T>
+	QFuture<void> saveAsync(const T &value);
+	//! Asynchronously removes the dataset with the given key for the given type
+	template<typename T>
+	QFuture<bool> removeAsync(const QString &key);
+	//! Asynchronously searches the store for datasets of the given type where the key matches the query
+	template<typename T>
+	QFuture<QList<T>> searchAsync(const QString &query, SearchMode mode = RegexpMode) const;
 
 Q_SIGNALS:
 	//! Is emitted whenever a dataset has been changed
 	void dataChanged(int metaTypeId, const QString &key, bool deleted, QPrivateSignal);
+	//! Is emitted once for a group of datasets that have been changed together
+	void dataChangedBatch(int metaTypeId, const QStringList &keys, bool deleted, QPrivateSignal);
 	//! Is emitted when a datatypes has been cleared
 	Q_DECL_DEPRECATED void dataCleared(int metaTypeId, QPrivateSignal);
 	//! Is emitted when the store is resetted due to an account reset
 	void dataResetted(QPrivateSignal);
+	//! Is emitted when the number of datasets of a type has changed
+	void countChanged(int metaTypeId, qint64 count, QPrivateSignal);
 
 protected:
 	//! @private
@@ -150,6 +281,11 @@ protected:
 
 private:
 	QScopedPointer<DataStorePrivate> d;
+
+	void enqueueAsync(const ObjectKey &orderKey, std::function<void(DataStore*)> task) const;
+	void updateCount(const QByteArray &typeName);
+	template <typename TResult, typename TFunc>
+	QFuture<TResult> runAsync(const ObjectKey &orderKey, TFunc func) const;
 };
 
 
@@ -301,6 +437,20 @@ T DataStore::load(const K &key) const
 	return load(qMetaTypeId<T>(), QVariant::fromValue(key)).template value<T>();
 }
 
+template<typename T>
+QVariantMap DataStore::loadProperties(const QString &key, const QStringList &properties) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return loadProperties(qMetaTypeId<T>(), key, properties);
+}
+
+template<typename T, typename K>
+QVariantMap DataStore::loadProperties(const K &key, const QStringList &properties) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return loadProperties(qMetaTypeId<T>(), QVariant::fromValue(key), properties);
+}
+
 template<typename T>
 void DataStore::save(const T &value)
 {
@@ -308,6 +458,17 @@ void DataStore::save(const T &value)
 	save(qMetaTypeId<T>(), QVariant::fromValue(value));
 }
 
+template<typename T>
+void DataStore::saveAll(const QList<T> &values)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	QVariantList vList;
+	vList.reserve(values.size());
+	for(const auto &value : values)
+		vList.append(QVariant::fromValue(value));
+	saveAll(qMetaTypeId<T>(), vList);
+}
+
 template<typename T>
 bool DataStore::remove(const QString &key)
 {
@@ -322,6 +483,24 @@ bool DataStore::remove(const K &key)
 	return remove(qMetaTypeId<T>(), QVariant::fromValue(key));
 }
 
+template<typename T>
+int DataStore::removeAll(const QStringList &keys)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return removeAll(qMetaTypeId<T>(), keys);
+}
+
+template<typename T, typename K>
+int DataStore::removeAll(const QList<K> &keys)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	QStringList sList;
+	sList.reserve(keys.size());
+	for(const auto &key : keys)
+		sList.append(QVariant::fromValue(key).toString());
+	return removeAll(qMetaTypeId<T>(), sList);
+}
+
 template<typename T>
 void DataStore::update(T object) const
 {
@@ -339,6 +518,61 @@ QList<T> DataStore::search(const QString &query, SearchMode mode) const
 	return rList;
 }
 
+template<typename T>
+QList<DataStore::SearchMatch> DataStore::searchMatches(const QString &query, int limit) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return searchMatches(qMetaTypeId<T>(), query, limit);
+}
+
+template<typename T>
+QStringList DataStore::keysByIndex(const QString &property, const QVariant &value) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return keysByIndex(qMetaTypeId<T>(), property, value);
+}
+
+template<typename T>
+QList<T> DataStore::loadByIndex(const QString &property, const QVariant &value) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	QList<T> rList;
+	for(auto v : loadByIndex(qMetaTypeId<T>(), property, value))
+		rList.append(v.template value<T>());
+	return rList;
+}
+
+template<typename T>
+quint64 DataStore::count(const DataQuery &query) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return count(qMetaTypeId<T>(), query);
+}
+
+template<typename T>
+QStringList DataStore::keys(const DataQuery &query) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return keys(qMetaTypeId<T>(), query);
+}
+
+template<typename T>
+QList<T> DataStore::query(const DataQuery &query) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	QList<T> rList;
+	for(auto v : this->query(qMetaTypeId<T>(), query))
+		rList.append(v.template value<T>());
+	return rList;
+}
+
+template<typename T>
+DataCursor *DataStore::cursor(QObject *parent) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return cursor(qMetaTypeId<T>(), parent);
+}
+
 template<typename T>
 void DataStore::iterate(const std::function<bool (T)> &iterator, bool skipBroken) const
 {
@@ -355,6 +589,96 @@ void DataStore::clear()
 	clear(qMetaTypeId<T>());
 }
 
+template<typename T>
+DataStore::CacheStatistics DataStore::cacheStatistics() const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return cacheStatistics(qMetaTypeId<T>());
+}
+
+template<typename T>
+QFuture<qint64> DataStore::countAsync() const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return countAsync(qMetaTypeId<T>());
+}
+
+template<typename T>
+QFuture<QStringList> DataStore::keysAsync() const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return keysAsync(qMetaTypeId<T>());
+}
+
+template<typename T>
+QFuture<QList<T>> DataStore::loadAllAsync() const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return runAsync<QList<T>>(ObjectKey{QMetaType::typeName(qMetaTypeId<T>())}, [](DataStore *store) {
+		return store->template loadAll<T>();
+	});
+}
+
+template<typename T>
+QFuture<T> DataStore::loadAsync(const QString &key) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return runAsync<T>(ObjectKey{QMetaType::typeName(qMetaTypeId<T>()), key}, [key](DataStore *store) {
+		return store->template load<T>(key);
+	});
+}
+
+template<typename T>
+QFuture<void> DataStore::saveAsync(const T &value)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return saveAsync(qMetaTypeId<T>(), QVariant::fromValue(value));
+}
+
+template<typename T>
+QFuture<bool> DataStore::removeAsync(const QString &key)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return removeAsync(qMetaTypeId<T>(), key);
+}
+
+template<typename T>
+QFuture<QList<T>> DataStore::searchAsync(const QString &query, SearchMode mode) const
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return runAsync<QList<T>>(ObjectKey{QMetaType::typeName(qMetaTypeId<T>())}, [query, mode](DataStore *store) {
+		return store->template search<T>(query, mode);
+	});
+}
+
+template <typename TResult, typename TFunc>
+QFuture<TResult> DataStore::runAsync(const ObjectKey &orderKey, TFunc func) const
+{
+	QFutureInterface<TResult> futureInterface;
+	futureInterface.reportStarted();
+	auto thread = QThread::currentThread();
+	auto setup = setupName();
+	enqueueAsync(orderKey, [futureInterface, thread, setup, func](DataStore *store) mutable {
+		try {
+			if(!store)
+				throw SetupDoesNotExistException{setup};
+			if constexpr (std::is_void<TResult>::value)
+				func(store);
+			else {
+				auto result = func(store);
+				__helpertypes::moveToThread(result, thread);
+				futureInterface.reportResult(result);
+			}
+		} catch(QException &e) {
+			futureInterface.reportException(e);
+		} catch(...) {
+			futureInterface.reportException(QUnhandledException{});
+		}
+		futureInterface.reportFinished();
+	});
+	return futureInterface.future();
+}
+
 }
 
 #endif // QTDATASYNC_DATASTORE_H
@@ -18,12 +18,14 @@ public:
 	DataStorePrivate(DataStore *q, const QString &setupName);
 
 	QByteArray typeName(int metaTypeId) const;
+	QJsonObject serialize(int metaTypeId, const QByteArray &typeName, QVariant value, QString &key) const;
 
 	Defaults defaults;
 	Logger *logger;
 	QPointer<const QJsonSerializer> serializer;
 
 	LocalStore *store;
+	QHash<QByteArray, qint64> counts;
 };
 
 }
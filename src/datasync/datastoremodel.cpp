@@ -2,7 +2,12 @@
 #include "datastoremodel_p.h"
 #include "datastore_p.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <QtCore/QMetaProperty>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QVector>
 
 using namespace QtDataSync;
 
@@ -33,7 +38,7 @@ DataStoreModel::DataStoreModel(QObject *parent, void *):
 void DataStoreModel::initStore(DataStore *store)
 {
 	d->store = store;
-	QObject::connect(d->store, &DataStore::dataChanged,
+	QObject::connect(d->store, &DataStore::dataChangedBatch,
 					 this, &DataStoreModel::storeChanged);
 	QObject::connect(d->store, &DataStore::dataResetted,
 					 this, &DataStoreModel::storeResetted);
@@ -61,6 +66,41 @@ bool DataStoreModel::isEditable() const
 	return d->editable;
 }
 
+bool DataStoreModel::isProjected() const
+{
+	return d->projected;
+}
+
+int DataStoreModel::windowSize() const
+{
+	return d->windowSize;
+}
+
+int DataStoreModel::sortRole() const
+{
+	return d->sortRole;
+}
+
+Qt::SortOrder DataStoreModel::sortOrder() const
+{
+	return d->sortOrder;
+}
+
+int DataStoreModel::filterRole() const
+{
+	return d->filterRole;
+}
+
+QVariant DataStoreModel::filterValue() const
+{
+	return d->filterValue;
+}
+
+DataQuery::Operator DataStoreModel::filterOperator() const
+{
+	return d->filterOperator;
+}
+
 QVariant DataStoreModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
 	if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
@@ -81,7 +121,7 @@ int DataStoreModel::rowCount(const QModelIndex &parent) const
 	if(parent.isValid())
 		return 0;
 	else
-		return d->dataHash.size();
+		return d->fetchedRows;
 }
 
 int DataStoreModel::columnCount(const QModelIndex &parent) const
@@ -97,34 +137,108 @@ bool DataStoreModel::canFetchMore(const QModelIndex &parent) const
 	if(parent.isValid())
 		return false;
 	else
-		return d->dataHash.size() < d->keyList.size();
+		return d->fetchedRows < d->keyList.size();
 }
 
 void DataStoreModel::fetchMore(const QModelIndex &parent)
 {
-	if(d->isFetching)
+	if(d->isFetching) {
+		d->fetchPending = true;
 		return;
-	if(canFetchMore(parent)) {
-		d->isFetching = true;
+	}
+	if(!canFetchMore(parent))
+		return;
+
+	//load the next entries on the async store pool and insert them once they are ready
+	d->isFetching = true;
+	d->staleKeys.clear();
+	const auto keys = d->keyList.mid(d->fetchedRows, DataStoreModelPrivate::FetchSize);
+	const auto type = d->type;
+	const auto properties = d->projectedProperties();
+	const auto generation = d->generation;
+
+	auto watcher = new QFutureWatcher<QVariantList>{this};
+	QObject::connect(watcher, &QFutureWatcherBase::finished,
+					 this, [this, watcher, keys, generation]() {
+		watcher->deleteLater();
+		QVariantList values;
 		try {
-			//load 100 at once
-			auto offset = d->dataHash.size();
-			auto max = qMin(offset + 100, d->keyList.size());
-			QVariantHash loadData;
-
-			for(auto i = offset; i < max; i++) {
-				auto key = d->keyList.value(i);
-				loadData.insert(key, d->store->load(d->type, key));
+			values = watcher->result();
+		} catch(QException &e) {
+			if(generation == d->generation) {
+				d->isFetching = false;
+				emit storeError(e, {});
 			}
+			return;
+		}
 
-			beginInsertRows(parent, offset, max - 1);
-			d->dataHash.unite(loadData);//no duplicates thanks to logic
-			endInsertRows();
-		} catch(QException &e) {
-			emit storeError(e, {});
+		//the model was reset in the meantime
+		if(generation != d->generation) {
+			for(const auto &value : qAsConst(values))
+				d->deleteObject(value);
+			return;
 		}
 		d->isFetching = false;
-	}
+
+		//entries that changed during the fetch are outdated and are fetched again later
+		QVariantHash loaded;
+		for(auto i = 0; i < keys.size(); i++) {
+			if(d->staleKeys.contains(keys[i]))
+				d->deleteObject(values.value(i));
+			else
+				loaded.insert(keys[i], values.value(i));
+		}
+		d->staleKeys.clear();
+
+		const auto offset = d->fetchedRows;
+		auto count = 0;
+		while(offset + count < d->keyList.size() &&
+			  loaded.contains(d->keyList[offset + count]))
+			count++;
+		if(count > 0) {
+			beginInsertRows(QModelIndex(), offset, offset + count - 1);
+			for(auto i = offset; i < offset + count; i++)
+				d->dataHash.insert(d->keyList[i], loaded.take(d->keyList[i]));
+			d->fetchedRows += count;
+			if(d->windowSize > 0) //fetches are triggered by views that reached the end
+				d->windowCenter = offset;
+			endInsertRows();
+		}
+		for(const auto &value : qAsConst(loaded))
+			d->deleteObject(value);
+		d->trimWindow();
+
+		if(d->fetchPending) {
+			d->fetchPending = false;
+			fetchMore(QModelIndex());
+		}
+	});
+	watcher->setFuture(d->store->runAsync<QVariantList>(ObjectKey{d->store->d->typeName(type)},
+														 [type, keys, properties](DataStore *store) {
+		return DataStoreModelPrivate::loadEntries(store, type, keys, properties);
+	}));
+}
+
+void DataStoreModel::sort(int column, Qt::SortOrder order)
+{
+	//sort by the property displayed in the column
+	auto property = d->roleMapping.value(column).value(Qt::DisplayRole);
+	auto role = property.isEmpty() ? Qt::DisplayRole : d->roleNames.key(property, -1);
+	if(role == -1)
+		return;
+
+	const auto roleChanged = d->sortRole != role;
+	const auto orderChanged = d->sortOrder != order;
+	if(!roleChanged && !orderChanged)
+		return;
+
+	d->sortRole = role;
+	d->sortOrder = order;
+	reload();
+	if(roleChanged)
+		emit sortRoleChanged(role, {});
+	if(orderChanged)
+		emit sortOrderChanged(order, {});
 }
 
 QModelIndex DataStoreModel::index(int row, int column, const QModelIndex &parent) const
@@ -134,8 +248,8 @@ QModelIndex DataStoreModel::index(int row, int column, const QModelIndex &parent
 
 QModelIndex DataStoreModel::idIndex(const QString &id) const
 {
-	auto idx = d->activeKeys().indexOf(id);
-	if(idx != -1)
+	auto idx = d->keyIndex.value(id, -1);
+	if(idx != -1 && idx < d->fetchedRows)
 		return index(idx);
 	else
 		return {};
@@ -147,12 +261,11 @@ QString DataStoreModel::key(const QModelIndex &index) const
 	if(!checkIndex(index, CheckIndexOption::ParentIsInvalid | CheckIndexOption::IndexIsValid))
 		return {};
 	else
-		return d->activeKeys().value(index.row());
+		return d->keyList.value(index.row());
 #else
-	const auto active = d->activeKeys();
 	if(index.isValid() &&
-	   index.row() < active.size())
-		return active[index.row()];
+	   index.row() < d->fetchedRows)
+		return d->keyList[index.row()];
 	else
 		return {};
 #endif
@@ -167,7 +280,7 @@ QVariant DataStoreModel::data(const QModelIndex &index, int role) const
 	if (!d->testRoleValid(index, role))
 		return {};
 
-	return d->readProperty(key(index), d->propertyName(index, role));
+	return d->readProperty(key(index), d->property(index, role));
 }
 
 bool DataStoreModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -179,7 +292,7 @@ bool DataStoreModel::setData(const QModelIndex &index, const QVariant &value, in
 	if (!d->editable || !d->testRoleValid(index, role))
 		return false;
 
-	if(d->writeProperty(key(index), d->propertyName(index, role), value)) {
+	if(d->writeProperty(key(index), d->property(index, role), value)) {
 		emit dataChanged(index, index, {role});
 		return true;
 	} else
@@ -189,7 +302,10 @@ bool DataStoreModel::setData(const QModelIndex &index, const QVariant &value, in
 QVariant DataStoreModel::object(const QModelIndex &index) const
 {
 	// index check is done in key method
-	return d->dataHash.value(key(index));
+	if(d->projected)
+		return loadObject(index);
+	else
+		return d->entry(key(index));
 }
 
 QVariant DataStoreModel::loadObject(const QModelIndex &index) const
@@ -241,7 +357,9 @@ void DataStoreModel::addRole(int column, int role, const char *propertyName)
 {
 	Q_ASSERT_X(column < d->columns.size(), Q_FUNC_INFO, "Cannot add role to non existant column!");
 	d->roleMapping[column].insert(role, propertyName);
-	if(!d->dataHash.isEmpty())
+	if(d->metaObject)
+		d->columnProperties[column].insert(role, d->resolveProperty(propertyName));
+	if(d->fetchedRows > 0)
 		emit dataChanged(this->index(0, column), this->index(rowCount() - 1, column), {role});
 }
 
@@ -252,6 +370,7 @@ void DataStoreModel::clearColumns()
 		beginRemoveColumns({}, 1, d->columns.size() - 1);
 	d->columns.clear();
 	d->roleMapping.clear();
+	d->columnProperties.clear();
 	if(cColumns)
 		endRemoveColumns();
 }
@@ -271,14 +390,15 @@ void DataStoreModel::setTypeId(int typeId, bool resetColumns)
 
 		beginResetModel();
 		d->isObject = flags.testFlag(QMetaType::PointerToQObject);
-		d->keyList.clear();
+		d->resetKeys();
 		if(resetColumns)
 			clearColumns();
 		d->clearHashObjects();
 		d->createRoleNames();
+		d->resolveColumns();
 
 		try {
-			d->keyList = d->store->keys(typeId);
+			d->resetKeys(d->queryKeys());
 			endResetModel();
 		} catch(...) {
 			endResetModel();
@@ -297,13 +417,91 @@ void DataStoreModel::setEditable(bool editable)
 	emit editableChanged(editable, {});
 }
 
+void DataStoreModel::setProjected(bool projected)
+{
+	if(d->projected == projected)
+		return;
+
+	//drop all loaded entries, they are fetched again in the new mode
+	beginResetModel();
+	d->clearHashObjects();
+	d->resetKeys(d->keyList);
+	d->projected = projected;
+	endResetModel();
+	emit projectedChanged(projected, {});
+}
+
+void DataStoreModel::setWindowSize(int windowSize)
+{
+	windowSize = qMax(0, windowSize);
+	if(d->windowSize == windowSize)
+		return;
+
+	d->windowSize = windowSize;
+	d->trimWindow();
+	emit windowSizeChanged(windowSize, {});
+}
+
+void DataStoreModel::setSortRole(int sortRole)
+{
+	if(d->sortRole == sortRole)
+		return;
+
+	d->sortRole = sortRole;
+	reload();
+	emit sortRoleChanged(sortRole, {});
+}
+
+void DataStoreModel::setSortOrder(Qt::SortOrder sortOrder)
+{
+	if(d->sortOrder == sortOrder)
+		return;
+
+	d->sortOrder = sortOrder;
+	if(d->sortRole != -1)
+		reload();
+	emit sortOrderChanged(sortOrder, {});
+}
+
+void DataStoreModel::setFilterRole(int filterRole)
+{
+	if(d->filterRole == filterRole)
+		return;
+
+	d->filterRole = filterRole;
+	reload();
+	emit filterRoleChanged(filterRole, {});
+}
+
+void DataStoreModel::setFilterValue(const QVariant &filterValue)
+{
+	if(d->filterValue == filterValue)
+		return;
+
+	d->filterValue = filterValue;
+	if(d->filterRole != -1)
+		reload();
+	emit filterValueChanged(filterValue, {});
+}
+
+void DataStoreModel::setFilterOperator(DataQuery::Operator filterOperator)
+{
+	if(d->filterOperator == filterOperator)
+		return;
+
+	d->filterOperator = filterOperator;
+	if(d->filterRole != -1)
+		reload();
+	emit filterOperatorChanged(filterOperator, {});
+}
+
 void DataStoreModel::reload()
 {
 	beginResetModel();
-	d->keyList.clear();
+	d->resetKeys();
 	d->clearHashObjects();
 	try {
-		d->keyList = d->store->keys(d->type);
+		d->resetKeys(d->queryKeys());
 		endResetModel();
 	} catch(QException &e) {
 		endResetModel();
@@ -311,77 +509,533 @@ void DataStoreModel::reload()
 	}
 }
 
-void DataStoreModel::storeChanged(int metaTypeId, const QString &key, bool wasDeleted)
+void DataStoreModel::storeChanged(int metaTypeId, const QStringList &keys, bool wasDeleted)
 {
 	if(metaTypeId != d->type)
 		return;
 
+	if(d->isFetching) {
+		for(const auto &key : keys)
+			d->staleKeys.insert(key);
+	}
+	if(d->isPlacing) {
+		for(const auto &key : keys) {
+			if(d->placingKeys.contains(key))
+				d->stalePlacements.insert(key);
+		}
+	}
+
 	if(wasDeleted) {
-		auto index = d->keyList.indexOf(key);
-		if(index != -1) {
-			if(index < d->dataHash.size()) { //is already fetched
-				beginRemoveRows(QModelIndex(), index, index);
-				d->keyList.removeAt(index);
-				d->deleteObject(d->dataHash.take(key));
-				endRemoveRows();
-			} else //not fetched yet -> no signals needed
-				d->keyList.removeAt(index);
-		} //else no need to remove something already not existing
-	} else {
-		auto index = d->keyList.indexOf(key);
-		if(index != -1) { //key already know
-			if(index < d->dataHash.size()) { //not fully loaded -> only load if already fetched
-				try {
-					if(d->isObject) {
-						auto obj = d->dataHash.value(key).value<QObject*>();
-						d->store->update(d->type, obj);
-					} else
-						d->dataHash.insert(key, d->store->load(d->type, key));
-					auto mIndex = idIndex(key);
-					emit dataChanged(mIndex, mIndex.sibling(mIndex.row(), (d->columns.isEmpty() ? 0 : d->columns.size() - 1)));
-				} catch(QException &e) {
-					emit storeError(e, {});
-				}
-			}
-		} else { //key unknown -> append it
-			if(d->keyList.size() == d->dataHash.size()) { //already fully loaded -> needs to be loaded as well
-				d->keyList.append(key);
-				fetchMore(QModelIndex());//simply call fetch more does the loading
-			} else //only append
-				d->keyList.append(key);
+		for(const auto &key : keys)
+			d->pendingPlacements.remove(key);
+		d->removeKeys(keys);
+	} else if(d->isQueried())
+		d->placeKeys(keys);
+	else {
+		const auto fullyLoaded = d->keyList.size() == d->fetchedRows;
+		auto appended = false;
+		QStringList changedKeys;
+		for(const auto &key : keys) {
+			auto index = d->keyIndex.value(key, -1);
+			if(index == -1) { //key unknown -> append it
+				d->appendKey(key);
+				appended = true;
+			} else if(index < d->fetchedRows) //not fully loaded -> only load if already fetched
+				changedKeys.append(key);
 		}
+		d->reloadEntries(changedKeys);
+
+		if(appended && fullyLoaded) //already fully loaded -> new ones need to be loaded as well
+			fetchMore(QModelIndex());
 	}
 }
 
 void DataStoreModel::storeResetted()
 {
 	beginResetModel();
-	d->keyList.clear();
+	d->resetKeys();
 	d->clearHashObjects();
 	endResetModel();
 }
 
 // ------------- Private Implementation -------------
 
+const int DataStoreModelPrivate::FetchSize = 100;
+
 DataStoreModelPrivate::DataStoreModelPrivate(DataStoreModel *q_ptr) :
 	q{q_ptr}
 {}
 
-QStringList DataStoreModelPrivate::activeKeys()
+void DataStoreModelPrivate::resetKeys(const QStringList &keys)
+{
+	//invalidates running fetches
+	generation++;
+	isFetching = false;
+	fetchPending = false;
+	staleKeys.clear();
+	isReloading = false;
+	reloadKeys.clear();
+	isPlacing = false;
+	pendingPlacements.clear();
+	placingKeys.clear();
+	stalePlacements.clear();
+	fetchedRows = 0;
+	windowCenter = 0;
+
+	keyList = keys;
+	keyIndex.clear();
+	keyIndex.reserve(keyList.size());
+	reindexKeys(0);
+}
+
+QVariant DataStoreModelPrivate::entry(const QString &key)
+{
+	if(windowSize > 0)
+		windowCenter = keyIndex.value(key, windowCenter);
+
+	auto it = dataHash.constFind(key);
+	if(it != dataHash.constEnd())
+		return *it;
+
+	//evicted from the window -> load again, which is typically served by the store cache
+	QVariant value;
+	try {
+		value = loadEntry(store, type, key, projectedProperties());
+	} catch(QException &e) {
+		emit q->storeError(e, {});
+		return {};
+	}
+	dataHash.insert(key, value);
+	trimWindow();
+	return value;
+}
+
+void DataStoreModelPrivate::trimWindow()
+{
+	//evict in chunks, so not every load has to sort the loaded entries
+	if(windowSize == 0 || dataHash.size() <= windowSize + windowSize / 4)
+		return;
+
+	//keep the entries closest to the last accessed row
+	QVector<QPair<int, QString>> entries;
+	entries.reserve(dataHash.size());
+	for(auto it = dataHash.constBegin(); it != dataHash.constEnd(); ++it) {
+		const auto row = keyIndex.value(it.key(), -1);
+		entries.append({row == -1 ? std::numeric_limits<int>::max() : qAbs(row - windowCenter), it.key()});
+	}
+	std::nth_element(entries.begin(), entries.begin() + windowSize, entries.end());
+	for(auto it = entries.constBegin() + windowSize; it != entries.constEnd(); ++it)
+		deleteObject(dataHash.take(it->second));
+}
+
+void DataStoreModelPrivate::appendKey(const QString &key)
 {
-	return keyList.mid(0, dataHash.size());
+	keyIndex.insert(key, keyList.size());
+	keyList.append(key);
+}
+
+void DataStoreModelPrivate::reindexKeys(int from, int to)
+{
+	if(to == -1)
+		to = keyList.size() - 1;
+	for(auto i = from; i <= to; i++)
+		keyIndex.insert(keyList[i], i);
+}
+
+void DataStoreModelPrivate::removeKeys(const QStringList &keys)
+{
+	QVector<int> rows;
+	rows.reserve(keys.size());
+	for(const auto &key : keys) {
+		auto index = keyIndex.value(key, -1);
+		if(index != -1) { //no need to remove something already not existing
+			keyIndex.remove(key);
+			rows.append(index);
+		}
+	}
+	if(rows.isEmpty())
+		return;
+
+	//remove from the back, in contiguous ranges
+	std::sort(rows.begin(), rows.end(), std::greater<int>());
+	for(auto i = 0; i < rows.size();) {
+		const auto last = rows[i];
+		auto first = last;
+		while(++i < rows.size() && rows[i] == first - 1)
+			first = rows[i];
+
+		if(first < fetchedRows) { //is already fetched
+			const auto fetchedLast = qMin(last, fetchedRows - 1);
+			q->beginRemoveRows(QModelIndex(), first, fetchedLast);
+			for(auto j = first; j <= fetchedLast; j++)
+				deleteObject(dataHash.take(keyList[j]));
+			keyList.erase(keyList.begin() + first, keyList.begin() + last + 1);
+			fetchedRows -= fetchedLast - first + 1;
+			q->endRemoveRows();
+		} else //not fetched yet -> no signals needed
+			keyList.erase(keyList.begin() + first, keyList.begin() + last + 1);
+	}
+	reindexKeys(rows.last());
+}
+
+void DataStoreModelPrivate::placeKeys(const QStringList &keys)
+{
+	for(const auto &key : keys)
+		pendingPlacements.insert(key);
+	if(!isPlacing)
+		startPlacement();
+}
+
+void DataStoreModelPrivate::startPlacement()
+{
+	//only the datasets right before each changed one are queried, on the async store pool
+	isPlacing = true;
+	const auto keys = pendingPlacements.values();
+	placingKeys = pendingPlacements;
+	pendingPlacements.clear();
+	const auto loadType = type;
+	const auto loadQuery = query();
+	const auto limit = FetchSize + keys.size();
+	const auto loadGeneration = generation;
+
+	auto watcher = new QFutureWatcher<QVector<Placement>>{q};
+	QObject::connect(watcher, &QFutureWatcherBase::finished,
+					 q, [this, watcher, keys, limit, loadGeneration]() {
+		watcher->deleteLater();
+		QVector<Placement> results;
+		try {
+			results = watcher->result();
+		} catch(QException &e) {
+			if(loadGeneration == generation) {
+				isPlacing = false;
+				placingKeys.clear();
+				stalePlacements.clear();
+				emit q->storeError(e, {});
+			}
+			return;
+		}
+		//the model was reset in the meantime
+		if(loadGeneration != generation)
+			return;
+		isPlacing = false;
+
+		//datasets that changed again are placed by the next query, removed ones not at all
+		QHash<QString, Placement> placements;
+		QStringList removed;
+		for(auto i = 0; i < keys.size(); i++) {
+			if(stalePlacements.contains(keys[i]))
+				continue;
+			if(results.value(i).matches)
+				placements.insert(keys[i], results.value(i));
+			else //does not match the filter anymore
+				removed.append(keys[i]);
+		}
+		placingKeys.clear();
+		stalePlacements.clear();
+		removeKeys(removed);
+
+		auto unplaced = QSet<QString>::fromList(placements.keys());
+		for(const auto &key : keys) {
+			if(unplaced.contains(key) &&
+			   !placeKey(key, placements, unplaced, limit)) {
+				//too many changed datasets in a row to find the position
+				q->reload();
+				return;
+			}
+		}
+
+		if(!pendingPlacements.isEmpty())
+			startPlacement();
+	});
+	watcher->setFuture(store->runAsync<QVector<Placement>>(ObjectKey{store->d->typeName(loadType)},
+														   [loadType, loadQuery, keys, limit](DataStore *store) {
+		return loadPlacements(store, loadType, loadQuery, keys, limit);
+	}));
+}
+
+bool DataStoreModelPrivate::placeKey(const QString &key, const QHash<QString, Placement> &placements, QSet<QString> &unplaced, int limit)
+{
+	//a row belongs behind the closest preceding dataset with a known position.
+	//Changed datasets before it are placed first, so they can serve as that dataset
+	QVector<QString> stack {key};
+	while(!stack.isEmpty()) {
+		const auto current = stack.last();
+		const auto preceding = placements.value(current).preceding;
+		auto to = -1;
+		auto deferred = false;
+		for(const auto &pred : preceding) {
+			if(unplaced.contains(pred)) {
+				stack.append(pred);
+				deferred = true;
+				break;
+			}
+			auto index = keyIndex.value(pred, -1);
+			if(index != -1 && !pendingPlacements.contains(pred)) {
+				to = index + 1;
+				break;
+			}
+		}
+		if(deferred)
+			continue;
+		if(to == -1) {
+			if(preceding.size() >= limit)
+				return false;
+			to = 0; //nothing known before it
+		}
+
+		stack.removeLast();
+		unplaced.remove(current);
+		moveKey(current, to);
+	}
+	return true;
+}
+
+void DataStoreModelPrivate::moveKey(const QString &key, int to)
+{
+	const auto from = keyIndex.value(key, -1);
+	const auto target = (from != -1 && from < to) ? to - 1 : to;
+
+	if(from != -1 && from < fetchedRows) {
+		if(target >= fetchedRows) { //moves behind the fetched rows
+			q->beginRemoveRows(QModelIndex(), from, from);
+			deleteObject(dataHash.take(key));
+			keyList.move(from, target);
+			fetchedRows--;
+			reindexKeys(from, target);
+			q->endRemoveRows();
+			return;
+		}
+
+		if(target != from) { //moves within the fetched rows
+			q->beginMoveRows(QModelIndex(), from, from, QModelIndex(), to);
+			keyList.move(from, target);
+			reindexKeys(qMin(from, target), qMax(from, target));
+			q->endMoveRows();
+		}
+		reloadEntries({key});
+	} else if(target < fetchedRows || fetchedRows == keyList.size()) { //moves into the fetched rows
+		//the data is loaded on demand
+		q->beginInsertRows(QModelIndex(), target, target);
+		if(from == -1) {
+			keyList.insert(target, key);
+			reindexKeys(target);
+		} else {
+			keyList.move(from, target);
+			reindexKeys(target, from);
+		}
+		fetchedRows++;
+		q->endInsertRows();
+	} else if(from == -1) { //not fetched yet -> no signals needed
+		keyList.insert(target, key);
+		reindexKeys(target);
+	} else {
+		keyList.move(from, target);
+		reindexKeys(qMin(from, target), qMax(from, target));
+	}
+}
+
+void DataStoreModelPrivate::reloadEntries(const QStringList &keys)
+{
+	const auto lastColumn = columns.isEmpty() ? 0 : columns.size() - 1;
+	for(const auto &key : keys) {
+		if(dataHash.contains(key))
+			reloadKeys.insert(key);
+		else { //evicted or not fetched entries are loaded on demand
+			const auto row = keyIndex.value(key, -1);
+			if(row != -1 && row < fetchedRows)
+				emit q->dataChanged(q->index(row), q->index(row, lastColumn));
+		}
+	}
+
+	if(!isReloading && !reloadKeys.isEmpty())
+		startReload();
+}
+
+void DataStoreModelPrivate::startReload()
+{
+	//load all changed entries in one task on the async store pool and update them once they are ready
+	isReloading = true;
+	const auto keys = reloadKeys.values();
+	reloadKeys.clear();
+	const auto loadType = type;
+	const auto properties = projectedProperties();
+	const auto loadGeneration = generation;
+
+	auto watcher = new QFutureWatcher<QVariantList>{q};
+	QObject::connect(watcher, &QFutureWatcherBase::finished,
+					 q, [this, watcher, keys, loadGeneration]() {
+		watcher->deleteLater();
+		QVariantList values;
+		try {
+			values = watcher->result();
+		} catch(QException &e) {
+			if(loadGeneration == generation) {
+				isReloading = false;
+				emit q->storeError(e, {});
+			}
+			return;
+		}
+
+		//the model was reset in the meantime
+		if(loadGeneration != generation) {
+			for(const auto &value : qAsConst(values))
+				deleteObject(value);
+			return;
+		}
+		isReloading = false;
+
+		const auto lastColumn = columns.isEmpty() ? 0 : columns.size() - 1;
+		for(auto i = 0; i < keys.size(); i++) {
+			const auto &key = keys[i];
+			auto value = values.value(i);
+			//removed, evicted or changed again in the meantime -> nothing to update
+			auto it = dataHash.find(key);
+			if(!value.isValid() || it == dataHash.end() || reloadKeys.contains(key)) {
+				deleteObject(value);
+				continue;
+			}
+
+			if(isObject && !projected) {
+				//update the existing object, as it may be referenced from outside of the model
+				auto object = it->value<QObject*>();
+				auto nObject = value.value<QObject*>();
+				if(object && nObject) {
+					for(auto p = 0; p < metaObject->propertyCount(); p++) {
+						auto prop = metaObject->property(p);
+						prop.write(object, prop.read(nObject));
+					}
+				}
+				deleteObject(value);
+			} else
+				*it = value;
+
+			const auto row = keyIndex.value(key, -1);
+			if(row != -1 && row < fetchedRows)
+				emit q->dataChanged(q->index(row), q->index(row, lastColumn));
+		}
+
+		if(!reloadKeys.isEmpty())
+			startReload();
+	});
+	watcher->setFuture(store->runAsync<QVariantList>(ObjectKey{store->d->typeName(loadType)},
+													 [loadType, keys, properties](DataStore *store) {
+		return loadEntries(store, loadType, keys, properties);
+	}));
+}
+
+bool DataStoreModelPrivate::isQueried() const
+{
+	return !roleProperty(sortRole).isEmpty() ||
+			!roleProperty(filterRole).isEmpty();
+}
+
+DataQuery DataStoreModelPrivate::query() const
+{
+	DataQuery query;
+	const auto filterProperty = roleProperty(filterRole);
+	if(!filterProperty.isEmpty())
+		query.where(filterProperty, filterOperator, filterValue);
+	const auto sortProperty = roleProperty(sortRole);
+	if(!sortProperty.isEmpty())
+		query.orderBy(sortProperty, sortOrder);
+	return query;
+}
+
+QStringList DataStoreModelPrivate::queryKeys() const
+{
+	if(isQueried())
+		return store->keys(type, query());
+	else
+		return store->keys(type);
+}
+
+QString DataStoreModelPrivate::roleProperty(int role) const
+{
+	return QString::fromUtf8(roleProperties.value(role).name());
+}
+
+QStringList DataStoreModelPrivate::projectedProperties() const
+{
+	if(!projected)
+		return {};
+
+	//the user property and all properties mapped to columns. Other roles are loaded on demand
+	QStringList properties {QString::fromUtf8(metaObject->userProperty().name())};
+	for(const auto &roles : roleMapping) {
+		for(const auto &property : roles) {
+			auto name = QString::fromUtf8(property);
+			if(!properties.contains(name))
+				properties.append(name);
+		}
+	}
+	return properties;
+}
+
+QVariant DataStoreModelPrivate::loadEntry(DataStore *store, int type, const QString &key, const QStringList &properties)
+{
+	//only projected models pass properties, as they always contain the user property
+	if(!properties.isEmpty())
+		return store->loadProperties(type, key, properties);
+	else
+		return store->load(type, key);
+}
+
+QVariantList DataStoreModelPrivate::loadEntries(DataStore *store, int type, const QStringList &keys, const QStringList &properties)
+{
+	QVariantList values;
+	values.reserve(keys.size());
+	for(const auto &key : keys) {
+		try {
+			values.append(loadEntry(store, type, key, properties));
+		} catch(NoDataException &) {
+			values.append(QVariant{}); //removed in the meantime, the change signal follows
+		}
+	}
+	return values;
+}
+
+QVector<DataStoreModelPrivate::Placement> DataStoreModelPrivate::loadPlacements(DataStore *store, int type, const DataQuery &query, const QStringList &keys, int limit)
+{
+	const auto typeName = store->d->typeName(type);
+	QVector<Placement> placements;
+	placements.reserve(keys.size());
+	for(const auto &key : keys) {
+		Placement placement;
+		placement.matches = store->d->store->precedingKeys(typeName, query, key, limit, placement.preceding);
+		placements.append(placement);
+	}
+	return placements;
 }
 
 void DataStoreModelPrivate::createRoleNames()
 {
 	roleNames.clear();
+	roleProperties.clear();
 
-	auto metaObject = QMetaType::metaObjectForType(type);
+	metaObject = QMetaType::metaObjectForType(type);
 	auto roleIndex = Qt::UserRole + 1;
 	for(auto i = 0; i < metaObject->propertyCount(); i++) {
 		auto prop = metaObject->property(i);
-		roleNames.insert(roleIndex++, prop.name());
+		roleNames.insert(roleIndex, prop.name());
+		roleProperties.insert(roleIndex++, prop);
 	}
+	roleProperties.insert(Qt::DisplayRole, metaObject->userProperty());
+}
+
+void DataStoreModelPrivate::resolveColumns()
+{
+	columnProperties.clear();
+	for(auto it = roleMapping.constBegin(); it != roleMapping.constEnd(); ++it) {
+		auto &properties = columnProperties[it.key()];
+		for(auto rIt = it->constBegin(); rIt != it->constEnd(); ++rIt)
+			properties.insert(rIt.key(), resolveProperty(*rIt));
+	}
+}
+
+QMetaProperty DataStoreModelPrivate::resolveProperty(const QByteArray &name) const
+{
+	//an invalid property for unknown names, so data() returns nothing for them
+	return metaObject->property(metaObject->indexOfProperty(name.constData()));
 }
 
 void DataStoreModelPrivate::clearHashObjects()
@@ -419,56 +1073,61 @@ bool DataStoreModelPrivate::testRoleValid(const QModelIndex &index, int role) co
 #endif
 }
 
-QByteArray DataStoreModelPrivate::propertyName(const QModelIndex &index, int role) const
+QMetaProperty DataStoreModelPrivate::property(const QModelIndex &index, int role) const
 {
 	if(!columns.isEmpty()) {
-		const auto &subRoles = roleMapping[index.column()];
-		auto roleName = subRoles.value(role);
-		if(!roleName.isEmpty())
-			return roleName;
+		auto column = columnProperties.constFind(index.column());
+		if(column != columnProperties.constEnd()) {
+			auto prop = column->constFind(role);
+			if(prop != column->constEnd())
+				return *prop;
+		}
 	}
-
-	if(role == Qt::DisplayRole) {
-		auto metaObject = QMetaType::metaObjectForType(type);
-		return metaObject->userProperty().name();
-	} else
-		return roleNames.value(role);
+	return roleProperties.value(role);
 }
 
-QVariant DataStoreModelPrivate::readProperty(const QString &key, const QByteArray &property)
+QVariant DataStoreModelPrivate::readProperty(const QString &key, const QMetaProperty &property)
 {
-	auto data = dataHash.value(key);
-	if(!data.convert(type))
+	if(!property.isValid())
 		return {};
 
-	auto metaObject = QMetaType::metaObjectForType(type);
-	auto pIndex = metaObject->indexOfProperty(property.constData());
-	if(pIndex == -1)
+	if(projected) {
+		auto values = entry(key).toMap();
+		const auto name = QString::fromUtf8(property.name());
+		if(!values.contains(name)) {
+			try {
+				values.insert(name, store->loadProperties(type, key, {name}).value(name));
+				dataHash.insert(key, values);
+			} catch(QException &e) {
+				emit q->storeError(e, {});
+				return {};
+			}
+		}
+		return values.value(name);
+	}
+
+	const auto data = entry(key);
+	if(data.userType() != type)
 		return {};
-	auto prop = metaObject->property(pIndex);
 
 	if(isObject) {
 		auto object = data.value<QObject*>();
 		if(object)
-			return prop.read(object).toString();
+			return property.read(object);
 		else
 			return {};
 	} else
-		return prop.readOnGadget(data.constData()).toString();
+		return property.readOnGadget(data.constData());
 }
 
-bool DataStoreModelPrivate::writeProperty(const QString &key, const QByteArray &property, const QVariant &value)
+bool DataStoreModelPrivate::writeProperty(const QString &key, const QMetaProperty &prop, const QVariant &value)
 {
-	auto data = dataHash.value(key);
-	if(!data.convert(type))
+	if(!prop.isValid() || prop.isUser())//user property not editable, as this would change the identity
 		return false;
 
-	auto metaObject = QMetaType::metaObjectForType(type);
-	auto pIndex = metaObject->indexOfProperty(property.constData());
-	if(pIndex == -1)
-		return false;
-	auto prop = metaObject->property(pIndex);
-	if(prop.isUser())//user property not editable, as this would change the identity
+	//projected entries do not hold the object, so it must be loaded to be modified
+	auto data = projected ? store->load(type, key) : entry(key);
+	if(!data.convert(type))
 		return false;
 
 	if(isObject) {
@@ -480,7 +1139,15 @@ bool DataStoreModelPrivate::writeProperty(const QString &key, const QByteArray &
 	} else
 		prop.writeOnGadget(data.data(), value);
 
-	dataHash[key] = data;
+	if(projected) {
+		auto values = entry(key).toMap();
+		values.insert(QString::fromUtf8(prop.name()),
+					  isObject ? prop.read(data.value<QObject*>()) : prop.readOnGadget(data.constData()));
+		dataHash.insert(key, values);
+		if(isObject)
+			deleteObject(data); //deferred, so it can still be saved
+	} else
+		dataHash[key] = data;
 	store->save(type, data);
 	return true;
 }
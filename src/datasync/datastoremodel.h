@@ -19,6 +19,20 @@ class Q_DATASYNC_EXPORT DataStoreModel : public QAbstractTableModel
 	Q_PROPERTY(int typeId READ typeId WRITE setTypeId NOTIFY typeIdChanged)
 	//! Specifies whether the model items can be edited
 	Q_PROPERTY(bool editable READ isEditable WRITE setEditable NOTIFY editableChanged)
+	//! Specifies whether the model only loads the properties it displays instead of whole objects
+	Q_PROPERTY(bool projected READ isProjected WRITE setProjected NOTIFY projectedChanged)
+	//! Limits the number of loaded objects to the rows around the last accessed one
+	Q_PROPERTY(int windowSize READ windowSize WRITE setWindowSize NOTIFY windowSizeChanged)
+	//! The role of the indexed property the rows are sorted by, or -1 for no sorting
+	Q_PROPERTY(int sortRole READ sortRole WRITE setSortRole NOTIFY sortRoleChanged)
+	//! The order in which the rows are sorted by the sortRole
+	Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
+	//! The role of the indexed property the rows are filtered by, or -1 for no filtering
+	Q_PROPERTY(int filterRole READ filterRole WRITE setFilterRole NOTIFY filterRoleChanged)
+	//! The value the filterRole is compared with
+	Q_PROPERTY(QVariant filterValue READ filterValue WRITE setFilterValue NOTIFY filterValueChanged)
+	//! The operator used to compare the filterRole with the filterValue
+	Q_PROPERTY(QtDataSync::DataQuery::Operator filterOperator READ filterOperator WRITE setFilterOperator NOTIFY filterOperatorChanged)
 
 public:
 	//! Constructs a model for the default setup
@@ -41,6 +55,20 @@ public:
 	inline void setTypeId(bool resetColumns = true);
 	//! @readAcFn{DataStoreModel::editable}
 	bool isEditable() const;
+	//! @readAcFn{DataStoreModel::projected}
+	bool isProjected() const;
+	//! @readAcFn{DataStoreModel::windowSize}
+	int windowSize() const;
+	//! @readAcFn{DataStoreModel::sortRole}
+	int sortRole() const;
+	//! @readAcFn{DataStoreModel::sortOrder}
+	Qt::SortOrder sortOrder() const;
+	//! @readAcFn{DataStoreModel::filterRole}
+	int filterRole() const;
+	//! @readAcFn{DataStoreModel::filterValue}
+	QVariant filterValue() const;
+	//! @readAcFn{DataStoreModel::filterOperator}
+	DataQuery::Operator filterOperator() const;
 
 	//! @inherit{QAbstractTableModel::headerData}
 	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
@@ -52,6 +80,8 @@ public:
 	bool canFetchMore(const QModelIndex &parent) const override;
 	//! @inherit{QAbstractTableModel::fetchMore}
 	void fetchMore(const QModelIndex &parent) override;
+	//! @inherit{QAbstractTableModel::sort}
+	void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
 	//! @inherit{QAbstractTableModel::index}
 	QModelIndex index(int row, int column = 0, const QModelIndex &parent = QModelIndex()) const override;
@@ -110,6 +140,20 @@ public Q_SLOTS:
 	void setTypeId(int typeId, bool resetColumns);
 	//! @writeAcFn{DataStoreModel::editable}
 	void setEditable(bool editable);
+	//! @writeAcFn{DataStoreModel::projected}
+	void setProjected(bool projected);
+	//! @writeAcFn{DataStoreModel::windowSize}
+	void setWindowSize(int windowSize);
+	//! @writeAcFn{DataStoreModel::sortRole}
+	void setSortRole(int sortRole);
+	//! @writeAcFn{DataStoreModel::sortOrder}
+	void setSortOrder(Qt::SortOrder sortOrder);
+	//! @writeAcFn{DataStoreModel::filterRole}
+	void setFilterRole(int filterRole);
+	//! @writeAcFn{DataStoreModel::filterValue}
+	void setFilterValue(const QVariant &filterValue);
+	//! @writeAcFn{DataStoreModel::filterOperator}
+	void setFilterOperator(QtDataSync::DataQuery::Operator filterOperator);
 
 	//! Reloads all data in the model
 	void reload();
@@ -121,6 +165,20 @@ Q_SIGNALS:
 	void typeIdChanged(int typeId, QPrivateSignal);
 	//! @notifyAcFn{DataStoreModel::editable}
 	void editableChanged(bool editable, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::projected}
+	void projectedChanged(bool projected, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::windowSize}
+	void windowSizeChanged(int windowSize, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::sortRole}
+	void sortRoleChanged(int sortRole, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::sortOrder}
+	void sortOrderChanged(Qt::SortOrder sortOrder, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::filterRole}
+	void filterRoleChanged(int filterRole, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::filterValue}
+	void filterValueChanged(const QVariant &filterValue, QPrivateSignal);
+	//! @notifyAcFn{DataStoreModel::filterOperator}
+	void filterOperatorChanged(QtDataSync::DataQuery::Operator filterOperator, QPrivateSignal);
 
 protected:
 	//! @private
@@ -129,7 +187,7 @@ protected:
 	void initStore(DataStore *store);
 
 private Q_SLOTS:
-	void storeChanged(int metaTypeId, const QString &key, bool wasDeleted);
+	void storeChanged(int metaTypeId, const QStringList &keys, bool wasDeleted);
 	void storeResetted();
 
 private:
@@ -1,6 +1,10 @@
 #ifndef QTDATASYNC_DATASTOREMODEL_P_H
 #define QTDATASYNC_DATASTOREMODEL_P_H
 
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtCore/QMetaProperty>
+
 #include "qtdatasync_global.h"
 #include "datastoremodel.h"
 
@@ -10,34 +14,84 @@ namespace QtDataSync {
 class DataStoreModelPrivate
 {
 public:
+	static const int FetchSize;
+
+	struct Placement {
+		bool matches = false;
+		QStringList preceding; //the datasets before it in the query order, the closest first
+	};
+
 	DataStoreModelPrivate(DataStoreModel *q_ptr);
 
 	DataStoreModel *q;
 	DataStore *store = nullptr;
 	bool editable = false;
+	bool projected = false;
+	int windowSize = 0;
+	int sortRole = -1;
+	Qt::SortOrder sortOrder = Qt::AscendingOrder;
+	int filterRole = -1;
+	QVariant filterValue;
+	DataQuery::Operator filterOperator = DataQuery::Equal;
 
 	int type = QMetaType::UnknownType;
+	const QMetaObject *metaObject = nullptr;
 	bool isObject = false;
 	QHash<int, QByteArray> roleNames;
+	QHash<int, QMetaProperty> roleProperties; //role -> property, resolved once per type
 
 	QStringList keyList;
-	QVariantHash dataHash;
+	QHash<QString, int> keyIndex; //key -> position in keyList
+	QVariantHash dataHash; //the loaded entries, in windowed mode only those around windowCenter
+	int fetchedRows = 0;
+	int windowCenter = 0; //the row that was accessed last
 
 	QStringList columns;
 	QHash<int, QHash<int, QByteArray>> roleMapping; //column -> (role -> property)
+	QHash<int, QHash<int, QMetaProperty>> columnProperties; //the resolved roleMapping
 
 	bool isFetching = false;
+	bool fetchPending = false;
+	quint64 generation = 0; //changes with every reset, so running fetches can be discarded
+	QSet<QString> staleKeys; //keys that changed while being fetched
+	bool isReloading = false;
+	QSet<QString> reloadKeys; //loaded entries that changed and wait to be reloaded
+	bool isPlacing = false;
+	QSet<QString> pendingPlacements; //changed keys of a queried model that wait to be placed
+	QSet<QString> placingKeys; //the keys currently placed
+	QSet<QString> stalePlacements; //keys that changed while being placed
 
-	QStringList activeKeys();
+	void resetKeys(const QStringList &keys = {});
+	void appendKey(const QString &key);
+	QVariant entry(const QString &key);
+	void trimWindow();
+	void reindexKeys(int from, int to = -1);
+	void removeKeys(const QStringList &keys);
+	void placeKeys(const QStringList &keys);
+	void startPlacement();
+	bool placeKey(const QString &key, const QHash<QString, Placement> &placements, QSet<QString> &unplaced, int limit);
+	void moveKey(const QString &key, int to);
+	void reloadEntries(const QStringList &keys);
+	void startReload();
+	bool isQueried() const;
+	DataQuery query() const;
+	QStringList queryKeys() const;
+	QString roleProperty(int role) const;
+	QStringList projectedProperties() const;
+	static QVariant loadEntry(DataStore *store, int type, const QString &key, const QStringList &properties);
+	static QVariantList loadEntries(DataStore *store, int type, const QStringList &keys, const QStringList &properties);
+	static QVector<Placement> loadPlacements(DataStore *store, int type, const DataQuery &query, const QStringList &keys, int limit);
 
 	void createRoleNames();
+	void resolveColumns();
+	QMetaProperty resolveProperty(const QByteArray &name) const;
 	void clearHashObjects();
 	void deleteObject(const QVariant &value);
 	bool testRoleValid(const QModelIndex &index, int role) const;
-	QByteArray propertyName(const QModelIndex &index, int role) const;
+	QMetaProperty property(const QModelIndex &index, int role) const;
 
-	QVariant readProperty(const QString &key, const QByteArray &property);
-	bool writeProperty(const QString &key, const QByteArray &property, const QVariant &value);
+	QVariant readProperty(const QString &key, const QMetaProperty &property);
+	bool writeProperty(const QString &key, const QMetaProperty &prop, const QVariant &value);
 };
 
 }
@@ -37,6 +37,7 @@ HEADERS += \
 	userexchangemanager.h \
 	userexchangemanager_p.h \
 	emitteradapter_p.h \
+	storecache_p.h \
 	changeemitter_p.h \
 	signal_private_connect_p.h \
 	migrationhelper.h \
@@ -45,7 +46,12 @@ HEADERS += \
 	remoteconfig_p.h \
 	eventcursor.h \
 	eventcursor_p.h \
-	qtrotransportregistry.h
+	qtrotransportregistry.h \
+	dataquery.h \
+	dataquery_p.h \
+	datacursor.h \
+	datacursor_p.h \
+	asyncstorepool_p.h
 
 SOURCES += \
 	localstore.cpp \
@@ -73,11 +79,15 @@ SOURCES += \
 	accountmanager_p.cpp \
 	userexchangemanager.cpp \
 	emitteradapter.cpp \
+	storecache.cpp \
 	changeemitter.cpp \
 	migrationhelper.cpp \
 	remoteconfig.cpp \
 	eventcursor.cpp \
-	qtrotransportregistry.cpp
+	qtrotransportregistry.cpp \
+	dataquery.cpp \
+	datacursor.cpp \
+	asyncstorepool.cpp
 
 STATECHARTS += \
 	connectorstatemachine.scxml
@@ -9,3 +9,36 @@ QString DataTypeStoreBase::setupName() const
 {
 	return store()->setupName();
 }
+
+
+
+const int CachingDataTypeStoreBase::LoadChunkSize = 100;
+
+CachingDataTypeStoreBase::CachingDataTypeStoreBase(int maxSize, QObject *parent) :
+	DataTypeStoreBase{parent},
+	_maxSize{qMax(0, maxSize)}
+{}
+
+bool CachingDataTypeStoreBase::isReady() const
+{
+	return _ready;
+}
+
+int CachingDataTypeStoreBase::maxSize() const
+{
+	return _maxSize;
+}
+
+void CachingDataTypeStoreBase::setReady(bool ready)
+{
+	if(_ready == ready)
+		return;
+
+	_ready = ready;
+	emit readyChanged(_ready);
+}
+
+bool CachingDataTypeStoreBase::isComplete() const
+{
+	return _ready && _maxSize == 0;
+}
@@ -1,11 +1,15 @@
 #ifndef QTDATASYNC_DATATYPESTORE_H
 #define QTDATASYNC_DATATYPESTORE_H
 
+#include <algorithm>
 #include <type_traits>
 
 #include <QtCore/qobject.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qloggingcategory.h>
+#include <QtCore/qfuturewatcher.h>
+#include <QtCore/qset.h>
+#include <QtCore/qvector.h>
 
 #include "QtDataSync/qtdatasync_global.h"
 #include "QtDataSync/datastore.h"
@@ -59,20 +63,53 @@ public:
 	bool contains(const TKey &key) const;
 	//! @copybrief DataStore::load(const K &) const
 	TType load(const TKey &key) const;
+	//! @copybrief DataStore::loadProperties(const K &, const QStringList &) const
+	QVariantMap loadProperties(const TKey &key, const QStringList &properties) const;
 	//! @copybrief DataStore::save(const T &)
 	void save(const TType &value);
+	//! @copybrief DataStore::saveAll(const QList<T> &)
+	void saveAll(const QList<TType> &values);
 	//! @copybrief DataStore::remove(const K &)
 	bool remove(const TKey &key);
+	//! @copybrief DataStore::removeAll(const QList<K> &)
+	int removeAll(const QList<TKey> &keys);
 	//! @copybrief DataStore::update(T) const
 	template <typename TX = TType>
 	void update(std::enable_if_t<__helpertypes::is_object<TX>::value, TX> object) const;
 	//! @copybrief DataStore::search(const QString &, SearchMode) const
 	QList<TType> search(const QString &query, DataStore::SearchMode mode = DataStore::RegexpMode);
+	//! @copybrief DataStore::searchMatches(const QString &, int) const
+	QList<DataStore::SearchMatch> searchMatches(const QString &query, int limit = -1) const;
+	//! @copybrief DataStore::keysByIndex(const QString &, const QVariant &) const
+	QList<TKey> keysByIndex(const QString &property, const QVariant &value) const;
+	//! @copybrief DataStore::loadByIndex(const QString &, const QVariant &) const
+	QList<TType> loadByIndex(const QString &property, const QVariant &value) const;
+	//! @copybrief DataStore::count(const DataQuery &) const
+	quint64 count(const DataQuery &query) const;
+	//! @copybrief DataStore::keys(const DataQuery &) const
+	QList<TKey> keys(const DataQuery &query) const;
+	//! @copybrief DataStore::query(const DataQuery &) const
+	QList<TType> query(const DataQuery &query) const;
+	//! @copybrief DataStore::cursor(QObject *) const
+	DataCursor *cursor(QObject *parent = nullptr) const;
 	//! @copybrief DataStore::iterate(const std::function<bool(T)> &, bool) const
 	void iterate(const std::function<bool(TType)> &iterator, bool skipBroken = false);
 	//! @copybrief DataStore::clear()
 	void clear();
 
+	//! @copybrief DataStore::countAsync() const
+	QFuture<qint64> countAsync() const;
+	//! @copybrief DataStore::loadAllAsync() const
+	QFuture<QList<TType>> loadAllAsync() const;
+	//! @copybrief DataStore::loadAsync(const QString &) const
+	QFuture<TType> loadAsync(const TKey &key) const;
+	//! @copybrief DataStore::saveAsync(const T &)
+	QFuture<void> saveAsync(const TType &value);
+	//! @copybrief DataStore::removeAsync(const QString &)
+	QFuture<bool> removeAsync(const TKey &key);
+	//! @copybrief DataStore::searchAsync(const QString &, SearchMode) const
+	QFuture<QList<TType>> searchAsync(const QString &query, DataStore::SearchMode mode = DataStore::RegexpMode) const;
+
 	//! Shortcut to convert a string to the stores key type
 	static TKey toKey(const QString &key);
 
@@ -82,9 +119,58 @@ private:
 	void evalDataChanged(int metaTypeId, const QString &key, bool wasDeleted);
 };
 
+//! Base class for the CachingDataTypeStore classes
+class Q_DATASYNC_EXPORT CachingDataTypeStoreBase : public DataTypeStoreBase
+{
+	Q_OBJECT
+
+	//! Specifies whether the initial loading of the datasets has finished
+	Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged)
+	//! The maximum number of datasets kept in the cache, or 0 for no limit
+	Q_PROPERTY(int maxSize READ maxSize CONSTANT)
+
+public:
+	//! Defines how the datasets are loaded when the store is created
+	enum LoadMode {
+		LoadSynchronous, //!< All datasets are loaded by the constructor
+		LoadAsynchronous //!< The datasets are loaded in the background, in chunks
+	};
+	Q_ENUM(LoadMode)
+
+	//! Constructor with the maximum number of cached datasets
+	explicit CachingDataTypeStoreBase(int maxSize = 0, QObject *parent = nullptr);
+
+	//! @readAcFn{CachingDataTypeStoreBase::ready}
+	bool isReady() const;
+	//! @readAcFn{CachingDataTypeStoreBase::maxSize}
+	int maxSize() const;
+
+Q_SIGNALS:
+	//! @notifyAcFn{CachingDataTypeStoreBase::ready}
+	void readyChanged(bool ready);
+	//! Is emitted whenever a chunk of datasets has been loaded asynchronously
+	void loadProgress(int loaded, int total);
+
+protected:
+	//! @private
+	static const int LoadChunkSize;
+
+	//! @private
+	void setReady(bool ready);
+	//! @private
+	bool isComplete() const;
+	//! @private
+	template <typename TResult, typename TFunc>
+	static QFuture<TResult> runAsync(const DataStore *store, const ObjectKey &orderKey, TFunc func);
+
+private:
+	const int _maxSize;
+	bool _ready = true;
+};
+
 //! A DataTypeStore that caches all loaded data internally for faster access
 template <typename TType, typename TKey = QString>
-class CachingDataTypeStore : public DataTypeStoreBase
+class CachingDataTypeStore : public CachingDataTypeStoreBase
 {
 	static_assert(__helpertypes::is_gadget<TType>::value, "TType must be a Q_GADGET");
 
@@ -100,6 +186,12 @@ public:
 	explicit CachingDataTypeStore(const QString &setupName, QObject *parent = nullptr);
 	//! @copydoc DataTypeStore::DataTypeStore(DataStore *, QObject*)
 	explicit CachingDataTypeStore(DataStore *store, QObject *parent = nullptr);
+	//! Constructs a store for the default setup that loads the datasets as specified
+	explicit CachingDataTypeStore(LoadMode mode, int maxSize = 0, QObject *parent = nullptr);
+	//! Constructs a store for the given setup that loads the datasets as specified
+	explicit CachingDataTypeStore(const QString &setupName, LoadMode mode, int maxSize = 0, QObject *parent = nullptr);
+	//! Constructs a store on the given store that loads the datasets as specified
+	explicit CachingDataTypeStore(DataStore *store, LoadMode mode, int maxSize = 0, QObject *parent = nullptr);
 
 	DataStore *store() const override;
 
@@ -115,8 +207,12 @@ public:
 	TType load(const TKey &key) const;
 	//! @copydoc DataTypeStore::save
 	void save(const TType &value);
+	//! @copydoc DataTypeStore::saveAll
+	void saveAll(const QList<TType> &values);
 	//! @copydoc DataTypeStore::remove
 	bool remove(const TKey &key);
+	//! @copydoc DataTypeStore::removeAll
+	int removeAll(const QList<TKey> &keys);
 	//! Returns the dataset for the given key and removes it from the store
 	TType take(const TKey &key);
 	//! @copydoc DataTypeStore::clear
@@ -132,15 +228,24 @@ public:
 
 private:
 	DataStore *_store;
-	QHash<TKey, TType> _data;
-
+	mutable QHash<TKey, TType> _data;
+	mutable QHash<TKey, quint64> _lastUse; //only used with a maxSize
+	mutable quint64 _useCounter = 0;
+	QHash<TKey, TType> _savedData; //datasets currently being saved via this store
+	QSet<TKey> _changedKeys; //keys that changed while loading asynchronously
+	QStringList _loadKeys;
+
+	void populate(LoadMode mode);
+	void loadChunk(int offset);
+	void cache(const TKey &key, const TType &value) const;
+	void touch(const TKey &key) const;
 	void evalDataChanged(int metaTypeId, const QString &key, bool wasDeleted);
 	void evalDataResetted();
 };
 
 //! @copydoc QtDataSync::CachingDataTypeStore
 template <typename TType, typename TKey>
-class CachingDataTypeStore<TType*, TKey> : public DataTypeStoreBase
+class CachingDataTypeStore<TType*, TKey> : public CachingDataTypeStoreBase
 {
 	static_assert(__helpertypes::is_object<TType*>::value, "TType must inherit QObject");
 
@@ -156,6 +261,12 @@ public:
 	explicit CachingDataTypeStore(const QString &setupName, QObject *parent = nullptr);
 	//!@copydoc CachingDataTypeStore::CachingDataTypeStore(DataStore*, QObject *)
 	explicit CachingDataTypeStore(DataStore *store, QObject *parent = nullptr);
+	//!@copydoc CachingDataTypeStore::CachingDataTypeStore(LoadMode, int, QObject *)
+	explicit CachingDataTypeStore(LoadMode mode, int maxSize = 0, QObject *parent = nullptr);
+	//!@copydoc CachingDataTypeStore::CachingDataTypeStore(const QString &, LoadMode, int, QObject *)
+	explicit CachingDataTypeStore(const QString &setupName, LoadMode mode, int maxSize = 0, QObject *parent = nullptr);
+	//!@copydoc CachingDataTypeStore::CachingDataTypeStore(DataStore *, LoadMode, int, QObject *)
+	explicit CachingDataTypeStore(DataStore *store, LoadMode mode, int maxSize = 0, QObject *parent = nullptr);
 
 	DataStore *store() const override;
 
@@ -171,8 +282,12 @@ public:
 	TType* load(const TKey &key) const;
 	//!@copydoc CachingDataTypeStore::save
 	void save(TType *value);
+	//!@copydoc CachingDataTypeStore::saveAll
+	void saveAll(const QList<TType*> &values);
 	//!@copydoc CachingDataTypeStore::remove
 	bool remove(const TKey &key);
+	//!@copydoc CachingDataTypeStore::removeAll
+	int removeAll(const QList<TKey> &keys);
 	//!@copydoc CachingDataTypeStore::take
 	TType* take(const TKey &key);
 	//!@copydoc CachingDataTypeStore::clear
@@ -188,8 +303,18 @@ public:
 
 private:
 	DataStore *_store;
-	QHash<TKey, TType*> _data;
-
+	mutable QHash<TKey, TType*> _data;
+	mutable QHash<TKey, quint64> _lastUse; //only used with a maxSize
+	mutable quint64 _useCounter = 0;
+	QHash<TKey, TType*> _savedData; //objects currently being saved via this store
+	QSet<TKey> _changedKeys; //keys that changed while loading asynchronously
+	QStringList _loadKeys;
+
+	void populate(LoadMode mode);
+	void loadChunk(int offset);
+	void cache(const TKey &key, TType *value) const;
+	void touch(const TKey &key) const;
+	TType *handOut(TType *value) const;
 	void evalDataChanged(int metaTypeId, const QString &key, bool wasDeleted);
 	void evalDataResetted();
 };
@@ -255,18 +380,36 @@ TType DataTypeStore<TType, TKey>::load(const TKey &key) const
 	return _store->load<TType>(key);
 }
 
+template <typename TType, typename TKey>
+QVariantMap DataTypeStore<TType, TKey>::loadProperties(const TKey &key, const QStringList &properties) const
+{
+	return _store->loadProperties<TType>(key, properties);
+}
+
 template <typename TType, typename TKey>
 void DataTypeStore<TType, TKey>::save(const TType &value)
 {
 	_store->save(value);
 }
 
+template <typename TType, typename TKey>
+void DataTypeStore<TType, TKey>::saveAll(const QList<TType> &values)
+{
+	_store->saveAll(values);
+}
+
 template <typename TType, typename TKey>
 bool DataTypeStore<TType, TKey>::remove(const TKey &key)
 {
 	return _store->remove<TType>(key);
 }
 
+template <typename TType, typename TKey>
+int DataTypeStore<TType, TKey>::removeAll(const QList<TKey> &keys)
+{
+	return _store->removeAll<TType>(keys);
+}
+
 template<typename TType, typename TKey>
 template <typename TX>
 void DataTypeStore<TType, TKey>::update(std::enable_if_t<__helpertypes::is_object<TX>::value, TX> object) const
@@ -280,6 +423,90 @@ QList<TType> DataTypeStore<TType, TKey>::search(const QString &query, DataStore:
 	return _store->search<TType>(query, mode);
 }
 
+template<typename TType, typename TKey>
+QList<DataStore::SearchMatch> DataTypeStore<TType, TKey>::searchMatches(const QString &query, int limit) const
+{
+	return _store->searchMatches<TType>(query, limit);
+}
+
+template<typename TType, typename TKey>
+QList<TKey> DataTypeStore<TType, TKey>::keysByIndex(const QString &property, const QVariant &value) const
+{
+	QList<TKey> rList;
+	for(const auto &key : _store->keysByIndex<TType>(property, value))
+		rList.append(toKey(key));
+	return rList;
+}
+
+template<typename TType, typename TKey>
+QList<TType> DataTypeStore<TType, TKey>::loadByIndex(const QString &property, const QVariant &value) const
+{
+	return _store->loadByIndex<TType>(property, value);
+}
+
+template<typename TType, typename TKey>
+quint64 DataTypeStore<TType, TKey>::count(const DataQuery &query) const
+{
+	return _store->count<TType>(query);
+}
+
+template<typename TType, typename TKey>
+QList<TKey> DataTypeStore<TType, TKey>::keys(const DataQuery &query) const
+{
+	QList<TKey> rList;
+	for(const auto &key : _store->keys<TType>(query))
+		rList.append(toKey(key));
+	return rList;
+}
+
+template<typename TType, typename TKey>
+QList<TType> DataTypeStore<TType, TKey>::query(const DataQuery &query) const
+{
+	return _store->query<TType>(query);
+}
+
+template<typename TType, typename TKey>
+DataCursor *DataTypeStore<TType, TKey>::cursor(QObject *parent) const
+{
+	return _store->cursor<TType>(parent);
+}
+
+template<typename TType, typename TKey>
+QFuture<qint64> DataTypeStore<TType, TKey>::countAsync() const
+{
+	return _store->countAsync<TType>();
+}
+
+template<typename TType, typename TKey>
+QFuture<QList<TType>> DataTypeStore<TType, TKey>::loadAllAsync() const
+{
+	return _store->loadAllAsync<TType>();
+}
+
+template<typename TType, typename TKey>
+QFuture<TType> DataTypeStore<TType, TKey>::loadAsync(const TKey &key) const
+{
+	return _store->loadAsync<TType>(QVariant::fromValue(key).toString());
+}
+
+template<typename TType, typename TKey>
+QFuture<void> DataTypeStore<TType, TKey>::saveAsync(const TType &value)
+{
+	return _store->saveAsync<TType>(value);
+}
+
+template<typename TType, typename TKey>
+QFuture<bool> DataTypeStore<TType, TKey>::removeAsync(const TKey &key)
+{
+	return _store->removeAsync<TType>(QVariant::fromValue(key).toString());
+}
+
+template<typename TType, typename TKey>
+QFuture<QList<TType>> DataTypeStore<TType, TKey>::searchAsync(const QString &query, DataStore::SearchMode mode) const
+{
+	return _store->searchAsync<TType>(query, mode);
+}
+
 template<typename TType, typename TKey>
 void DataTypeStore<TType, TKey>::iterate(const std::function<bool (TType)> &iterator, bool skipBroken)
 {
@@ -314,6 +541,14 @@ void DataTypeStore<TType, TKey>::evalDataChanged(int metaTypeId, const QString &
 	}
 }
 
+// ------------- GENERIC IMPLEMENTATION CachingDataTypeStoreBase -------------
+
+template <typename TResult, typename TFunc>
+QFuture<TResult> CachingDataTypeStoreBase::runAsync(const DataStore *store, const ObjectKey &orderKey, TFunc func)
+{
+	return store->runAsync<TResult>(orderKey, std::move(func));
+}
+
 // ------------- GENERIC IMPLEMENTATION CachingDataTypeStore -------------
 
 template <typename TType, typename TKey>
@@ -323,14 +558,29 @@ CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(QObject *parent) :
 
 template <typename TType, typename TKey>
 CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(const QString &setupName, QObject *parent) :
-	CachingDataTypeStore{new DataStore(setupName, nullptr), parent}
+	CachingDataTypeStore{setupName, LoadSynchronous, 0, parent}
+{}
+
+template <typename TType, typename TKey>
+CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(DataStore *store, QObject *parent) :
+	CachingDataTypeStore{store, LoadSynchronous, 0, parent}
+{}
+
+template <typename TType, typename TKey>
+CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(LoadMode mode, int maxSize, QObject *parent) :
+	CachingDataTypeStore{DefaultSetup, mode, maxSize, parent}
+{}
+
+template <typename TType, typename TKey>
+CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(const QString &setupName, LoadMode mode, int maxSize, QObject *parent) :
+	CachingDataTypeStore{new DataStore(setupName, nullptr), mode, maxSize, parent}
 {
 	_store->setParent(this);
 }
 
 template <typename TType, typename TKey>
-CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(DataStore *store, QObject *parent) :
-	DataTypeStoreBase{parent},
+CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(DataStore *store, LoadMode mode, int maxSize, QObject *parent) :
+	CachingDataTypeStoreBase{maxSize, parent},
 	_store{store}
 {
 	connect(_store, &DataStore::dataChanged,
@@ -338,11 +588,7 @@ CachingDataTypeStore<TType, TKey>::CachingDataTypeStore(DataStore *store, QObjec
 	connect(_store, &DataStore::dataResetted,
 			this, &CachingDataTypeStore::evalDataResetted);
 
-	auto userProp = TType::staticMetaObject.userProperty();
-	store->iterate<TType>([&](const TType &data){
-		_data.insert(userProp.readOnGadget(&data).template value<TKey>(), data);
-		return true;
-	}, true);
+	populate(mode);
 }
 
 template<typename TType, typename TKey>
@@ -354,37 +600,88 @@ DataStore *CachingDataTypeStore<TType, TKey>::store() const
 template <typename TType, typename TKey>
 qint64 CachingDataTypeStore<TType, TKey>::count() const
 {
-	return _data.size();
+	if(isComplete())
+		return _data.size();
+	else
+		return _store->count<TType>();
 }
 
 template <typename TType, typename TKey>
 QList<TKey> CachingDataTypeStore<TType, TKey>::keys() const
 {
-	return _data.keys();
+	if(isComplete())
+		return _data.keys();
+	else
+		return _store->keys<TType, TKey>();
 }
 
 template<typename TType, typename TKey>
 bool CachingDataTypeStore<TType, TKey>::contains(const TKey &key) const
 {
-	return _data.contains(key);
+	if(_data.contains(key))
+		return true;
+	else if(isComplete())
+		return false;
+	else
+		return _store->contains<TType>(QVariant::fromValue(key).toString());
 }
 
 template <typename TType, typename TKey>
 QList<TType> CachingDataTypeStore<TType, TKey>::loadAll() const
 {
-	return _data.values();
+	if(isComplete())
+		return _data.values();
+	else
+		return _store->loadAll<TType>();
 }
 
 template <typename TType, typename TKey>
 TType CachingDataTypeStore<TType, TKey>::load(const TKey &key) const
 {
-	return _data.value(key);
+	auto it = _data.constFind(key);
+	if(it != _data.constEnd()) {
+		touch(key);
+		return *it;
+	} else if(isComplete())
+		return {};
+
+	try {
+		auto data = _store->load<TType>(QVariant::fromValue(key).toString());
+		cache(key, data);
+		return data;
+	} catch(NoDataException &) {
+		return {};
+	}
 }
 
 template <typename TType, typename TKey>
 void CachingDataTypeStore<TType, TKey>::save(const TType &value)
 {
-	_store->save(value);
+	auto userProp = TType::staticMetaObject.userProperty();
+	auto key = userProp.readOnGadget(&value).template value<TKey>();
+	_savedData.insert(key, value);
+	try {
+		_store->save(value);
+	} catch(...) {
+		_savedData.remove(key);
+		throw;
+	}
+	_savedData.remove(key);
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType, TKey>::saveAll(const QList<TType> &values)
+{
+	auto userProp = TType::staticMetaObject.userProperty();
+	for(const auto &value : values)
+		_savedData.insert(userProp.readOnGadget(&value).template value<TKey>(), value);
+	try {
+		_store->saveAll(values);
+	} catch(...) {
+		_savedData.clear();
+		throw;
+	}
+	_savedData.clear();
 }
 
 template <typename TType, typename TKey>
@@ -393,10 +690,16 @@ bool CachingDataTypeStore<TType, TKey>::remove(const TKey &key)
 	return _store->remove<TType>(QVariant::fromValue(key).toString());
 }
 
+template <typename TType, typename TKey>
+int CachingDataTypeStore<TType, TKey>::removeAll(const QList<TKey> &keys)
+{
+	return _store->removeAll<TType>(keys);
+}
+
 template<typename TType, typename TKey>
 TType CachingDataTypeStore<TType, TKey>::take(const TKey &key)
 {
-	auto mData = _data.value(key);
+	auto mData = load(key);
 	if(_store->remove<TType>(QVariant::fromValue(key).toString()))
 		return mData;
 	else
@@ -427,18 +730,131 @@ TKey CachingDataTypeStore<TType, TKey>::toKey(const QString &key)
 	return QVariant(key).value<TKey>();
 }
 
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType, TKey>::populate(LoadMode mode)
+{
+	if(mode == LoadSynchronous) {
+		auto userProp = TType::staticMetaObject.userProperty();
+		_store->iterate<TType>([&](const TType &data){
+			cache(userProp.readOnGadget(&data).template value<TKey>(), data);
+			return maxSize() == 0 || _data.size() < maxSize();
+		}, true);
+		return;
+	}
+
+	setReady(false);
+	auto watcher = new QFutureWatcher<QStringList>{this};
+	connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher](){
+		watcher->deleteLater();
+		if(isReady()) //resetted while loading
+			return;
+		try {
+			_loadKeys = watcher->result();
+			if(maxSize() > 0)
+				_loadKeys = _loadKeys.mid(0, maxSize());
+			loadChunk(0);
+		} catch(QException &e) {
+			qWarning(QLoggingCategory{qUtf8Printable(QStringLiteral("qtdatasync.%1.CachingDataTypeStore").arg(setupName()))})
+					<< "Failed to load keys with error" << e.what();
+			setReady(true);
+		}
+	});
+	watcher->setFuture(_store->keysAsync<TType>());
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType, TKey>::loadChunk(int offset)
+{
+	if(offset >= _loadKeys.size()) {
+		_loadKeys.clear();
+		_changedKeys.clear();
+		setReady(true);
+		return;
+	}
+
+	auto chunk = _loadKeys.mid(offset, LoadChunkSize);
+	auto watcher = new QFutureWatcher<QList<TType>>{this};
+	connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, offset](){
+		watcher->deleteLater();
+		if(isReady())
+			return;
+		try {
+			auto userProp = TType::staticMetaObject.userProperty();
+			for(const auto &data : watcher->result()) {
+				auto key = userProp.readOnGadget(&data).template value<TKey>();
+				//changes since the keys were loaded have already been applied
+				if(!_changedKeys.contains(key) && !_data.contains(key))
+					cache(key, data);
+			}
+		} catch(QException &e) {
+			qWarning(QLoggingCategory{qUtf8Printable(QStringLiteral("qtdatasync.%1.CachingDataTypeStore").arg(setupName()))})
+					<< "Failed to load data with error" << e.what();
+		}
+		auto loaded = qMin(offset + LoadChunkSize, _loadKeys.size());
+		emit loadProgress(loaded, _loadKeys.size());
+		loadChunk(loaded);
+	});
+	watcher->setFuture(runAsync<QList<TType>>(_store, ObjectKey{QMetaType::typeName(qMetaTypeId<TType>())}, [chunk](DataStore *store) {
+		QList<TType> result;
+		result.reserve(chunk.size());
+		for(const auto &key : chunk) {
+			try {
+				result.append(store->template load<TType>(key));
+			} catch(NoDataException &) {
+				//removed after the keys were loaded
+			}
+		}
+		return result;
+	}));
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType, TKey>::cache(const TKey &key, const TType &value) const
+{
+	_data.insert(key, value);
+	touch(key);
+	//trim with some slack, so not every insert has to evict
+	if(maxSize() == 0 || _data.size() <= maxSize() + maxSize() / 4)
+		return;
+
+	QVector<QPair<quint64, TKey>> uses;
+	uses.reserve(_lastUse.size());
+	for(auto it = _lastUse.constBegin(); it != _lastUse.constEnd(); ++it)
+		uses.append({it.value(), it.key()});
+	auto evictCount = _data.size() - maxSize();
+	std::nth_element(uses.begin(), uses.begin() + evictCount, uses.end(), [](const QPair<quint64, TKey> &a, const QPair<quint64, TKey> &b) {
+		return a.first < b.first;
+	});
+	for(auto i = 0; i < evictCount; i++) {
+		_data.remove(uses[i].second);
+		_lastUse.remove(uses[i].second);
+	}
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType, TKey>::touch(const TKey &key) const
+{
+	if(maxSize() > 0)
+		_lastUse.insert(key, ++_useCounter);
+}
+
 template <typename TType, typename TKey>
 void CachingDataTypeStore<TType, TKey>::evalDataChanged(int metaTypeId, const QString &key, bool wasDeleted)
 {
 	try {
 		if(metaTypeId == qMetaTypeId<TType>()) {
 			auto rKey = toKey(key);
+			if(!isReady())
+				_changedKeys.insert(rKey);
 			if(wasDeleted) {
 				_data.remove(rKey);
+				_lastUse.remove(rKey);
 				emit dataChanged(key, QVariant());
 			} else {
-				auto data = _store->load<TType>(key);
-				_data.insert(rKey, data);
+				//saves made through this store already provide the data
+				auto it = _savedData.constFind(rKey);
+				auto data = it != _savedData.constEnd() ? *it : _store->load<TType>(key);
+				cache(rKey, data);
 				emit dataChanged(key, QVariant::fromValue(data));
 			}
 		}
@@ -452,6 +868,11 @@ template <typename TType, typename TKey>
 void CachingDataTypeStore<TType, TKey>::evalDataResetted()
 {
 	_data.clear();
+	_lastUse.clear();
+	//nothing left to be loaded
+	_loadKeys.clear();
+	_changedKeys.clear();
+	setReady(true);
 	emit dataResetted();
 }
 
@@ -464,28 +885,37 @@ CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(QObject *parent) :
 
 template <typename TType, typename TKey>
 CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(const QString &setupName, QObject *parent) :
-	CachingDataTypeStore{new DataStore(setupName, nullptr), parent}
+	CachingDataTypeStore{setupName, LoadSynchronous, 0, parent}
+{}
+
+template <typename TType, typename TKey>
+CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(DataStore *store, QObject *parent) :
+	CachingDataTypeStore{store, LoadSynchronous, 0, parent}
+{}
+
+template <typename TType, typename TKey>
+CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(LoadMode mode, int maxSize, QObject *parent) :
+	CachingDataTypeStore{DefaultSetup, mode, maxSize, parent}
+{}
+
+template <typename TType, typename TKey>
+CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(const QString &setupName, LoadMode mode, int maxSize, QObject *parent) :
+	CachingDataTypeStore{new DataStore(setupName, nullptr), mode, maxSize, parent}
 {
 	_store->setParent(this);
 }
 
 template <typename TType, typename TKey>
-CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(DataStore *store, QObject *parent) :
-	DataTypeStoreBase{parent},
+CachingDataTypeStore<TType*, TKey>::CachingDataTypeStore(DataStore *store, LoadMode mode, int maxSize, QObject *parent) :
+	CachingDataTypeStoreBase{maxSize, parent},
 	_store{store}
-
 {
 	connect(_store, &DataStore::dataChanged,
 			this, &CachingDataTypeStore::evalDataChanged);
 	connect(_store, &DataStore::dataResetted,
 			this, &CachingDataTypeStore::evalDataResetted);
 
-	auto userProp = TType::staticMetaObject.userProperty();
-	store->iterate<TType*>([&](TType *data){
-		data->setParent(this);
-		_data.insert(userProp.read(data).template value<TKey>(), data);
-		return true;
-	}, true);
+	populate(mode);
 }
 
 template<typename TType, typename TKey>
@@ -497,37 +927,116 @@ DataStore *CachingDataTypeStore<TType*, TKey>::store() const
 template <typename TType, typename TKey>
 qint64 CachingDataTypeStore<TType*, TKey>::count() const
 {
-	return _data.size();
+	if(isComplete())
+		return _data.size();
+	else
+		return _store->count<TType*>();
 }
 
 template <typename TType, typename TKey>
 QList<TKey> CachingDataTypeStore<TType*, TKey>::keys() const
 {
-	return _data.keys();
+	if(isComplete())
+		return _data.keys();
+	else
+		return _store->keys<TType*, TKey>();
 }
 
 template<typename TType, typename TKey>
 bool CachingDataTypeStore<TType *, TKey>::contains(const TKey &key) const
 {
-	return _data.contains(key);
+	if(_data.contains(key))
+		return true;
+	else if(isComplete())
+		return false;
+	else
+		return _store->contains<TType*>(QVariant::fromValue(key).toString());
 }
 
 template <typename TType, typename TKey>
 QList<TType*> CachingDataTypeStore<TType*, TKey>::loadAll() const
 {
-	return _data.values();
+	if(isComplete()) {
+		auto result = _data.values();
+		for(auto &data : result)
+			data = handOut(data);
+		return result;
+	}
+
+	//bounded stores hand out the loaded objects and only cache copies of the first maxSize ones
+	auto userProp = TType::staticMetaObject.userProperty();
+	QList<TType*> result;
+	for(auto data : _store->loadAll<TType*>()) {
+		auto key = userProp.read(data).template value<TKey>();
+		auto it = _data.constFind(key);
+		if(maxSize() == 0) {
+			if(it != _data.constEnd()) {
+				result.append(*it);
+				delete data;
+			} else {
+				cache(key, data);
+				result.append(data);
+			}
+		} else {
+			if(result.size() < maxSize()) {
+				if(it != _data.constEnd())
+					touch(key);
+				else
+					cache(key, handOut(data));
+			}
+			result.append(data);
+		}
+	}
+	return result;
 }
 
 template <typename TType, typename TKey>
 TType *CachingDataTypeStore<TType*, TKey>::load(const TKey &key) const
 {
-	return _data.value(key);
+	auto data = _data.value(key, nullptr);
+	if(data) {
+		touch(key);
+		return handOut(data);
+	} else if(isComplete())
+		return nullptr;
+
+	try {
+		data = _store->load<TType*>(QVariant::fromValue(key).toString());
+		cache(key, data);
+		return handOut(data);
+	} catch(NoDataException &) {
+		return nullptr;
+	}
 }
 
 template <typename TType, typename TKey>
 void CachingDataTypeStore<TType*, TKey>::save(TType *value)
 {
-	_store->save(value);
+	auto userProp = TType::staticMetaObject.userProperty();
+	auto key = userProp.read(value).template value<TKey>();
+	_savedData.insert(key, value);
+	try {
+		_store->save(value);
+	} catch(...) {
+		_savedData.remove(key);
+		throw;
+	}
+	_savedData.remove(key);
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType*, TKey>::saveAll(const QList<TType*> &values)
+{
+	auto userProp = TType::staticMetaObject.userProperty();
+	for(auto value : values)
+		_savedData.insert(userProp.read(value).template value<TKey>(), value);
+	try {
+		_store->saveAll(values);
+	} catch(...) {
+		_savedData.clear();
+		throw;
+	}
+	_savedData.clear();
 }
 
 template <typename TType, typename TKey>
@@ -536,19 +1045,37 @@ bool CachingDataTypeStore<TType*, TKey>::remove(const TKey &key)
 	return _store->remove<TType*>(key);
 }
 
+template <typename TType, typename TKey>
+int CachingDataTypeStore<TType*, TKey>::removeAll(const QList<TKey> &keys)
+{
+	return _store->removeAll<TType*>(keys);
+}
+
 template<typename TType, typename TKey>
 TType* CachingDataTypeStore<TType*, TKey>::take(const TKey &key)
 {
-	auto mData = _data.take(key);
+	auto mData = load(key);
+	if(!mData)
+		return nullptr;
+	auto cached = _data.take(key);
+	_lastUse.remove(key);
 	try {
-		if(!_store->remove<TType*>(QVariant::fromValue(key).toString()))
+		if(!_store->remove<TType*>(QVariant::fromValue(key).toString())) {
+			if(mData != cached)
+				delete mData;
 			return nullptr;
+		}
 	} catch(...) {
-		_data.insert(key, mData);
+		if(mData != cached)
+			delete mData;
+		cache(key, cached);
 		throw;
 	}
+	if(mData != cached)
+		cached->deleteLater();
 	mData->setParent(nullptr);
-	emit dataChanged(QVariant(key).toString(), QVariant());//manual emit required, because not happening in change signal because removed before
+	if(isComplete()) //otherwise, the change signal already emitted it
+		emit dataChanged(QVariant(key).toString(), QVariant());//manual emit required, because not happening in change signal because removed before
 	return mData;
 }
 
@@ -576,31 +1103,170 @@ TKey CachingDataTypeStore<TType*, TKey>::toKey(const QString &key)
 	return QVariant(key).value<TKey>();
 }
 
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType*, TKey>::populate(LoadMode mode)
+{
+	if(mode == LoadSynchronous) {
+		auto userProp = TType::staticMetaObject.userProperty();
+		_store->iterate<TType*>([&](TType *data){
+			cache(userProp.read(data).template value<TKey>(), data);
+			return maxSize() == 0 || _data.size() < maxSize();
+		}, true);
+		return;
+	}
+
+	setReady(false);
+	auto watcher = new QFutureWatcher<QStringList>{this};
+	connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher](){
+		watcher->deleteLater();
+		if(isReady()) //resetted while loading
+			return;
+		try {
+			_loadKeys = watcher->result();
+			if(maxSize() > 0)
+				_loadKeys = _loadKeys.mid(0, maxSize());
+			loadChunk(0);
+		} catch(QException &e) {
+			qWarning(QLoggingCategory{qUtf8Printable(QStringLiteral("qtdatasync.%1.CachingDataTypeStore").arg(setupName()))})
+					<< "Failed to load keys with error" << e.what();
+			setReady(true);
+		}
+	});
+	watcher->setFuture(_store->keysAsync<TType*>());
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType*, TKey>::loadChunk(int offset)
+{
+	if(offset >= _loadKeys.size()) {
+		_loadKeys.clear();
+		_changedKeys.clear();
+		setReady(true);
+		return;
+	}
+
+	auto chunk = _loadKeys.mid(offset, LoadChunkSize);
+	auto watcher = new QFutureWatcher<QList<TType*>>{this};
+	connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, offset](){
+		watcher->deleteLater();
+		QList<TType*> result;
+		try {
+			result = watcher->result();
+		} catch(QException &e) {
+			qWarning(QLoggingCategory{qUtf8Printable(QStringLiteral("qtdatasync.%1.CachingDataTypeStore").arg(setupName()))})
+					<< "Failed to load data with error" << e.what();
+		}
+		if(isReady()) {
+			qDeleteAll(result);
+			return;
+		}
+
+		auto userProp = TType::staticMetaObject.userProperty();
+		for(auto data : result) {
+			auto key = userProp.read(data).template value<TKey>();
+			//changes since the keys were loaded have already been applied
+			if(!_changedKeys.contains(key) && !_data.contains(key))
+				cache(key, data);
+			else
+				delete data;
+		}
+		auto loaded = qMin(offset + LoadChunkSize, _loadKeys.size());
+		emit loadProgress(loaded, _loadKeys.size());
+		loadChunk(loaded);
+	});
+	watcher->setFuture(runAsync<QList<TType*>>(_store, ObjectKey{QMetaType::typeName(qMetaTypeId<TType*>())}, [chunk](DataStore *store) {
+		QList<TType*> result;
+		result.reserve(chunk.size());
+		for(const auto &key : chunk) {
+			try {
+				result.append(store->template load<TType*>(key));
+			} catch(NoDataException &) {
+				//removed after the keys were loaded
+			}
+		}
+		return result;
+	}));
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType*, TKey>::cache(const TKey &key, TType *value) const
+{
+	value->setParent(const_cast<CachingDataTypeStore*>(this));
+	auto oldData = _data.value(key, nullptr);
+	_data.insert(key, value);
+	if(oldData && oldData != value)
+		oldData->deleteLater();
+	touch(key);
+	//trim with some slack, so not every insert has to evict
+	if(maxSize() == 0 || _data.size() <= maxSize() + maxSize() / 4)
+		return;
+
+	QVector<QPair<quint64, TKey>> uses;
+	uses.reserve(_lastUse.size());
+	for(auto it = _lastUse.constBegin(); it != _lastUse.constEnd(); ++it)
+		uses.append({it.value(), it.key()});
+	auto evictCount = _data.size() - maxSize();
+	std::nth_element(uses.begin(), uses.begin() + evictCount, uses.end(), [](const QPair<quint64, TKey> &a, const QPair<quint64, TKey> &b) {
+		return a.first < b.first;
+	});
+	for(auto i = 0; i < evictCount; i++) {
+		//iterators and change signals might still refer to it until control returns to the eventloop
+		_data.take(uses[i].second)->deleteLater();
+		_lastUse.remove(uses[i].second);
+	}
+}
+
+template <typename TType, typename TKey>
+void CachingDataTypeStore<TType*, TKey>::touch(const TKey &key) const
+{
+	if(maxSize() > 0)
+		_lastUse.insert(key, ++_useCounter);
+}
+
+template <typename TType, typename TKey>
+TType *CachingDataTypeStore<TType*, TKey>::handOut(TType *value) const
+{
+	//bounded stores may evict any cached object, so callers always get their own copy
+	if(maxSize() == 0)
+		return value;
+	auto meta = value->metaObject();
+	auto copy = qobject_cast<TType*>(meta->newInstance(Q_ARG(QObject*, nullptr)));
+	Q_ASSERT_X(copy, Q_FUNC_INFO, "TType must have an invokable constructor with a QObject* parent");
+	for(auto i = 0; i < meta->propertyCount(); i++) {
+		auto prop = meta->property(i);
+		prop.write(copy, prop.read(value));
+	}
+	return copy;
+}
+
 template <typename TType, typename TKey>
 void CachingDataTypeStore<TType*, TKey>::evalDataChanged(int metaTypeId, const QString &key, bool wasDeleted)
 {
 	try {
 		if(metaTypeId == qMetaTypeId<TType*>()) {
 			auto rKey = toKey(key);
+			if(!isReady())
+				_changedKeys.insert(rKey);
 			if(wasDeleted) {
 				auto data = _data.take(rKey);
+				_lastUse.remove(rKey);
 				if(data) {
 					emit dataChanged(key, QVariant());
 					data->deleteLater();
-				}
+				} else if(!isComplete()) //the dataset might not have been cached
+					emit dataChanged(key, QVariant());
 			} else {
-				if(_data.contains(rKey)) {
-					_store->update(_data.value(rKey));
-					emit dataChanged(key, QVariant::fromValue(_data.value(rKey)));
+				auto data = _data.value(rKey, nullptr);
+				if(data) {
+					//saving the cached object itself means it is already up to date
+					if(_savedData.value(rKey, nullptr) != data)
+						_store->update(data);
+					touch(rKey);
 				} else {
-					auto data = _store->load<TType*>(key);
-					auto oldData = _data.take(rKey);
-					data->setParent(this);
-					_data.insert(rKey, data);
-					emit dataChanged(key, QVariant::fromValue(data));
-					if(oldData)
-						oldData->deleteLater();
+					data = _store->load<TType*>(key);
+					cache(rKey, data);
 				}
+				emit dataChanged(key, QVariant::fromValue(data));
 			}
 		}
 	} catch(QException &e) {
@@ -614,6 +1280,11 @@ void CachingDataTypeStore<TType*, TKey>::evalDataResetted()
 {
 	auto data = _data;
 	_data.clear();
+	_lastUse.clear();
+	//nothing left to be loaded
+	_loadKeys.clear();
+	_changedKeys.clear();
+	setReady(true);
 	emit dataResetted();
 	for(auto d : data)
 		d->deleteLater();
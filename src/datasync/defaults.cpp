@@ -6,6 +6,7 @@
 #include "changeemitter_p.h"
 #include "emitteradapter_p.h"
 #include "qtrotransportregistry.h"
+#include "asyncstorepool_p.h"
 
 #include <QtCore/QThread>
 #include <QtCore/QStandardPaths>
@@ -197,6 +198,16 @@ QSqlDatabase *DatabaseRef::operator->() const
 	return &(d->db());
 }
 
+QSqlQuery DatabaseRef::cachedQuery(const QString &statement) const
+{
+	return d->cachedQuery(statement);
+}
+
+void DatabaseRef::clearQueryCache() const
+{
+	d->clearQueryCache();
+}
+
 void DatabaseRef::drop()
 {
 	d.reset();
@@ -238,12 +249,18 @@ void DefaultsPrivate::removeDefaults(const QString &setupName)
 {
 	QMutexLocker _(&setupDefaultsMutex);
 	QWeakPointer<DefaultsPrivate> weakRef;
+	auto pooled = false;
 	{
 		auto ref = setupDefaults.take(setupName);
-		if(ref)
+		if(ref) {
+			//the stores of the async pool hold references until their threads release them
+			_.unlock();
+			pooled = AsyncStorePool::dropStores(setupName);
+			_.relock();
 			weakRef = ref.toWeakRef();
+		}
 	}
-	if(weakRef) {
+	if(weakRef && !pooled) {
 #undef QTDATASYNC_LOG
 #define QTDATASYNC_LOG weakRef.toStrongRef()->logger
 		logCritical() << "Defaults for setup still in user after setup was deleted!";
@@ -290,7 +307,7 @@ DefaultsPrivate::DefaultsPrivate(QString setupName, QDir storageDir, QUrl roAddr
 	//create cache
 	auto maxSize = properties.value(Defaults::CacheSize).toInt();
 	if(maxSize > 0)
-		cacheInfo = QSharedPointer<EmitterAdapter::CacheInfo>::create(maxSize);
+		cacheInfo = QSharedPointer<StoreCache>::create(maxSize, properties.value(Defaults::ObjectCache).toBool());
 }
 
 DefaultsPrivate::~DefaultsPrivate()
@@ -303,9 +320,8 @@ DefaultsPrivate::~DefaultsPrivate()
 
 QSqlDatabase DefaultsPrivate::acquireDatabase()
 {
-	auto name = DefaultsPrivate::DatabaseName
-				.arg(setupName, QString::number(reinterpret_cast<quint64>(QThread::currentThread()), 16));
-	if((dbRefHash.localData()[setupName])++ == 0) {
+	auto name = connectionName(setupName);
+	if((dbRefHash.localData()[setupName].refCount)++ == 0) {
 		logDebug() << "Acquiring database for thread" << QThread::currentThread();
 		auto database = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), name);
 		database.setDatabaseName(storageDir.absoluteFilePath(QStringLiteral("store.db")));
@@ -342,6 +358,65 @@ QSqlDatabase DefaultsPrivate::acquireDatabase()
 		QSqlQuery pragmaForeignKeys(database);
 		if(!pragmaForeignKeys.exec(QStringLiteral("PRAGMA foreign_keys = ON")))
 			logWarning() << "Failed to enable foreign_keys support";
+
+		//configure journal and sync behaviour
+		QString journalMode;
+		switch(properties.value(Defaults::DatabaseJournalMode).value<Setup::JournalMode>()) {
+		case Setup::JournalMode::Delete:
+			journalMode = QStringLiteral("DELETE");
+			break;
+		case Setup::JournalMode::Truncate:
+			journalMode = QStringLiteral("TRUNCATE");
+			break;
+		case Setup::JournalMode::Persist:
+			journalMode = QStringLiteral("PERSIST");
+			break;
+		case Setup::JournalMode::Wal:
+			journalMode = QStringLiteral("WAL");
+			break;
+		default:
+			Q_UNREACHABLE();
+			break;
+		}
+		QSqlQuery pragmaJournalMode(database);
+		if(!pragmaJournalMode.exec(QStringLiteral("PRAGMA journal_mode = %1").arg(journalMode)) ||
+		   !pragmaJournalMode.first() ||
+		   pragmaJournalMode.value(0).toString().toUpper() != journalMode) {
+			logWarning() << "Failed to set journal_mode to" << journalMode
+						 << "- database error:" << pragmaJournalMode.lastError().text();
+		}
+
+		QString syncMode;
+		switch(properties.value(Defaults::DatabaseSynchronous).value<Setup::SynchronousMode>()) {
+		case Setup::SynchronousMode::Off:
+			syncMode = QStringLiteral("OFF");
+			break;
+		case Setup::SynchronousMode::Normal:
+			syncMode = QStringLiteral("NORMAL");
+			break;
+		case Setup::SynchronousMode::Full:
+			syncMode = QStringLiteral("FULL");
+			break;
+		case Setup::SynchronousMode::Extra:
+			syncMode = QStringLiteral("EXTRA");
+			break;
+		default:
+			Q_UNREACHABLE();
+			break;
+		}
+		QSqlQuery pragmaSynchronous(database);
+		if(!pragmaSynchronous.exec(QStringLiteral("PRAGMA synchronous = %1").arg(syncMode)))
+			logWarning() << "Failed to set synchronous to" << syncMode;
+
+		QSqlQuery pragmaMmapSize(database);
+		if(!pragmaMmapSize.exec(QStringLiteral("PRAGMA mmap_size = %1")
+								.arg(properties.value(Defaults::DatabaseMmapSize).toLongLong())))
+			logWarning() << "Failed to set mmap_size";
+
+		QSqlQuery pragmaCacheSize(database);
+		if(!pragmaCacheSize.exec(QStringLiteral("PRAGMA cache_size = %1")
+								 .arg(properties.value(Defaults::DatabaseCacheSize).toInt())))
+			logWarning() << "Failed to set cache_size";
 	}
 
 	return QSqlDatabase::database(name);
@@ -349,12 +424,33 @@ QSqlDatabase DefaultsPrivate::acquireDatabase()
 
 void DefaultsPrivate::releaseDatabase()
 {
-	if(--(dbRefHash.localData()[setupName]) == 0) {
+	auto &info = dbRefHash.localData()[setupName];
+	if(--info.refCount == 0) {
 		logDebug() << "Releasing database for thread" << QThread::currentThread();
+		info.queryCache.clear(); //queries must be gone before the connection is removed
 		releaseDatabaseImpl(setupName);
 	}
 }
 
+QSqlQuery DefaultsPrivate::cachedQuery(const QString &statement)
+{
+	auto &info = dbRefHash.localData()[setupName];
+	Q_ASSERT_X(info.refCount > 0, Q_FUNC_INFO, "Cached queries can only be created for acquired databases");
+	auto it = info.queryCache.find(statement);
+	if(it == info.queryCache.end()) {
+		QSqlQuery query{QSqlDatabase::database(connectionName(setupName), false)};
+		if(!query.prepare(statement))
+			return query; //do not cache failed queries, exec will report the error
+		it = info.queryCache.insert(statement, query);
+	}
+	return *it;
+}
+
+void DefaultsPrivate::clearQueryCache()
+{
+	dbRefHash.localData()[setupName].queryCache.clear();
+}
+
 QRemoteObjectNode *DefaultsPrivate::acquireNode()
 {
 	auto cThread = QThread::currentThread();
@@ -400,10 +496,15 @@ void DefaultsPrivate::makePassive()
 	}
 }
 
+QString DefaultsPrivate::connectionName(const QString &setupName)
+{
+	return DefaultsPrivate::DatabaseName
+			.arg(setupName, QString::number(reinterpret_cast<quint64>(QThread::currentThread()), 16));
+}
+
 void DefaultsPrivate::releaseDatabaseImpl(const QString &name)
 {
-	auto dbName = DefaultsPrivate::DatabaseName
-				  .arg(name, QString::number(reinterpret_cast<quint64>(QThread::currentThread()), 16));
+	auto dbName = connectionName(name);
 	QSqlDatabase::database(dbName).close();
 	QSqlDatabase::removeDatabase(dbName);
 }
@@ -412,13 +513,14 @@ void DefaultsPrivate::releaseDatabaseImpl(const QString &name)
 
 DefaultsPrivate::DatabaseHolder::~DatabaseHolder()
 {
-	for(auto it = constBegin(); it != constEnd(); it++) {
-		if(*it <= 0)
+	for(auto it = begin(); it != end(); it++) {
+		if(it->refCount <= 0)
 			continue;
 		qCCritical(qdssetup) << "Setup" << it.key()
-							 << "still has" << *it
+							 << "still has" << it->refCount
 							 << "open database references in thread" << QThread::currentThread()
 							 << "on destruction of that thread! Database will be force-closed";
+		it->queryCache.clear();
 		releaseDatabaseImpl(it.key());
 	}
 }
@@ -448,6 +550,18 @@ QSqlDatabase &DatabaseRefPrivate::db()
 	return _database;
 }
 
+QSqlQuery DatabaseRefPrivate::cachedQuery(const QString &statement)
+{
+	db(); //make sure the database is acquired
+	return _defaultsPrivate->cachedQuery(statement);
+}
+
+void DatabaseRefPrivate::clearQueryCache()
+{
+	if(_database.isValid())
+		_defaultsPrivate->clearQueryCache();
+}
+
 bool DatabaseRefPrivate::eventFilter(QObject *watched, QEvent *event)
 {
 	if(event->type() == QEvent::ThreadChange && watched == _object) {
@@ -15,6 +15,7 @@
 #include "QtDataSync/setup.h"
 
 class QSqlDatabase;
+class QSqlQuery;
 class QJsonSerializer;
 
 namespace QtDataSync {
@@ -49,6 +50,11 @@ public:
 	//! Arrow operator to access the database
 	QSqlDatabase *operator->() const;
 
+	//! Returns a prepared query for the statement, cached for the current thread's connection
+	QSqlQuery cachedQuery(const QString &statement) const;
+	//! Drops all cached queries of the current thread's connection
+	void clearQueryCache() const;
+
 	//! Drops the reference to the database early
 	void drop();
 
@@ -78,7 +84,16 @@ public:
 		CryptKeyParam, //!< @copybrief Setup::encryptionKeyParam
 		SymScheme, //!< @copybrief Setup::cipherScheme
 		SymKeyParam, //!< @copybrief Setup::cipherKeySize
-		EventLoggingMode //!< @copybrief Setup::eventLoggingMode
+		EventLoggingMode, //!< @copybrief Setup::eventLoggingMode
+		DataStorageMode, //!< @copybrief Setup::storageMode
+		DatabaseJournalMode, //!< @copybrief Setup::journalMode
+		DatabaseSynchronous, //!< @copybrief Setup::synchronousMode
+		DatabaseMmapSize, //!< @copybrief Setup::mmapSize
+		DatabaseCacheSize, //!< @copybrief Setup::databaseCacheSize
+		IndexedProperties, //!< @copybrief Setup::setIndexedProperties(const QByteArray &, const QStringList &)
+		CompressionLevels, //!< @copybrief Setup::setCompressionLevel(const QByteArray &, int)
+		FullTextProperties, //!< @copybrief Setup::setFullTextProperties(const QByteArray &, const QStringList &)
+		ObjectCache //!< @copybrief Setup::objectCacheEnabled
 	};
 	Q_ENUM(PropertyKey)
 
@@ -5,6 +5,7 @@
 #include <QtCore/QThreadStorage>
 
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
 
 #include <QtJsonSerializer/QJsonSerializer>
 
@@ -29,6 +30,8 @@ public:
 	~DatabaseRefPrivate() override;
 
 	QSqlDatabase &db();
+	QSqlQuery cachedQuery(const QString &statement);
+	void clearQueryCache();
 	bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
@@ -66,6 +69,8 @@ public:
 
 	QSqlDatabase acquireDatabase();
 	void releaseDatabase();
+	QSqlQuery cachedQuery(const QString &statement);
+	void clearQueryCache();
 
 	QRemoteObjectNode *acquireNode();
 
@@ -80,9 +85,15 @@ private Q_SLOTS:
 	void makePassive();
 
 private:
+	static QString connectionName(const QString &setupName);
 	static void releaseDatabaseImpl(const QString &name);
 
-	struct DatabaseHolder : public QHash<QString, quint64>
+	struct DatabaseInfo {
+		quint64 refCount = 0;
+		QHash<QString, QSqlQuery> queryCache;
+	};
+
+	struct DatabaseHolder : public QHash<QString, DatabaseInfo>
 	{
 		~DatabaseHolder();
 	};
@@ -102,7 +113,7 @@ private:
 	QMutex roMutex;
 	QHash<QThread*, QRemoteObjectNode*> roNodes;
 
-	QSharedPointer<EmitterAdapter::CacheInfo> cacheInfo;
+	QSharedPointer<StoreCache> cacheInfo;
 
 	ChangeEmitterReplica *passiveEmitter = nullptr;
 };
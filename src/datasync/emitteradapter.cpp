@@ -1,23 +1,26 @@
 #include "emitteradapter_p.h"
 #include "changeemitter_p.h"
+
+#include <QtCore/QCoreApplication>
+
 using namespace QtDataSync;
 
-EmitterAdapter::EmitterAdapter(QObject *changeEmitter, QSharedPointer<CacheInfo> cacheInfo, QObject *origin) :
+EmitterAdapter::EmitterAdapter(QObject *changeEmitter, QSharedPointer<StoreCache> cache, QObject *origin) :
 	QObject{origin},
 	_isPrimary{changeEmitter->metaObject()->inherits(&ChangeEmitter::staticMetaObject)},
 	_emitterBackend{changeEmitter},
-	_cache{std::move(cacheInfo)}
+	_cache{std::move(cache)}
 {
 	if(_isPrimary) {
-		connect(_emitterBackend, SIGNAL(dataChanged(QObject*,QtDataSync::ObjectKey,bool)),
-				this, SLOT(dataChangedImpl(QObject*,QtDataSync::ObjectKey,bool)),
+		connect(_emitterBackend, SIGNAL(dataChanged(QObject*,QByteArray,QStringList,bool)),
+				this, SLOT(dataChangedImpl(QObject*,QByteArray,QStringList,bool)),
 				Qt::QueuedConnection);
 		connect(_emitterBackend, SIGNAL(dataResetted(QObject*)),
 				this, SLOT(dataResettedImpl(QObject*)),
 				Qt::QueuedConnection);
 	} else {
-		connect(_emitterBackend, SIGNAL(remoteDataChanged(QtDataSync::ObjectKey,bool)),
-				this, SLOT(remoteDataChangedImpl(QtDataSync::ObjectKey,bool)),
+		connect(_emitterBackend, SIGNAL(remoteDataChanged(QByteArray,QStringList,bool)),
+				this, SLOT(remoteDataChangedImpl(QByteArray,QStringList,bool)),
 				Qt::QueuedConnection);
 		connect(_emitterBackend, SIGNAL(remoteDataResetted()),
 				this, SLOT(remoteDataResettedImpl()),
@@ -34,7 +37,9 @@ void EmitterAdapter::triggerChange(const ObjectKey &key, bool deleted, bool chan
 								  Q_ARG(QtDataSync::ObjectKey, key),
 								  Q_ARG(bool, deleted),
 								  Q_ARG(bool, changed));
-		emit dataChanged(key, deleted);//own change
+		//own change
+		emit dataChanged(key, deleted);
+		emit dataChangedBatch(key.typeName, {key.id}, deleted);
 	} else {
 		QMetaObject::invokeMethod(_emitterBackend, "triggerRemoteChange",
 								  Qt::QueuedConnection,
@@ -45,6 +50,31 @@ void EmitterAdapter::triggerChange(const ObjectKey &key, bool deleted, bool chan
 	}
 }
 
+void EmitterAdapter::triggerChanges(const QByteArray &typeName, const QStringList &ids, bool deleted, bool changed)
+{
+	if(_isPrimary) {
+		QMetaObject::invokeMethod(_emitterBackend, "triggerChanges",
+								  Qt::QueuedConnection,
+								  Q_ARG(QObject*, parent()),
+								  Q_ARG(QByteArray, typeName),
+								  Q_ARG(QStringList, ids),
+								  Q_ARG(bool, deleted),
+								  Q_ARG(bool, changed));
+		//own change
+		for(const auto &id : ids)
+			emit dataChanged({typeName, id}, deleted);
+		emit dataChangedBatch(typeName, ids, deleted);
+	} else {
+		QMetaObject::invokeMethod(_emitterBackend, "triggerRemoteChanges",
+								  Qt::QueuedConnection,
+								  Q_ARG(QByteArray, typeName),
+								  Q_ARG(QStringList, ids),
+								  Q_ARG(bool, deleted),
+								  Q_ARG(bool, changed));
+		//no change signal, because operating in passive setup
+	}
+}
+
 void EmitterAdapter::triggerClear(const QByteArray &typeName, const QStringList &ids)
 {
 	if(_isPrimary) {
@@ -55,6 +85,7 @@ void EmitterAdapter::triggerClear(const QByteArray &typeName, const QStringList
 								  Q_ARG(QStringList, ids));
 		for(const auto &id : ids)
 			emit dataChanged({typeName, id}, true);
+		emit dataChangedBatch(typeName, ids, true);
 	} else {
 		QMetaObject::invokeMethod(_emitterBackend, "triggerRemoteClear",
 								  Qt::QueuedConnection,
@@ -84,80 +115,97 @@ void EmitterAdapter::triggerUpload()
 							  Qt::QueuedConnection);
 }
 
-void EmitterAdapter::putCached(const ObjectKey &key, const QJsonObject &data, int costs)
+void EmitterAdapter::detachChanges()
 {
-	if(!_cache)
-		return;
+	//for stores on threads without an eventloop, the queued change events would never be delivered
+	QObject::disconnect(_emitterBackend, nullptr, this, nullptr);
+	QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+}
 
-	QWriteLocker _(&_cache->lock);
-	_cache->cache.insert(key, new QJsonObject(data), costs);
+void EmitterAdapter::putCached(const ObjectKey &key, const QJsonObject &data)
+{
+	if(_cache)
+		_cache->insert(key, data);
 }
 
-void EmitterAdapter::putCached(const QList<ObjectKey> &keys, const QList<QJsonObject> &data, const QList<int> &costs)
+void EmitterAdapter::putCached(const QList<ObjectKey> &keys, const QList<QJsonObject> &data, bool scan)
 {
 	Q_ASSERT(keys.size() == data.size());
-	Q_ASSERT(keys.size() == costs.size());
 	if(!_cache)
 		return;
 
-	QWriteLocker _(&_cache->lock);
 	for(auto i = 0; i < keys.size(); i++)
-		_cache->cache.insert(keys[i], new QJsonObject(data[i]), costs[i]);
+		_cache->insert(keys[i], data[i], scan);
 }
 
-bool EmitterAdapter::getCached(const ObjectKey &key, QJsonObject &data)
+bool EmitterAdapter::getCached(const ObjectKey &key, QJsonObject &data, StoreCache::MissingState *missing)
 {
-	if(!_cache)
-		return false;
-
-	QReadLocker _(&_cache->lock);
-	auto json = _cache->cache.object(key);
-	if(json) {
-		data = *json;
-		return true;
-	} else
+	if(_cache)
+		return _cache->lookup(key, data, missing);
+	else
 		return false;
 }
 
 bool EmitterAdapter::dropCached(const ObjectKey &key)
 {
-	if(!_cache)
+	if(_cache)
+		return _cache->remove(key);
+	else
 		return false;
+}
 
-	//check if cached
-	{
-		QReadLocker _(&_cache->lock);
-		if(!_cache->cache.contains(key))
-			return false;
-	}
+void EmitterAdapter::dropCached(const QByteArray &typeName, const QStringList &ids)
+{
+	if(_cache)
+		_cache->remove(typeName, ids);
+}
 
-	QWriteLocker _(&_cache->lock);
-	return _cache->cache.remove(key);
+void EmitterAdapter::dropCached()
+{
+	if(_cache)
+		_cache->clear();
 }
 
-void EmitterAdapter::dropCached(const QByteArray &typeName, const QStringList &ids)
+quint64 EmitterAdapter::cacheGeneration(const ObjectKey &key) const
 {
-	if(!_cache)
-		return;
+	if(_cache)
+		return _cache->generation(key);
+	else
+		return 0;
+}
 
-	QWriteLocker _(&_cache->lock);
-	for(const auto &id : ids)
-		_cache->cache.remove({typeName, id});
+void EmitterAdapter::putMissing(const ObjectKey &key, StoreCache::MissingState state, quint64 generation)
+{
+	if(_cache)
+		_cache->insertMissing(key, state, generation);
 }
 
-void EmitterAdapter::dropCached()
+bool EmitterAdapter::getCachedValue(const ObjectKey &key, int metaTypeId, QVariant &value)
 {
-	if(!_cache)
-		return;
+	if(_cache)
+		return _cache->lookupValue(key, metaTypeId, value);
+	else
+		return false;
+}
 
-	QWriteLocker _(&_cache->lock);
-	_cache->cache.clear();
+void EmitterAdapter::putCachedValue(const ObjectKey &key, const QJsonObject &source, int metaTypeId, const QVariant &value)
+{
+	if(_cache)
+		_cache->insertValue(key, source, metaTypeId, value);
 }
 
-void EmitterAdapter::dataChangedImpl(QObject *origin, const ObjectKey &key, bool deleted)
+StoreCache::Statistics EmitterAdapter::cacheStatistics(const QByteArray &typeName) const
+{
+	if(_cache)
+		return _cache->statistics(typeName);
+	else
+		return {};
+}
+
+void EmitterAdapter::dataChangedImpl(QObject *origin, const QByteArray &typeName, const QStringList &ids, bool deleted)
 {
 	if(origin == nullptr || origin != parent())
-		emit dataChanged(key, deleted);
+		emitChanges(typeName, ids, deleted);
 }
 
 void EmitterAdapter::dataResettedImpl(QObject *origin)
@@ -166,35 +214,23 @@ void EmitterAdapter::dataResettedImpl(QObject *origin)
 		emit dataResetted();
 }
 
-void EmitterAdapter::remoteDataChangedImpl(const ObjectKey &key, bool deleted)
-{
-	if(_cache) {
-		auto contains = false;
-		//check if cached
-		{
-			QReadLocker _(&_cache->lock);
-			contains = _cache->cache.contains(key);
-		}
-		//if chached, remove
-		if(contains) {
-			QWriteLocker _(&_cache->lock);
-			_cache->cache.remove(key);
-		}
-	}
-	emit dataChanged(key, deleted);
+void EmitterAdapter::remoteDataChangedImpl(const QByteArray &typeName, const QStringList &ids, bool deleted)
+{
+	if(_cache)
+		_cache->remove(typeName, ids);
+	emitChanges(typeName, ids, deleted);
 }
 
 void EmitterAdapter::remoteDataResettedImpl()
 {
-	if(_cache) {
-		QWriteLocker _(&_cache->lock);
-		_cache->cache.clear();
-	}
+	if(_cache)
+		_cache->clear();
 	emit dataResetted();
 }
 
-
-
-EmitterAdapter::CacheInfo::CacheInfo(int maxSize) :
-	cache{maxSize}
-{}
+void EmitterAdapter::emitChanges(const QByteArray &typeName, const QStringList &ids, bool deleted)
+{
+	for(const auto &id : ids)
+		emit dataChanged({typeName, id}, deleted);
+	emit dataChangedBatch(typeName, ids, deleted);
+}
@@ -2,12 +2,12 @@
 #define QTDATASYNC_EMITTERADAPTER_P_H
 
 #include <QtCore/QObject>
-#include <QtCore/QReadWriteLock>
-#include <QtCore/QCache>
+#include <QtCore/QSharedPointer>
 
 #include "qtdatasync_global.h"
 #include "objectkey.h"
 #include "defaults.h"
+#include "storecache_p.h"
 
 namespace QtDataSync {
 
@@ -16,47 +16,50 @@ class Q_DATASYNC_EXPORT EmitterAdapter : public QObject
 	Q_OBJECT
 
 public:
-	struct Q_DATASYNC_EXPORT CacheInfo {
-		QReadWriteLock lock;
-		QCache<ObjectKey, QJsonObject> cache;
-
-		CacheInfo(int maxSize);
-	};
-
 	explicit EmitterAdapter(QObject *changeEmitter,
-							QSharedPointer<CacheInfo> cacheInfo,
+							QSharedPointer<StoreCache> cache,
 							QObject *origin = nullptr);
 
 	void triggerChange(const QtDataSync::ObjectKey &key, bool deleted, bool changed);
+	void triggerChanges(const QByteArray &typeName, const QStringList &ids, bool deleted, bool changed);
 	void triggerClear(const QByteArray &typeName, const QStringList &ids);
 	void triggerReset();
 	void triggerUpload();
+	void detachChanges();
 
-	void putCached(const ObjectKey &key, const QJsonObject &data, int costs);
-	void putCached(const QList<ObjectKey> &keys, const QList<QJsonObject> &data, const QList<int> &costs);
-	bool getCached(const ObjectKey &key, QJsonObject &data);
+	void putCached(const ObjectKey &key, const QJsonObject &data);
+	void putCached(const QList<ObjectKey> &keys, const QList<QJsonObject> &data, bool scan);
+	bool getCached(const ObjectKey &key, QJsonObject &data, StoreCache::MissingState *missing = nullptr);
 	bool dropCached(const ObjectKey &key);
 	void dropCached(const QByteArray &typeName, const QStringList &ids);
 	void dropCached();
+	quint64 cacheGeneration(const ObjectKey &key) const;
+	void putMissing(const ObjectKey &key, StoreCache::MissingState state, quint64 generation);
+	bool getCachedValue(const ObjectKey &key, int metaTypeId, QVariant &value);
+	void putCachedValue(const ObjectKey &key, const QJsonObject &source, int metaTypeId, const QVariant &value);
+	StoreCache::Statistics cacheStatistics(const QByteArray &typeName) const;
 
 Q_SIGNALS:
 	void dataChanged(const QtDataSync::ObjectKey &key, bool deleted);
+	void dataChangedBatch(const QByteArray &typeName, const QStringList &ids, bool deleted);
 	void dataResetted();
 
 private Q_SLOTS:
-	void dataChangedImpl(QObject *origin, const QtDataSync::ObjectKey &key, bool deleted);
+	void dataChangedImpl(QObject *origin, const QByteArray &typeName, const QStringList &ids, bool deleted);
 	void dataResettedImpl(QObject *origin);
-	void remoteDataChangedImpl(const QtDataSync::ObjectKey &key, bool deleted);
+	void remoteDataChangedImpl(const QByteArray &typeName, const QStringList &ids, bool deleted);
 	void remoteDataResettedImpl();
 
 private:
 	bool _isPrimary;
 	QObject *_emitterBackend;
-	QSharedPointer<CacheInfo> _cache;
+	QSharedPointer<StoreCache> _cache;
+
+	void emitChanges(const QByteArray &typeName, const QStringList &ids, bool deleted);
 };
 
 }
 
-Q_DECLARE_METATYPE(QSharedPointer<QtDataSync::EmitterAdapter::CacheInfo>)
+Q_DECLARE_METATYPE(QSharedPointer<QtDataSync::StoreCache>)
 
 #endif // QTDATASYNC_EMITTERADAPTER_P_H
@@ -95,6 +95,21 @@ void ExchangeEngine::initialize()
 	logDebug() << "Beginning engine initialization";
 	try {
 		_localStore = new LocalStore(_defaults, this);
+		try {
+			_localStore->migrateStorage();
+		} catch(QException &e) {
+			logCritical() << "Failed to migrate stored data to the configured storage mode. Error:" << e.what();
+		}
+		try {
+			_localStore->upgradePayloads();
+		} catch(QException &e) {
+			logCritical() << "Failed to upgrade stored data to the current format. Error:" << e.what();
+		}
+		try {
+			_localStore->rebuildIndexes();
+		} catch(QException &e) {
+			logCritical() << "Failed to rebuild the property indexes. Error:" << e.what();
+		}
 
 		//change controller
 		connectController(_changeController);
@@ -116,6 +131,8 @@ void ExchangeEngine::initialize()
 				this, &ExchangeEngine::remoteEvent);
 		connect(_remoteConnector, &RemoteConnector::updateUploadLimit,
 				_changeController, &ChangeController::updateUploadLimit);
+		connect(_remoteConnector, &RemoteConnector::updatePayloadFormat,
+				_changeController, &ChangeController::updatePayloadFormat);
 		connect(_remoteConnector, &RemoteConnector::uploadDone,
 				_changeController, &ChangeController::uploadDone);
 		connect(_remoteConnector, &RemoteConnector::deviceUploadDone,
@@ -6,13 +6,16 @@
 
 #include <QtCore/QUrl>
 #include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
 #include <QtCore/QTemporaryFile>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QSaveFile>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QMetaClassInfo>
 
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlError>
+#include <QtSql/QSqlRecord>
 
 using namespace QtDataSync;
 using std::function;
@@ -22,6 +25,13 @@ using std::make_tuple;
 #define QTDATASYNC_LOG _logger
 #define SCOPE_ASSERT() Q_ASSERT_X(scope.d->database.isValid(), Q_FUNC_INFO, "Cannot use SyncScope after committing it")
 
+//File value of datasets that are stored inline in the Data column (never a valid file name)
+const QString LocalStore::InlineFile = QStringLiteral(":inline");
+const char * const LocalStore::IndexClassInfo = "QtDataSync.IndexedProperties";
+const char * const LocalStore::FullTextClassInfo = "QtDataSync.FullTextProperties";
+//Prefix of compressed payloads (cbor data always starts with "qdsc", legacy binary json data with "qbjs")
+const QByteArray LocalStore::CompressedMagic = QByteArrayLiteral("qdsz");
+
 LocalStore::LocalStore(Defaults defaults, QObject *parent) :
 	QObject{parent},
 	_defaults{std::move(defaults)},
@@ -31,6 +41,8 @@ LocalStore::LocalStore(Defaults defaults, QObject *parent) :
 {
 	connect(_emitter, &EmitterAdapter::dataChanged,
 			this, &LocalStore::dataChanged);
+	connect(_emitter, &EmitterAdapter::dataChangedBatch,
+			this, &LocalStore::dataChangedBatch);
 	connect(_emitter, &EmitterAdapter::dataResetted,
 			this, &LocalStore::dataResetted);
 
@@ -43,6 +55,7 @@ LocalStore::LocalStore(Defaults defaults, QObject *parent) :
 										   "	File		TEXT,"
 										   "	Checksum	BLOB,"
 										   "	Changed		INTEGER NOT NULL DEFAULT 1,"
+										   "	Data		BLOB,"
 										   "	PRIMARY KEY(Type, Id)"
 										   ") WITHOUT ROWID;"));
 		if(!createQuery.exec()) {
@@ -54,15 +67,158 @@ LocalStore::LocalStore(Defaults defaults, QObject *parent) :
 			};
 		}
 		logDebug() << "Created DataIndex table";
+	} else if(!_database->record(QStringLiteral("DataIndex")).contains(QStringLiteral("Data"))) {
+		QSqlQuery alterQuery{_database};
+		alterQuery.prepare(QStringLiteral("ALTER TABLE DataIndex ADD COLUMN Data BLOB"));
+		if(!alterQuery.exec() &&
+		   !_database->record(QStringLiteral("DataIndex")).contains(QStringLiteral("Data"))) { //may have been added by another connection
+			throw LocalStoreException {
+				_defaults,
+				QByteArray{QTDATASYNC_EXCEPTION_NAME(LocalStore)},
+				alterQuery.executedQuery().simplified(),
+				alterQuery.lastError().text()
+			};
+		}
+		_database.clearQueryCache(); //statements of this connection were prepared for the old schema
+		logDebug() << "Added Data column to DataIndex table";
+	}
+
+	if(!_database->tables().contains(QStringLiteral("DeviceWatermarks")) ||
+	   !_database->record(QStringLiteral("DeviceWatermarks")).contains(QStringLiteral("Remaining"))) {
+		beginWriteTransaction(ObjectKey{"any"}, true);
+		try {
+			if(!_database->tables().contains(QStringLiteral("DeviceWatermarks"))) { //may have been created by another connection
+				//the watermark is the last key a device has received, the acks are datasets beyond it the device does not need anymore
+				const QStringList statements {
+					QStringLiteral("CREATE TABLE DeviceWatermarks ( "
+								   "	Device		TEXT NOT NULL, "
+								   "	Type		TEXT NOT NULL, "
+								   "	Id			TEXT NOT NULL, "
+								   "	Remaining	INTEGER NOT NULL DEFAULT 0, "
+								   "	PRIMARY KEY(Device) "
+								   ") WITHOUT ROWID;"),
+					QStringLiteral("CREATE TABLE IF NOT EXISTS DeviceUploadAcks ( "
+								   "	Type	TEXT NOT NULL, "
+								   "	Id		TEXT NOT NULL, "
+								   "	Device	TEXT NOT NULL, "
+								   "	PRIMARY KEY(Type, Id, Device), "
+								   "	FOREIGN KEY(Type, Id) REFERENCES DataIndex ON DELETE CASCADE "
+								   ") WITHOUT ROWID;")
+				};
+				for(const auto &statement : statements) {
+					QSqlQuery createQuery{_database};
+					createQuery.prepare(statement);
+					exec(createQuery);
+				}
+
+				//devices with pending uploads from the per dataset table start over
+				if(_database->tables().contains(QStringLiteral("DeviceUploads"))) {
+					QSqlQuery migrateQuery{_database};
+					migrateQuery.prepare(QStringLiteral("INSERT INTO DeviceWatermarks (Device, Type, Id) "
+														"SELECT DISTINCT Device, '', '' FROM DeviceUploads"));
+					exec(migrateQuery);
+					QSqlQuery dropQuery{_database};
+					dropQuery.prepare(QStringLiteral("DROP TABLE DeviceUploads"));
+					exec(dropQuery);
+					logDebug() << "Migrated DeviceUploads table to watermarks";
+				}
+				logDebug() << "Created DeviceWatermarks table";
+			} else if(!_database->record(QStringLiteral("DeviceWatermarks")).contains(QStringLiteral("Remaining"))) {
+				QSqlQuery alterQuery{_database};
+				alterQuery.prepare(QStringLiteral("ALTER TABLE DeviceWatermarks ADD COLUMN Remaining INTEGER NOT NULL DEFAULT 0"));
+				exec(alterQuery);
+				_database.clearQueryCache();
+				logDebug() << "Added Remaining column to DeviceWatermarks table";
+			}
+
+			//the triggers keep the remaining count of every device exact, so counting never scans the DataIndex
+			//changed datasets are uploaded to all devices anyways, thus they are acked for pending devices
+			const QStringList statements {
+				QStringLiteral("CREATE TRIGGER IF NOT EXISTS devicewatermarks_INSERT_changed "
+							   "AFTER INSERT ON DataIndex "
+							   "WHEN NEW.Changed = 1 "
+							   "BEGIN "
+							   "	INSERT OR IGNORE INTO DeviceUploadAcks (Type, Id, Device) "
+							   "	SELECT NEW.Type, NEW.Id, Device FROM DeviceWatermarks "
+							   "	WHERE (NEW.Type, NEW.Id) > (Type, Id); "
+							   "END;"),
+				QStringLiteral("CREATE TRIGGER IF NOT EXISTS devicewatermarks_INSERT_unchanged "
+							   "AFTER INSERT ON DataIndex "
+							   "WHEN NEW.Changed != 1 "
+							   "BEGIN "
+							   "	UPDATE DeviceWatermarks SET Remaining = Remaining + 1 "
+							   "	WHERE (NEW.Type, NEW.Id) > (Type, Id); "
+							   "END;"),
+				QStringLiteral("CREATE TRIGGER IF NOT EXISTS devicewatermarks_UPDATE_changed "
+							   "AFTER UPDATE OF Changed ON DataIndex "
+							   "WHEN NEW.Changed = 1 AND OLD.Changed != 1 "
+							   "BEGIN "
+							   "	UPDATE DeviceWatermarks SET Remaining = Remaining - 1 "
+							   "	WHERE (NEW.Type, NEW.Id) > (Type, Id) "
+							   "	AND NOT EXISTS (SELECT 1 FROM DeviceUploadAcks "
+							   "		WHERE DeviceUploadAcks.Type = NEW.Type "
+							   "		AND DeviceUploadAcks.Id = NEW.Id "
+							   "		AND DeviceUploadAcks.Device = DeviceWatermarks.Device); "
+							   "	INSERT OR IGNORE INTO DeviceUploadAcks (Type, Id, Device) "
+							   "	SELECT NEW.Type, NEW.Id, Device FROM DeviceWatermarks "
+							   "	WHERE (NEW.Type, NEW.Id) > (Type, Id); "
+							   "END;"),
+				QStringLiteral("CREATE TRIGGER IF NOT EXISTS devicewatermarks_DELETE "
+							   "BEFORE DELETE ON DataIndex "
+							   "BEGIN "
+							   "	UPDATE DeviceWatermarks SET Remaining = Remaining - 1 "
+							   "	WHERE (OLD.Type, OLD.Id) > (Type, Id) "
+							   "	AND NOT EXISTS (SELECT 1 FROM DeviceUploadAcks "
+							   "		WHERE DeviceUploadAcks.Type = OLD.Type "
+							   "		AND DeviceUploadAcks.Id = OLD.Id "
+							   "		AND DeviceUploadAcks.Device = DeviceWatermarks.Device); "
+							   "	DELETE FROM DeviceUploadAcks WHERE Type = OLD.Type AND Id = OLD.Id; "
+							   "END;"),
+				QStringLiteral("CREATE TRIGGER IF NOT EXISTS devicewatermarks_UPDATE_done "
+							   "AFTER UPDATE OF Remaining ON DeviceWatermarks "
+							   "WHEN NEW.Remaining <= 0 "
+							   "BEGIN "
+							   "	DELETE FROM DeviceUploadAcks WHERE Device = NEW.Device; "
+							   "	DELETE FROM DeviceWatermarks WHERE Device = NEW.Device; "
+							   "END;"),
+				//count the pending uploads of existing watermarks
+				QStringLiteral("INSERT OR IGNORE INTO DeviceUploadAcks (Type, Id, Device) "
+							   "SELECT DataIndex.Type, DataIndex.Id, DeviceWatermarks.Device "
+							   "FROM DataIndex "
+							   "INNER JOIN DeviceWatermarks "
+							   "ON (DataIndex.Type, DataIndex.Id) > (DeviceWatermarks.Type, DeviceWatermarks.Id) "
+							   "WHERE DataIndex.Changed = 1"),
+				QStringLiteral("UPDATE DeviceWatermarks SET Remaining = ( "
+							   "	SELECT Count(*) FROM DataIndex "
+							   "	WHERE (DataIndex.Type, DataIndex.Id) > (DeviceWatermarks.Type, DeviceWatermarks.Id) "
+							   "	AND NOT EXISTS (SELECT 1 FROM DeviceUploadAcks "
+							   "		WHERE DeviceUploadAcks.Type = DataIndex.Type "
+							   "		AND DeviceUploadAcks.Id = DataIndex.Id "
+							   "		AND DeviceUploadAcks.Device = DeviceWatermarks.Device) "
+							   ")")
+			};
+			for(const auto &statement : statements) {
+				QSqlQuery createQuery{_database};
+				createQuery.prepare(statement);
+				exec(createQuery);
+			}
+
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+		} catch(...) {
+			_database->rollback();
+			throw;
+		}
 	}
 
-	if(!_database->tables().contains(QStringLiteral("DeviceUploads"))) {
+	if(!_database->tables().contains(QStringLiteral("PropertyIndex"))) {
 		QSqlQuery createQuery{_database};
-		createQuery.prepare(QStringLiteral("CREATE TABLE IF NOT EXISTS DeviceUploads ( "
-										   "	Type	TEXT NOT NULL, "
-										   "	Id		TEXT NOT NULL, "
-										   "	Device	TEXT NOT NULL, "
-										   "	PRIMARY KEY(Type, Id, Device), "
+		createQuery.prepare(QStringLiteral("CREATE TABLE IF NOT EXISTS PropertyIndex ( "
+										   "	Type		TEXT NOT NULL, "
+										   "	Property	TEXT NOT NULL, "
+										   "	Value		NOT NULL, "
+										   "	Id			TEXT NOT NULL, "
+										   "	PRIMARY KEY(Type, Property, Value, Id), "
 										   "	FOREIGN KEY(Type, Id) REFERENCES DataIndex ON DELETE CASCADE "
 										   ") WITHOUT ROWID;"));
 		if(!createQuery.exec()) {
@@ -73,9 +229,179 @@ LocalStore::LocalStore(Defaults defaults, QObject *parent) :
 				createQuery.lastError().text()
 			};
 		}
-		logDebug() << "Created DeviceUploads table";
+		logDebug() << "Created PropertyIndex table";
+	}
+
+	if(!_database->tables().contains(QStringLiteral("PropertyIndexInfo"))) {
+		QSqlQuery createQuery{_database};
+		createQuery.prepare(QStringLiteral("CREATE TABLE IF NOT EXISTS PropertyIndexInfo ( "
+										   "	Type		TEXT NOT NULL, "
+										   "	Property	TEXT NOT NULL, "
+										   "	PRIMARY KEY(Type, Property) "
+										   ") WITHOUT ROWID;"));
+		if(!createQuery.exec()) {
+			throw LocalStoreException{
+				_defaults,
+				QByteArray{QTDATASYNC_EXCEPTION_NAME(LocalStore)},
+				createQuery.executedQuery().simplified(),
+				createQuery.lastError().text()
+			};
+		}
+		logDebug() << "Created PropertyIndexInfo table";
 	}
 
+	if(!_database->tables().contains(QStringLiteral("TypeCounts"))) {
+		//table, triggers and initial counts must be created atomically to not miss any change
+		beginWriteTransaction(ObjectKey{"any"}, true);
+		try {
+			if(!_database->tables().contains(QStringLiteral("TypeCounts"))) { //may have been created by another connection
+				const QStringList statements {
+					QStringLiteral("CREATE TABLE TypeCounts ( "
+								   "	Type	TEXT NOT NULL, "
+								   "	Count	INTEGER NOT NULL DEFAULT 0, "
+								   "	PRIMARY KEY(Type) "
+								   ") WITHOUT ROWID;"),
+					QStringLiteral("INSERT INTO TypeCounts (Type, Count) "
+								   "SELECT Type, Count(*) FROM DataIndex "
+								   "WHERE File IS NOT NULL "
+								   "GROUP BY Type"),
+					QStringLiteral("CREATE TRIGGER IF NOT EXISTS typecounts_INSERT "
+								   "AFTER INSERT ON DataIndex "
+								   "WHEN NEW.File IS NOT NULL "
+								   "BEGIN "
+								   "	INSERT OR IGNORE INTO TypeCounts (Type) VALUES(NEW.Type); "
+								   "	UPDATE TypeCounts SET Count = Count + 1 WHERE Type = NEW.Type; "
+								   "END;"),
+					QStringLiteral("CREATE TRIGGER IF NOT EXISTS typecounts_UPDATE "
+								   "AFTER UPDATE OF File ON DataIndex "
+								   "WHEN (OLD.File IS NULL) != (NEW.File IS NULL) "
+								   "BEGIN "
+								   "	INSERT OR IGNORE INTO TypeCounts (Type) VALUES(NEW.Type); "
+								   "	UPDATE TypeCounts SET Count = Count + (CASE WHEN NEW.File IS NULL THEN -1 ELSE 1 END) WHERE Type = NEW.Type; "
+								   "END;"),
+					QStringLiteral("CREATE TRIGGER IF NOT EXISTS typecounts_DELETE "
+								   "AFTER DELETE ON DataIndex "
+								   "WHEN OLD.File IS NOT NULL "
+								   "BEGIN "
+								   "	UPDATE TypeCounts SET Count = Count - 1 WHERE Type = OLD.Type; "
+								   "END;")
+				};
+				for(const auto &statement : statements) {
+					QSqlQuery createQuery{_database};
+					createQuery.prepare(statement);
+					exec(createQuery);
+				}
+				logDebug() << "Created TypeCounts table";
+			}
+
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+		} catch(...) {
+			_database->rollback();
+			throw;
+		}
+	}
+
+	if(!_database->tables().contains(QStringLiteral("ChangeJournal"))) {
+		//table, triggers and initial entries must be created atomically to not miss any change
+		beginWriteTransaction(ObjectKey{"any"}, true);
+		try {
+			if(!_database->tables().contains(QStringLiteral("ChangeJournal"))) { //may have been created by another connection
+				const QStringList statements {
+					QStringLiteral("CREATE TABLE ChangeJournal ( "
+								   "	Seq		INTEGER PRIMARY KEY AUTOINCREMENT, "
+								   "	Type	TEXT NOT NULL, "
+								   "	Id		TEXT NOT NULL, "
+								   "	UNIQUE(Type, Id), "
+								   "	FOREIGN KEY(Type, Id) REFERENCES DataIndex ON DELETE CASCADE "
+								   ");"),
+					QStringLiteral("INSERT INTO ChangeJournal (Type, Id) "
+								   "SELECT Type, Id FROM DataIndex "
+								   "WHERE Changed = 1"),
+					QStringLiteral("CREATE TRIGGER IF NOT EXISTS changejournal_INSERT "
+								   "AFTER INSERT ON DataIndex "
+								   "WHEN NEW.Changed = 1 "
+								   "BEGIN "
+								   "	INSERT OR IGNORE INTO ChangeJournal (Type, Id) VALUES(NEW.Type, NEW.Id); "
+								   "END;"),
+					QStringLiteral("CREATE TRIGGER IF NOT EXISTS changejournal_UPDATE_changed "
+								   "AFTER UPDATE OF Changed ON DataIndex "
+								   "WHEN NEW.Changed = 1 "
+								   "BEGIN "
+								   "	INSERT OR IGNORE INTO ChangeJournal (Type, Id) VALUES(NEW.Type, NEW.Id); "
+								   "END;"),
+					QStringLiteral("CREATE TRIGGER IF NOT EXISTS changejournal_UPDATE_unchanged "
+								   "AFTER UPDATE OF Changed ON DataIndex "
+								   "WHEN NEW.Changed != 1 AND OLD.Changed = 1 "
+								   "BEGIN "
+								   "	DELETE FROM ChangeJournal WHERE Type = NEW.Type AND Id = NEW.Id; "
+								   "END;")
+				};
+				for(const auto &statement : statements) {
+					QSqlQuery createQuery{_database};
+					createQuery.prepare(statement);
+					exec(createQuery);
+				}
+				logDebug() << "Created ChangeJournal table";
+			}
+
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+		} catch(...) {
+			_database->rollback();
+			throw;
+		}
+	}
+
+	if(!_database->tables().contains(QStringLiteral("FullTextKeys"))) {
+		beginWriteTransaction(ObjectKey{"any"}, true);
+		try {
+			if(!_database->tables().contains(QStringLiteral("FullTextKeys"))) { //may have been created by another connection
+				QSqlQuery ftsQuery{_database};
+				ftsQuery.prepare(QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS FullTextIndex USING fts5(Content);"));
+				if(ftsQuery.exec()) {
+					//the keys map datasets to the rowids of the index and remove the index entry together with them
+					const QStringList statements {
+						QStringLiteral("CREATE TABLE FullTextKeys ( "
+									   "	RowId	INTEGER PRIMARY KEY, "
+									   "	Type	TEXT NOT NULL, "
+									   "	Id		TEXT NOT NULL, "
+									   "	UNIQUE(Type, Id), "
+									   "	FOREIGN KEY(Type, Id) REFERENCES DataIndex ON DELETE CASCADE "
+									   ");"),
+						QStringLiteral("CREATE TRIGGER IF NOT EXISTS fulltext_DELETE "
+									   "AFTER DELETE ON FullTextKeys "
+									   "BEGIN "
+									   "	DELETE FROM FullTextIndex WHERE rowid = OLD.RowId; "
+									   "END;"),
+						QStringLiteral("CREATE TABLE IF NOT EXISTS FullTextIndexInfo ( "
+									   "	Type		TEXT NOT NULL, "
+									   "	Property	TEXT NOT NULL, "
+									   "	PRIMARY KEY(Type, Property) "
+									   ") WITHOUT ROWID;")
+					};
+					for(const auto &statement : statements) {
+						QSqlQuery createQuery{_database};
+						createQuery.prepare(statement);
+						exec(createQuery);
+					}
+					logDebug() << "Created FullTextIndex tables";
+				} else {
+					//sqlite without fts5 support - everything but full text searches still works
+					logWarning() << "Full text search is not available. Failed to create FullTextIndex table with error:"
+								 << ftsQuery.lastError().text();
+				}
+			}
+
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+		} catch(...) {
+			_database->rollback();
+			throw;
+		}
+	}
+	_fullTextAvailable = _database->tables().contains(QStringLiteral("FullTextKeys"));
+
 	try {
 		EventCursorPrivate::initDatabase(_defaults, _database, _logger, true);
 	} catch(EventCursorException &e) {
@@ -90,31 +416,357 @@ LocalStore::LocalStore(Defaults defaults, QObject *parent) :
 
 LocalStore::~LocalStore() = default;
 
-QJsonObject LocalStore::readJson(const ObjectKey &key, const QString &fileName, int *costs) const
+QJsonObject LocalStore::readJson(const ObjectKey &key, const QString &fileName, bool *legacy) const
 {
+	if(fileName == InlineFile) {
+		CachedQuery loadQuery{_database, QStringLiteral("SELECT Data FROM DataIndex WHERE Type = ? AND Id = ?")};
+		loadQuery->addBindValue(key.typeName);
+		loadQuery->addBindValue(key.id);
+		exec(*loadQuery, key);
+
+		if(!loadQuery->first())
+			throw NoDataException(_defaults, key);
+		return readStored(key, fileName, loadQuery->value(0), legacy);
+	}
+
 	QFile file(filePath(key, fileName));
 	if(!file.open(QIODevice::ReadOnly))
 		throw LocalStoreException(_defaults, key, file.fileName(), file.errorString());
 
-	auto doc = QJsonDocument::fromBinaryData(file.readAll());
-	if(costs)
-		*costs = static_cast<int>(file.size());
+	auto data = file.readAll();
 	file.close();
+	return deserializeData(key, data, file.fileName(), legacy);
+}
 
-	if(!doc.isObject())
-		throw LocalStoreException(_defaults, key, file.fileName(), QStringLiteral("File contains invalid json data"));
-	return doc.object();
+void LocalStore::migrateStorage()
+{
+	const auto toInline = isInlineMode();
+
+	//collect the keys only, as the data may be huge
+	QList<std::pair<ObjectKey, QString>> migrateKeys;
+	{
+		QSqlQuery migrateQuery(_database);
+		if(toInline)
+			migrateQuery.prepare(QStringLiteral("SELECT Type, Id, File FROM DataIndex WHERE File IS NOT NULL AND File != ?"));
+		else
+			migrateQuery.prepare(QStringLiteral("SELECT Type, Id, File FROM DataIndex WHERE File = ?"));
+		migrateQuery.addBindValue(InlineFile);
+		exec(migrateQuery);
+		while(migrateQuery.next()) {
+			migrateKeys.append({
+				{migrateQuery.value(0).toByteArray(), migrateQuery.value(1).toString()},
+				migrateQuery.value(2).toString()
+			});
+		}
+	}
+	if(migrateKeys.isEmpty())
+		return;
+
+	logInfo() << "Migrating" << migrateKeys.size() << "datasets to"
+			  << (toInline ? "inline" : "file") << "storage";
+
+	//migrate in chunks, to not block other connections for too long
+	const auto ChunkSize = 100;
+	for(auto offset = 0; offset < migrateKeys.size(); offset += ChunkSize) {
+		beginWriteTransaction();
+		QStringList obsoleteFiles;
+		QList<QTemporaryFile*> newFiles;
+		try {
+			for(auto i = offset; i < qMin(offset + ChunkSize, migrateKeys.size()); i++) {
+				const auto &key = migrateKeys[i].first;
+				const auto &fileName = migrateKeys[i].second;
+
+				QSqlQuery updateQuery(_database);
+				updateQuery.prepare(QStringLiteral("UPDATE DataIndex SET File = ?, Data = ? WHERE Type = ? AND Id = ? AND File = ?"));
+				if(toInline) {
+					QFile file(filePath(key, fileName));
+					if(!file.open(QIODevice::ReadOnly)) {
+						logWarning() << "Skipping migration of" << key
+									 << "- failed to read file with error:" << file.errorString();
+						continue;
+					}
+					updateQuery.addBindValue(InlineFile);
+					updateQuery.addBindValue(file.readAll());
+					obsoleteFiles.append(file.fileName());
+				} else {
+					QSqlQuery loadQuery(_database);
+					loadQuery.prepare(QStringLiteral("SELECT Data FROM DataIndex WHERE Type = ? AND Id = ?"));
+					loadQuery.addBindValue(key.typeName);
+					loadQuery.addBindValue(key.id);
+					exec(loadQuery, key);
+					if(!loadQuery.first())
+						continue;
+
+					auto tableDir = typeDirectory(key);
+					auto file = new QTemporaryFile(filePath(tableDir, QStringLiteral("%1XXXXXX")
+															.arg(QString::fromUtf8(QUuid::createUuid().toRfc4122().toHex()))));
+					newFiles.append(file);
+					if(!file->open() ||
+					   file->write(loadQuery.value(0).toByteArray()) == -1 ||
+					   !file->flush())
+						throw LocalStoreException(_defaults, key, file->fileName(), file->errorString());
+					updateQuery.addBindValue(tableDir.relativeFilePath(QFileInfo{file->fileName()}.completeBaseName()));
+					updateQuery.addBindValue(QVariant{QVariant::ByteArray});
+				}
+				updateQuery.addBindValue(key.typeName);
+				updateQuery.addBindValue(key.id);
+				updateQuery.addBindValue(fileName);
+				exec(updateQuery, key);
+			}
+
+			//complete the new files (last before commit!)
+			for(auto file : qAsConst(newFiles)) {
+				file->close();
+				file->setAutoRemove(false);
+			}
+
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+			qDeleteAll(newFiles);
+		} catch(...) {
+			_database->rollback();
+			for(auto file : qAsConst(newFiles))
+				file->remove();
+			qDeleteAll(newFiles);
+			throw;
+		}
+
+		//only remove old files once the database points to the migrated data
+		for(const auto &file : qAsConst(obsoleteFiles)) {
+			if(!QFile::remove(file))
+				logWarning() << "Failed to remove migrated file" << file;
+		}
+	}
+
+	logInfo() << "Storage migration completed";
+}
+
+void LocalStore::upgradePayloads()
+{
+	//legacy data can only exist in stores created before 4.3, so the check is only done once per database
+	{
+		QSqlQuery versionQuery(_database);
+		versionQuery.prepare(QStringLiteral("PRAGMA user_version"));
+		exec(versionQuery);
+		if(versionQuery.first() && versionQuery.value(0).toInt() >= 1)
+			return;
+	}
+
+	//collect the keys only, as the data may be huge
+	QList<ObjectKey> upgradeKeys;
+	{
+		QSqlQuery keysQuery(_database);
+		keysQuery.prepare(QStringLiteral("SELECT Type, Id FROM DataIndex WHERE File IS NOT NULL"));
+		exec(keysQuery);
+		while(keysQuery.next())
+			upgradeKeys.append({keysQuery.value(0).toByteArray(), keysQuery.value(1).toString()});
+	}
+
+	//rewrite in chunks, to not block other connections for too long
+	const auto ChunkSize = 100;
+	auto upgradeCount = 0;
+	for(auto offset = 0; offset < upgradeKeys.size(); offset += ChunkSize) {
+		beginWriteTransaction();
+		try {
+			for(auto i = offset; i < qMin(offset + ChunkSize, upgradeKeys.size()); i++) {
+				const auto &key = upgradeKeys[i];
+				QSqlQuery loadQuery(_database);
+				loadQuery.prepare(QStringLiteral("SELECT File, Data FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL"));
+				loadQuery.addBindValue(key.typeName);
+				loadQuery.addBindValue(key.id);
+				exec(loadQuery, key);
+				if(!loadQuery.first())
+					continue;
+
+				const auto fileName = loadQuery.value(0).toString();
+				auto legacy = false;
+				QJsonObject data;
+				try {
+					data = readStored(key, fileName, loadQuery.value(1), &legacy);
+				} catch(LocalStoreException &e) {
+					logWarning() << "Skipping upgrade of broken dataset" << key
+								 << "- failed to read it with error:" << e.what();
+					continue;
+				}
+				if(!legacy)
+					continue;
+
+				if(fileName == InlineFile) {
+					QSqlQuery updateQuery(_database);
+					updateQuery.prepare(QStringLiteral("UPDATE DataIndex SET Data = ? WHERE Type = ? AND Id = ?"));
+					updateQuery.addBindValue(serializeData(key, data));
+					updateQuery.addBindValue(key.typeName);
+					updateQuery.addBindValue(key.id);
+					exec(updateQuery, key);
+				} else {
+					QSaveFile file(filePath(key, fileName));
+					if(!file.open(QIODevice::WriteOnly) ||
+					   file.write(serializeData(key, data)) == -1 ||
+					   !file.commit())
+						throw LocalStoreException(_defaults, key, file.fileName(), file.errorString());
+				}
+				upgradeCount++;
+			}
+
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+		} catch(...) {
+			_database->rollback();
+			throw;
+		}
+	}
+
+	//stored in the database itself, so it is reset together with the data
+	QSqlQuery versionQuery(_database);
+	versionQuery.prepare(QStringLiteral("PRAGMA user_version = 1"));
+	exec(versionQuery);
+	if(upgradeCount > 0)
+		logInfo() << "Upgraded" << upgradeCount << "datasets to the current storage format";
+}
+
+void LocalStore::rebuildIndexes()
+{
+	beginWriteTransaction(ObjectKey{"any"}, true);
+
+	try {
+		//load the indexes that have been built so far
+		QHash<QByteArray, QStringList> builtIndexes;
+		QSqlQuery infoQuery(_database);
+		infoQuery.prepare(QStringLiteral("SELECT Type, Property FROM PropertyIndexInfo"));
+		exec(infoQuery);
+		while(infoQuery.next())
+			builtIndexes[infoQuery.value(0).toByteArray()].append(infoQuery.value(1).toString());
+
+		//find all types that have data or indexes
+		auto types = QSet<QByteArray>::fromList(builtIndexes.keys());
+		QSqlQuery typesQuery(_database);
+		typesQuery.prepare(QStringLiteral("SELECT DISTINCT Type FROM DataIndex"));
+		exec(typesQuery);
+		while(typesQuery.next())
+			types.insert(typesQuery.value(0).toByteArray());
+
+		for(const auto &typeName : qAsConst(types)) {
+			auto properties = indexedProperties(typeName);
+			auto built = builtIndexes.value(typeName);
+			std::sort(properties.begin(), properties.end());
+			std::sort(built.begin(), built.end());
+			if(properties == built)
+				continue;
+
+			logInfo() << "Rebuilding property index for type" << typeName
+					  << "with properties" << properties;
+
+			//drop the old index completely
+			QSqlQuery dropQuery(_database);
+			dropQuery.prepare(QStringLiteral("DELETE FROM PropertyIndex WHERE Type = ?"));
+			dropQuery.addBindValue(typeName);
+			exec(dropQuery, typeName);
+			QSqlQuery dropInfoQuery(_database);
+			dropInfoQuery.prepare(QStringLiteral("DELETE FROM PropertyIndexInfo WHERE Type = ?"));
+			dropInfoQuery.addBindValue(typeName);
+			exec(dropInfoQuery, typeName);
+
+			//and create the new one from all stored datasets
+			if(properties.isEmpty())
+				continue;
+			QSqlQuery loadQuery(_database);
+			loadQuery.prepare(QStringLiteral("SELECT Id, File, Data FROM DataIndex WHERE Type = ? AND File IS NOT NULL"));
+			loadQuery.addBindValue(typeName);
+			exec(loadQuery, typeName);
+			while(loadQuery.next()) {
+				ObjectKey key {typeName, loadQuery.value(0).toString()};
+				try {
+					updatePropertyIndexImpl(_database, key, readStored(key, loadQuery.value(1).toString(), loadQuery.value(2)));
+				} catch(LocalStoreException &e) {
+					logWarning() << "Skipping broken dataset" << key
+								 << "while building the property index. Error:" << e.what();
+				}
+			}
+
+			QSqlQuery addInfoQuery(_database);
+			addInfoQuery.prepare(QStringLiteral("INSERT INTO PropertyIndexInfo (Type, Property) VALUES(?, ?)"));
+			for(const auto &property : qAsConst(properties)) {
+				addInfoQuery.addBindValue(typeName);
+				addInfoQuery.addBindValue(property);
+				exec(addInfoQuery, typeName);
+			}
+		}
+
+		//same for the full text indexes
+		if(_fullTextAvailable) {
+			QHash<QByteArray, QStringList> builtFullText;
+			QSqlQuery fullTextInfoQuery(_database);
+			fullTextInfoQuery.prepare(QStringLiteral("SELECT Type, Property FROM FullTextIndexInfo"));
+			exec(fullTextInfoQuery);
+			while(fullTextInfoQuery.next())
+				builtFullText[fullTextInfoQuery.value(0).toByteArray()].append(fullTextInfoQuery.value(1).toString());
+			types.unite(QSet<QByteArray>::fromList(builtFullText.keys()));
+
+			for(const auto &typeName : qAsConst(types)) {
+				auto properties = fullTextProperties(typeName);
+				auto built = builtFullText.value(typeName);
+				std::sort(properties.begin(), properties.end());
+				std::sort(built.begin(), built.end());
+				if(properties == built)
+					continue;
+
+				logInfo() << "Rebuilding full text index for type" << typeName
+						  << "with properties" << properties;
+
+				//drop the old index completely (the trigger removes the index entries)
+				QSqlQuery dropQuery(_database);
+				dropQuery.prepare(QStringLiteral("DELETE FROM FullTextKeys WHERE Type = ?"));
+				dropQuery.addBindValue(typeName);
+				exec(dropQuery, typeName);
+				QSqlQuery dropInfoQuery(_database);
+				dropInfoQuery.prepare(QStringLiteral("DELETE FROM FullTextIndexInfo WHERE Type = ?"));
+				dropInfoQuery.addBindValue(typeName);
+				exec(dropInfoQuery, typeName);
+
+				//and create the new one from all stored datasets
+				if(properties.isEmpty())
+					continue;
+				QSqlQuery loadQuery(_database);
+				loadQuery.prepare(QStringLiteral("SELECT Id, File, Data FROM DataIndex WHERE Type = ? AND File IS NOT NULL"));
+				loadQuery.addBindValue(typeName);
+				exec(loadQuery, typeName);
+				while(loadQuery.next()) {
+					ObjectKey key {typeName, loadQuery.value(0).toString()};
+					try {
+						updateFullTextImpl(_database, key, readStored(key, loadQuery.value(1).toString(), loadQuery.value(2)));
+					} catch(LocalStoreException &e) {
+						logWarning() << "Skipping broken dataset" << key
+									 << "while building the full text index. Error:" << e.what();
+					}
+				}
+
+				QSqlQuery addInfoQuery(_database);
+				addInfoQuery.prepare(QStringLiteral("INSERT INTO FullTextIndexInfo (Type, Property) VALUES(?, ?)"));
+				for(const auto &property : qAsConst(properties)) {
+					addInfoQuery.addBindValue(typeName);
+					addInfoQuery.addBindValue(property);
+					exec(addInfoQuery, typeName);
+				}
+			}
+		}
+
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
 }
 
 quint64 LocalStore::count(const QByteArray &typeName) const
 {
-	QSqlQuery countQuery(_database);
-	countQuery.prepare(QStringLiteral("SELECT Count(*) FROM DataIndex WHERE Type = ? AND File IS NOT NULL"));
-	countQuery.addBindValue(typeName);
-	exec(countQuery, typeName);
+	//maintained by the typecounts_* triggers, so no scan of the DataIndex is needed
+	CachedQuery countQuery{_database, QStringLiteral("SELECT Count FROM TypeCounts WHERE Type = ?")};
+	countQuery->addBindValue(typeName);
+	exec(*countQuery, typeName);
 
-	if(countQuery.first())
-		return countQuery.value(0).toULongLong();
+	if(countQuery->first())
+		return countQuery->value(0).toULongLong();
 	else
 		return 0;
 }
@@ -139,23 +791,20 @@ QList<QJsonObject> LocalStore::loadAll(const QByteArray &typeName) const
 
 	try {
 		QSqlQuery loadQuery(_database);
-		loadQuery.prepare(QStringLiteral("SELECT Id, File FROM DataIndex WHERE Type = ? AND File IS NOT NULL"));
+		loadQuery.prepare(QStringLiteral("SELECT Id, File, Data FROM DataIndex WHERE Type = ? AND File IS NOT NULL"));
 		loadQuery.addBindValue(typeName);
 		exec(loadQuery, typeName);
 
 		QList<ObjectKey> keys;
 		QList<QJsonObject> array;
-		QList<int> sizes;
 		while(loadQuery.next()) {
-			int size;
 			ObjectKey key {typeName, loadQuery.value(0).toString()};
-			auto json = readJson(key, loadQuery.value(1).toString(), &size);
+			auto json = readStored(key, loadQuery.value(1).toString(), loadQuery.value(2));
 			keys.append(key);
 			array.append(json);
-			sizes.append(size);
 		}
 
-		_emitter->putCached(keys, array, sizes);
+		_emitter->putCached(keys, array, true);
 
 		//commit db
 		if(!_database->commit())
@@ -168,40 +817,166 @@ QList<QJsonObject> LocalStore::loadAll(const QByteArray &typeName) const
 	}
 }
 
+QList<LocalStore::ChunkEntry> LocalStore::loadChunk(const QByteArray &typeName, const QString &afterId, int size) const
+{
+	//read transaction used to prevent writes while reading json files
+	beginReadTransaction(typeName);
+
+	try {
+		QList<ChunkEntry> chunk;
+		chunk.reserve(size);
+		{
+			CachedQuery chunkQuery{_database, QStringLiteral("SELECT Id, File, Data FROM DataIndex "
+															 "WHERE Type = ? AND Id > ? AND File IS NOT NULL "
+															 "ORDER BY Id ASC "
+															 "LIMIT ?")};
+			chunkQuery->addBindValue(typeName);
+			chunkQuery->addBindValue(afterId);
+			chunkQuery->addBindValue(size);
+			exec(*chunkQuery, typeName);
+
+			while(chunkQuery->next()) {
+				ChunkEntry entry;
+				entry.id = chunkQuery->value(0).toString();
+				try {
+					entry.data = readStored({typeName, entry.id}, chunkQuery->value(1).toString(), chunkQuery->value(2));
+				} catch(QException &e) {
+					//broken datasets are reported when the cursor reaches them
+					entry.error.reset(e.clone());
+				}
+				chunk.append(entry);
+			}
+		}
+
+		//commit db
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
+
+		return chunk;
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
+}
+
 bool LocalStore::contains(const ObjectKey &key) const
 {
-	QSqlQuery existsQuery(_database);
-	existsQuery.prepare(QStringLiteral("SELECT 1 FROM DataIndex WHERE Type = ? AND Id = ?"));
-	existsQuery.addBindValue(key.typeName);
-	existsQuery.addBindValue(key.id);
-	exec(existsQuery, key);
-	return existsQuery.first();
+	//check if cached, including known missing datasets
+	QJsonObject json;
+	auto missing = StoreCache::NotMissing;
+	if(_emitter->getCached(key, json, &missing))
+		return true;
+	else if(missing != StoreCache::NotMissing)
+		return missing == StoreCache::Deleted;
+
+	const auto generation = _emitter->cacheGeneration(key);
+	CachedQuery existsQuery{_database, QStringLiteral("SELECT 1 FROM DataIndex WHERE Type = ? AND Id = ?")};
+	existsQuery->addBindValue(key.typeName);
+	existsQuery->addBindValue(key.id);
+	exec(*existsQuery, key);
+	if(existsQuery->first())
+		return true;
+	else {
+		_emitter->putMissing(key, StoreCache::NoEntry, generation);
+		return false;
+	}
 }
 
 QJsonObject LocalStore::load(const ObjectKey &key) const
 {
-	//check if cached
+	//check if cached, including known missing datasets
 	QJsonObject json;
-	if(_emitter->getCached(key, json))
+	auto missing = StoreCache::NotMissing;
+	if(_emitter->getCached(key, json, &missing))
 		return json;
+	else if(missing != StoreCache::NotMissing)
+		throw NoDataException(_defaults, key);
 
+	const auto generation = _emitter->cacheGeneration(key);
 	if(!_database->transaction())
 		throw LocalStoreException(_defaults, key, _database->databaseName(), _database->lastError().text());
 
 	try {
-		QSqlQuery loadQuery(_database);
-		loadQuery.prepare(QStringLiteral("SELECT File FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL"));
-		loadQuery.addBindValue(key.typeName);
-		loadQuery.addBindValue(key.id);
-		exec(loadQuery, key);
-
-		if(loadQuery.first()) {
-			int size;
-			json = readJson(key, loadQuery.value(0).toString(), &size);
-			_emitter->putCached(key, json, size);
-		} else
+		CachedQuery loadQuery{_database, QStringLiteral("SELECT File, Data FROM DataIndex WHERE Type = ? AND Id = ?")};
+		loadQuery->addBindValue(key.typeName);
+		loadQuery->addBindValue(key.id);
+		exec(*loadQuery, key);
+
+		const auto exists = loadQuery->first();
+		if(exists && !loadQuery->value(0).isNull()) {
+			json = readStored(key, loadQuery->value(0).toString(), loadQuery->value(1));
+			_emitter->putCached(key, json);
+		} else {
+			//remember the miss, so probing the key again does not need the database
+			_emitter->putMissing(key, exists ? StoreCache::Deleted : StoreCache::NoEntry, generation);
+			throw NoDataException(_defaults, key);
+		}
+		loadQuery->finish();
+
+		//commit db
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, key, _database->databaseName(), _database->lastError().text());
+		return json;
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
+}
+
+bool LocalStore::loadCachedValue(const ObjectKey &key, int metaTypeId, QVariant &value) const
+{
+	return _emitter->getCachedValue(key, metaTypeId, value);
+}
+
+void LocalStore::cacheValue(const ObjectKey &key, const QJsonObject &source, int metaTypeId, const QVariant &value) const
+{
+	_emitter->putCachedValue(key, source, metaTypeId, value);
+}
+
+DataStore::CacheStatistics LocalStore::cacheStatistics(const QByteArray &typeName) const
+{
+	const auto stats = _emitter->cacheStatistics(typeName);
+	return {
+		stats.hits,
+		stats.misses,
+		stats.evictions,
+		stats.cost,
+		stats.entries
+	};
+}
+
+QJsonObject LocalStore::loadProperties(const ObjectKey &key, const QStringList &properties) const
+{
+	//a cached dataset is already deserialized
+	QJsonObject json;
+	if(_emitter->getCached(key, json))
+		return projectData(json, properties);
+
+	if(!_database->transaction())
+		throw LocalStoreException(_defaults, key, _database->databaseName(), _database->lastError().text());
+
+	try {
+		CachedQuery loadQuery{_database, QStringLiteral("SELECT File, Data FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL")};
+		loadQuery->addBindValue(key.typeName);
+		loadQuery->addBindValue(key.id);
+		exec(*loadQuery, key);
+
+		if(!loadQuery->first())
 			throw NoDataException(_defaults, key);
 
+		//the partial result is not cached, as the cache only holds complete datasets
+		const auto fileName = loadQuery->value(0).toString();
+		if(fileName == InlineFile)
+			json = deserializeProperties(key, loadQuery->value(1).toByteArray(), _database->databaseName(), properties);
+		else {
+			QFile file(filePath(key, fileName));
+			if(!file.open(QIODevice::ReadOnly))
+				throw LocalStoreException(_defaults, key, file.fileName(), file.errorString());
+			json = deserializeProperties(key, file.readAll(), file.fileName(), properties);
+			file.close();
+		}
+		loadQuery->finish();
+
 		//commit db
 		if(!_database->commit())
 			throw LocalStoreException(_defaults, key, _database->databaseName(), _database->lastError().text());
@@ -219,23 +994,22 @@ void LocalStore::save(const ObjectKey &key, const QJsonObject &data)
 
 	try {
 		//check if the file exists
-		QSqlQuery existQuery(_database);
-		existQuery.prepare(QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ?"));
-		existQuery.addBindValue(key.typeName);
-		existQuery.addBindValue(key.id);
-		exec(existQuery, key);
+		CachedQuery existQuery{_database, QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ?")};
+		existQuery->addBindValue(key.typeName);
+		existQuery->addBindValue(key.id);
+		exec(*existQuery, key);
 
 		//create the file device to write to
 		quint64 version = 1ull;
-		bool existing = existQuery.first();
+		bool existing = existQuery->first();
 		if(existing)
-			version = existQuery.value(0).toULongLong() + 1ull;
+			version = existQuery->value(0).toULongLong() + 1ull;
 
 		//perform store operation
 		auto resFn = storeChangedImpl(_database,
 									  key,
 									  version,
-									  existing ? existQuery.value(1).toString() : QString(),
+									  existing ? existQuery->value(1).toString() : QString(),
 									  data,
 									  true,
 									  existing);
@@ -258,27 +1032,29 @@ bool LocalStore::remove(const ObjectKey &key)
 
 	try {
 		//load data of existing entry
-		QSqlQuery loadQuery(_database);
-		loadQuery.prepare(QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL"));
-		loadQuery.addBindValue(key.typeName);
-		loadQuery.addBindValue(key.id);
-		exec(loadQuery, key);
+		CachedQuery loadQuery{_database, QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL")};
+		loadQuery->addBindValue(key.typeName);
+		loadQuery->addBindValue(key.id);
+		exec(*loadQuery, key);
 
-		if(loadQuery.first()) { //stored -> remove it
-			auto version = loadQuery.value(0).toULongLong() + 1;
+		if(loadQuery->first()) { //stored -> remove it
+			auto version = loadQuery->value(0).toULongLong() + 1;
 
 			//"remove" from db
-			QSqlQuery removeQuery(_database);
-			removeQuery.prepare(QStringLiteral("UPDATE DataIndex SET Version = ?, File = NULL, Checksum = NULL, Changed = 1 WHERE Type = ? AND Id = ?"));
-			removeQuery.addBindValue(version);
-			removeQuery.addBindValue(key.typeName);
-			removeQuery.addBindValue(key.id);
-			exec(removeQuery, key);
-
-			//delete the file
-			QFile rmFile(filePath(key, loadQuery.value(1).toString()));
-			if(!rmFile.remove())
-				throw LocalStoreException(_defaults, key, rmFile.fileName(), rmFile.errorString());
+			CachedQuery removeQuery{_database, QStringLiteral("UPDATE DataIndex SET Version = ?, File = NULL, Checksum = NULL, Changed = 1, Data = NULL WHERE Type = ? AND Id = ?")};
+			removeQuery->addBindValue(version);
+			removeQuery->addBindValue(key.typeName);
+			removeQuery->addBindValue(key.id);
+			exec(*removeQuery, key);
+			updateIndexImpl(_database, key);
+
+			//delete the file, if not stored inline
+			auto fileName = loadQuery->value(1).toString();
+			if(fileName != InlineFile) {
+				QFile rmFile(filePath(key, fileName));
+				if(!rmFile.remove())
+					throw LocalStoreException(_defaults, key, rmFile.fileName(), rmFile.errorString());
+			}
 
 			//commit db
 			if(!_database->commit())
@@ -302,8 +1078,142 @@ bool LocalStore::remove(const ObjectKey &key)
 	}
 }
 
+void LocalStore::saveAll(const QByteArray &typeName, const QHash<QString, QJsonObject> &data)
+{
+	if(data.isEmpty())
+		return;
+
+	beginWriteTransaction(typeName);
+
+	QList<ObjectKey> keys;
+	keys.reserve(data.size());
+	try {
+		QList<QJsonObject> cacheData;
+		QStringList obsoleteFiles;
+		cacheData.reserve(data.size());
+
+		CachedQuery existQuery{_database, QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ?")};
+		for(auto it = data.constBegin(); it != data.constEnd(); ++it) {
+			ObjectKey key{typeName, it.key()};
+
+			//check if the file exists
+			existQuery->addBindValue(key.typeName);
+			existQuery->addBindValue(key.id);
+			exec(*existQuery, key);
+
+			quint64 version = 1ull;
+			bool existing = existQuery->first();
+			if(existing)
+				version = existQuery->value(0).toULongLong() + 1ull;
+			const auto fileName = existing ? existQuery->value(1).toString() : QString();
+			existQuery->finish();
+
+			//perform store operation
+			QString obsoleteFile;
+			keys.append(key);
+			writeDataImpl(_database,
+						  key,
+						  version,
+						  fileName,
+						  it.value(),
+						  true,
+						  existing,
+						  obsoleteFile);
+			cacheData.append(it.value());
+			if(!obsoleteFile.isNull())
+				obsoleteFiles.append(obsoleteFile);
+		}
+
+		//update cache in one pass
+		_emitter->putCached(keys, cacheData, false);
+
+		//commit database changes
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
+
+		//remove the files of datasets that were moved into the database
+		for(const auto &obsoleteFile : qAsConst(obsoleteFiles)) {
+			if(!QFile::remove(obsoleteFile))
+				logWarning() << "Failed to remove obsolete file" << obsoleteFile;
+		}
+		//trigger change signals
+		_emitter->triggerChanges(typeName, data.keys(), false, true);
+	} catch(...) {
+		for(const auto &key : qAsConst(keys))
+			_emitter->dropCached(key);
+		_database->rollback();
+		throw;
+	}
+}
+
+int LocalStore::removeAll(const QByteArray &typeName, const QStringList &ids)
+{
+	if(ids.isEmpty())
+		return 0;
+
+	beginWriteTransaction(typeName);
+
+	try {
+		QStringList removedIds;
+		QStringList removedFiles;
+
+		CachedQuery loadQuery{_database, QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL")};
+		CachedQuery removeQuery{_database, QStringLiteral("UPDATE DataIndex SET Version = ?, File = NULL, Checksum = NULL, Changed = 1, Data = NULL WHERE Type = ? AND Id = ?")};
+		for(const auto &id : ids) {
+			ObjectKey key{typeName, id};
+
+			//load data of existing entry
+			loadQuery->addBindValue(key.typeName);
+			loadQuery->addBindValue(key.id);
+			exec(*loadQuery, key);
+			if(!loadQuery->first()) //not stored -> skip
+				continue;
+			auto version = loadQuery->value(0).toULongLong() + 1;
+			auto fileName = loadQuery->value(1).toString();
+			loadQuery->finish();
+
+			//"remove" from db
+			removeQuery->addBindValue(version);
+			removeQuery->addBindValue(key.typeName);
+			removeQuery->addBindValue(key.id);
+			exec(*removeQuery, key);
+			updateIndexImpl(_database, key);
+
+			removedIds.append(id);
+			if(fileName != InlineFile)
+				removedFiles.append(filePath(key, fileName));
+		}
+
+		//delete the files, if not stored inline
+		for(const auto &rmFileName : qAsConst(removedFiles)) {
+			QFile rmFile(rmFileName);
+			if(!rmFile.remove())
+				throw LocalStoreException(_defaults, typeName, rmFile.fileName(), rmFile.errorString());
+		}
+
+		//commit db
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
+
+		if(!removedIds.isEmpty()) {
+			//update cache
+			_emitter->dropCached(typeName, removedIds);
+			//trigger change signals
+			_emitter->triggerChanges(typeName, removedIds, true, true);
+		}
+
+		return removedIds.size();
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
+}
+
 QList<QJsonObject> LocalStore::find(const QByteArray &typeName, const QString &query, DataStore::SearchMode mode) const
 {
+	if(mode == DataStore::FullTextMode)
+		return findFullText(typeName, query);
+
 	auto searchQuery = query;
 	if(mode != DataStore::RegexpMode) { //escape any of the like wildcard literals
 		if(mode != DataStore::WildcardMode)
@@ -339,7 +1249,7 @@ QList<QJsonObject> LocalStore::find(const QByteArray &typeName, const QString &q
 
 	try {
 		QSqlQuery findQuery(_database);
-		auto queryStr = QStringLiteral("SELECT Id, File FROM DataIndex WHERE Type = ? AND %1 AND File IS NOT NULL");
+		auto queryStr = QStringLiteral("SELECT Id, File, Data FROM DataIndex WHERE Type = ? AND %1 AND File IS NOT NULL");
 		if(mode == DataStore::RegexpMode)
 			queryStr = queryStr.arg(QStringLiteral("Id REGEXP ?"));
 		else
@@ -351,18 +1261,234 @@ QList<QJsonObject> LocalStore::find(const QByteArray &typeName, const QString &q
 
 		QList<ObjectKey> keys;
 		QList<QJsonObject> array;
-		QList<int> sizes;
 		while(findQuery.next()) {
-			int size;
 			ObjectKey key {typeName, findQuery.value(0).toString()};
-			auto json = readJson(key, findQuery.value(1).toString(), &size);
+			auto json = readStored(key, findQuery.value(1).toString(), findQuery.value(2));
+			keys.append(key);
+			array.append(json);
+		}
+
+		_emitter->putCached(keys, array, true);
+
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
+
+		return array;
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
+}
+
+QList<DataStore::SearchMatch> LocalStore::fullTextMatches(const QByteArray &typeName, const QString &query, int limit) const
+{
+	if(!_fullTextAvailable)
+		throw LocalStoreException(_defaults, typeName, query, QStringLiteral("Full text search is not supported by the database"));
+	if(fullTextProperties(typeName).isEmpty())
+		throw LocalStoreException(_defaults, typeName, query, QStringLiteral("Type has no full text properties"));
+
+	CachedQuery matchQuery{_database, QStringLiteral("SELECT FullTextKeys.Id, snippet(FullTextIndex, 0, '<b>', '</b>', '...', 16), FullTextIndex.rank "
+													 "FROM FullTextIndex "
+													 "INNER JOIN FullTextKeys ON FullTextKeys.RowId = FullTextIndex.rowid "
+													 "WHERE FullTextIndex MATCH ? AND FullTextKeys.Type = ? "
+													 "ORDER BY FullTextIndex.rank "
+													 "LIMIT ?")};
+	matchQuery->addBindValue(query);
+	matchQuery->addBindValue(typeName);
+	matchQuery->addBindValue(limit);
+	exec(*matchQuery, typeName);
+
+	QList<DataStore::SearchMatch> resList;
+	while(matchQuery->next()) {
+		resList.append({
+			matchQuery->value(0).toString(),
+			matchQuery->value(1).toString(),
+			matchQuery->value(2).toDouble()
+		});
+	}
+	return resList;
+}
+
+QStringList LocalStore::indexedKeys(const QByteArray &typeName, const QString &property, const QVariant &value) const
+{
+	if(!indexedProperties(typeName).contains(property))
+		throw LocalStoreException(_defaults, typeName, property, QStringLiteral("Property is not indexed"));
+
+	CachedQuery keysQuery{_database, QStringLiteral("SELECT Id FROM PropertyIndex WHERE Type = ? AND Property = ? AND Value = ?")};
+	keysQuery->addBindValue(typeName);
+	keysQuery->addBindValue(property);
+	keysQuery->addBindValue(indexValue(QJsonValue::fromVariant(value)));
+	exec(*keysQuery, typeName);
+
+	QStringList resList;
+	while(keysQuery->next())
+		resList.append(keysQuery->value(0).toString());
+	return resList;
+}
+
+QList<QJsonObject> LocalStore::loadIndexed(const QByteArray &typeName, const QString &property, const QVariant &value) const
+{
+	if(!indexedProperties(typeName).contains(property))
+		throw LocalStoreException(_defaults, typeName, property, QStringLiteral("Property is not indexed"));
+
+	//read transaction used to prevent writes while reading json files
+	beginReadTransaction(typeName);
+
+	try {
+		QSqlQuery loadQuery(_database);
+		loadQuery.prepare(QStringLiteral("SELECT DataIndex.Id, DataIndex.File, DataIndex.Data "
+										 "FROM PropertyIndex "
+										 "INNER JOIN DataIndex "
+										 "ON PropertyIndex.Type = DataIndex.Type AND PropertyIndex.Id = DataIndex.Id "
+										 "WHERE PropertyIndex.Type = ? AND PropertyIndex.Property = ? AND PropertyIndex.Value = ? "
+										 "AND DataIndex.File IS NOT NULL"));
+		loadQuery.addBindValue(typeName);
+		loadQuery.addBindValue(property);
+		loadQuery.addBindValue(indexValue(QJsonValue::fromVariant(value)));
+		exec(loadQuery, typeName);
+
+		QList<ObjectKey> keys;
+		QList<QJsonObject> array;
+		while(loadQuery.next()) {
+			ObjectKey key {typeName, loadQuery.value(0).toString()};
+			auto json = readStored(key, loadQuery.value(1).toString(), loadQuery.value(2));
 			keys.append(key);
 			array.append(json);
-			sizes.append(size);
 		}
 
-		_emitter->putCached(keys, array, sizes);
+		_emitter->putCached(keys, array, true);
 
+		//commit db
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
+
+		return array;
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
+}
+
+quint64 LocalStore::count(const QByteArray &typeName, const DataQuery &query) const
+{
+	QVariantList bindValues;
+	CachedQuery countQuery{_database, queryStatement(typeName, query, QStringLiteral("Count(*)"), false, bindValues)};
+	for(const auto &value : qAsConst(bindValues))
+		countQuery->addBindValue(value);
+	exec(*countQuery, typeName);
+
+	if(countQuery->first())
+		return countQuery->value(0).toULongLong();
+	else
+		return 0;
+}
+
+QStringList LocalStore::keys(const QByteArray &typeName, const DataQuery &query) const
+{
+	QVariantList bindValues;
+	QSqlQuery keysQuery(_database);
+	keysQuery.prepare(queryStatement(typeName, query, QStringLiteral("DataIndex.Id"), true, bindValues));
+	for(const auto &value : qAsConst(bindValues))
+		keysQuery.addBindValue(value);
+	exec(keysQuery, typeName);
+
+	QStringList resList;
+	while(keysQuery.next())
+		resList.append(keysQuery.value(0).toString());
+	return resList;
+}
+
+bool LocalStore::precedingKeys(const QByteArray &typeName, const DataQuery &query, const QString &key, int limit, QStringList &keys) const
+{
+	//read the sort values of the dataset, if it matches the query at all
+	const auto orders = query.sortOrders();
+	QStringList valueColumns {QStringLiteral("DataIndex.Id")};
+	for(auto i = 0; i < orders.size(); i++)
+		valueColumns.append(QStringLiteral("o%1.Value").arg(i));
+	auto valueQuery = query;
+	valueQuery.setLimit(1);
+	valueQuery.setOffset(0);
+	QVariantList bindValues;
+	QSqlQuery readQuery(_database);
+	readQuery.prepare(queryStatement(typeName, valueQuery, valueColumns.join(QStringLiteral(", ")), true, bindValues,
+									 QStringLiteral("DataIndex.Id = ?"), {key}));
+	for(const auto &value : qAsConst(bindValues))
+		readQuery.addBindValue(value);
+	exec(readQuery, typeName);
+	if(!readQuery.first())
+		return false;
+
+	//datasets before it in the order of keys(), built from the key backwards to the first sort order
+	//null values are sorted first in ascending and last in descending order
+	auto before = QStringLiteral("DataIndex.Id < ?");
+	QVariantList beforeValues {key};
+	for(auto i = orders.size() - 1; i >= 0; i--) {
+		const auto column = QStringLiteral("o%1.Value").arg(i);
+		const auto value = readQuery.value(i + 1);
+		QString less;
+		QVariantList lessValues;
+		if(orders[i].second == Qt::AscendingOrder) {
+			if(value.isNull())
+				less = QStringLiteral("0");
+			else {
+				less = QStringLiteral("(%1 IS NULL OR %1 < ?)").arg(column);
+				lessValues.append(value);
+			}
+		} else {
+			if(value.isNull())
+				less = QStringLiteral("%1 IS NOT NULL").arg(column);
+			else {
+				less = QStringLiteral("%1 > ?").arg(column);
+				lessValues.append(value);
+			}
+		}
+		before = QStringLiteral("(%1 OR (%2 IS ? AND %3))").arg(less, column, before);
+		beforeValues = lessValues + QVariantList{value} + beforeValues;
+	}
+
+	//the closest ones first
+	auto keysQuery = query;
+	keysQuery.setLimit(limit);
+	keysQuery.setOffset(0);
+	bindValues.clear();
+	QSqlQuery precedingQuery(_database);
+	precedingQuery.prepare(queryStatement(typeName, keysQuery, QStringLiteral("DataIndex.Id"), true, bindValues,
+										  before, beforeValues, true));
+	for(const auto &value : qAsConst(bindValues))
+		precedingQuery.addBindValue(value);
+	exec(precedingQuery, typeName);
+
+	keys.clear();
+	while(precedingQuery.next())
+		keys.append(precedingQuery.value(0).toString());
+	return true;
+}
+
+QList<QJsonObject> LocalStore::query(const QByteArray &typeName, const DataQuery &query) const
+{
+	//read transaction used to prevent writes while reading json files
+	beginReadTransaction(typeName);
+
+	try {
+		QVariantList bindValues;
+		QSqlQuery loadQuery(_database);
+		loadQuery.prepare(queryStatement(typeName, query, QStringLiteral("DataIndex.Id, DataIndex.File, DataIndex.Data"), true, bindValues));
+		for(const auto &value : qAsConst(bindValues))
+			loadQuery.addBindValue(value);
+		exec(loadQuery, typeName);
+
+		QList<ObjectKey> keys;
+		QList<QJsonObject> array;
+		while(loadQuery.next()) {
+			ObjectKey key {typeName, loadQuery.value(0).toString()};
+			auto json = readStored(key, loadQuery.value(1).toString(), loadQuery.value(2));
+			keys.append(key);
+			array.append(json);
+		}
+
+		_emitter->putCached(keys, array, true);
+
+		//commit db
 		if(!_database->commit())
 			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
 
@@ -388,10 +1514,21 @@ void LocalStore::clear(const QByteArray &typeName)
 		while(clearInfoQuery.next())
 			clearKeys.append(clearInfoQuery.value(0).toString());
 
-		// clear them
+		// clear them and their indexes
+		QSqlQuery clearIndexQuery(_database);
+		clearIndexQuery.prepare(QStringLiteral("DELETE FROM PropertyIndex WHERE Type = ?"));
+		clearIndexQuery.addBindValue(typeName);
+		exec(clearIndexQuery, typeName);
+		if(_fullTextAvailable) {
+			QSqlQuery clearFullTextQuery(_database);
+			clearFullTextQuery.prepare(QStringLiteral("DELETE FROM FullTextKeys WHERE Type = ?"));
+			clearFullTextQuery.addBindValue(typeName);
+			exec(clearFullTextQuery, typeName);
+		}
+
 		QSqlQuery clearQuery(_database);
 		clearQuery.prepare(QStringLiteral("UPDATE DataIndex "
-										  "SET Version = Version + 1, File = NULL, Checksum = NULL, Changed = 1 "
+										  "SET Version = Version + 1, File = NULL, Checksum = NULL, Changed = 1, Data = NULL "
 										  "WHERE Type = ? AND File IS NOT NULL"));
 		clearQuery.addBindValue(typeName);
 		exec(clearQuery, typeName);
@@ -415,20 +1552,28 @@ void LocalStore::clear(const QByteArray &typeName)
 	}
 }
 
+void LocalStore::detachChanges()
+{
+	_emitter->detachChanges();
+}
+
 void LocalStore::reset(bool keepData)
 {
 	beginWriteTransaction(ObjectKey{"any"}, true);
 
 	try {
+		//delete all not done device changes first, so the per dataset triggers have no devices to update
+		QSqlQuery clearDevicesQuery(_database);
+		clearDevicesQuery.prepare(QStringLiteral("DELETE FROM DeviceWatermarks"));
+		exec(clearDevicesQuery);
+		QSqlQuery clearAcksQuery(_database);
+		clearAcksQuery.prepare(QStringLiteral("DELETE FROM DeviceUploadAcks"));
+		exec(clearAcksQuery);
+
 		if(keepData) { //mark everything changed, to upload if needed
 			QSqlQuery resetQuery(_database);
 			resetQuery.prepare(QStringLiteral("UPDATE DataIndex SET Changed = 1"));
 			exec(resetQuery);
-
-			//also: delete all not done device changes
-			QSqlQuery clearDevicesQuery(_database);
-			clearDevicesQuery.prepare(QStringLiteral("DELETE FROM DeviceUploads"));
-			exec(clearDevicesQuery);
 		} else { //delete everything
 			QSqlQuery resetQuery(_database);
 			resetQuery.prepare(QStringLiteral("DELETE FROM DataIndex"));
@@ -479,21 +1624,13 @@ void LocalStore::reset(bool keepData)
 
 quint32 LocalStore::changeCount() const
 {
-	QSqlQuery countQuery(_database);
-	countQuery.prepare(QStringLiteral("SELECT Sum(rows) FROM ( "
-									  "		SELECT Count(*) AS rows FROM DataIndex "
-									  "		WHERE Changed = 1"
-									  "		UNION ALL"
-									  "		SELECT Count(*) AS rows FROM DataIndex "
-									  "		INNER JOIN DeviceUploads "
-									  "		ON DataIndex.Type = DeviceUploads.Type "
-									  "		AND DataIndex.Id = DeviceUploads.Id "
-									  "		WHERE NOT (DataIndex.Changed = 1 AND File IS NULL)"
-									  ")"));
-	exec(countQuery);
-
-	if(countQuery.first())
-		return countQuery.value(0).toUInt();
+	//the journal and the remaining counts of the devices contain all pending changes, so no scan of the DataIndex is needed
+	CachedQuery countQuery{_database, QStringLiteral("SELECT (SELECT Count(*) FROM ChangeJournal) + "
+													 "(SELECT IFNULL(Sum(Remaining), 0) FROM DeviceWatermarks)")};
+	exec(*countQuery);
+
+	if(countQuery->first())
+		return countQuery->value(0).toUInt();
 	else
 		return 0;
 }
@@ -503,8 +1640,14 @@ void LocalStore::loadChanges(int limit, const function<bool(ObjectKey, quint64,
 	beginReadTransaction();
 
 	try {
+		//changes are uploaded in the order they have been made
 		QSqlQuery readChangesQuery(_database);
-		readChangesQuery.prepare(QStringLiteral("SELECT Type, Id, Version, File FROM DataIndex WHERE Changed = 1 LIMIT ?"));
+		readChangesQuery.prepare(QStringLiteral("SELECT ChangeJournal.Type, ChangeJournal.Id, DataIndex.Version, DataIndex.File "
+												"FROM ChangeJournal "
+												"INNER JOIN DataIndex "
+												"ON (ChangeJournal.Type = DataIndex.Type AND ChangeJournal.Id = DataIndex.Id) "
+												"ORDER BY ChangeJournal.Seq ASC "
+												"LIMIT ?"));
 		readChangesQuery.addBindValue(limit);
 		exec(readChangesQuery);
 
@@ -522,23 +1665,41 @@ void LocalStore::loadChanges(int limit, const function<bool(ObjectKey, quint64,
 		}
 
 		if(!skip && cnt < limit) {
-			QSqlQuery readDeviceChangesQuery(_database);
-			readDeviceChangesQuery.prepare(QStringLiteral("SELECT DeviceUploads.Type, DeviceUploads.Id, DataIndex.Version, DataIndex.File, DeviceUploads.Device "
-														  "FROM DeviceUploads "
-														  "INNER JOIN DataIndex "
-														  "ON (DeviceUploads.Type = DataIndex.Type AND DeviceUploads.Id = DataIndex.Id) "
-														  "WHERE NOT (DataIndex.Changed = 1 AND File IS NULL) " //only those that haven't been operated on before
-														  "LIMIT ?"));
-			readDeviceChangesQuery.addBindValue(limit - cnt);
-			exec(readDeviceChangesQuery);
-
-			while(readDeviceChangesQuery.next()) {
-				if(!visitor({readDeviceChangesQuery.value(0).toByteArray(), readDeviceChangesQuery.value(1).toString()},
-							readDeviceChangesQuery.value(2).toULongLong(),
-							readDeviceChangesQuery.value(3).toString(),
-							readDeviceChangesQuery.value(4).toUuid())) {
-					skip = true;
-					break;
+			QSqlQuery readDevicesQuery(_database);
+			readDevicesQuery.prepare(QStringLiteral("SELECT Device, Type, Id FROM DeviceWatermarks"));
+			exec(readDevicesQuery);
+
+			//walk over the store in key order, starting at the watermark of each device
+			while(!skip && cnt < limit && readDevicesQuery.next()) {
+				const auto deviceId = readDevicesQuery.value(0).toUuid();
+				QSqlQuery readDeviceChangesQuery(_database);
+				readDeviceChangesQuery.prepare(QStringLiteral("SELECT Type, Id, Version, File "
+															  "FROM DataIndex "
+															  "WHERE (Type, Id) > (?, ?) "
+															  "AND Changed = 0 " //changed datasets are uploaded from the journal
+															  "AND NOT EXISTS ( "
+															  "		SELECT 1 FROM DeviceUploadAcks "
+															  "		WHERE DeviceUploadAcks.Type = DataIndex.Type "
+															  "		AND DeviceUploadAcks.Id = DataIndex.Id "
+															  "		AND DeviceUploadAcks.Device = ? "
+															  ") "
+															  "ORDER BY Type ASC, Id ASC "
+															  "LIMIT ?"));
+				readDeviceChangesQuery.addBindValue(readDevicesQuery.value(1));
+				readDeviceChangesQuery.addBindValue(readDevicesQuery.value(2));
+				readDeviceChangesQuery.addBindValue(deviceId);
+				readDeviceChangesQuery.addBindValue(limit - cnt);
+				exec(readDeviceChangesQuery);
+
+				while(readDeviceChangesQuery.next()) {
+					cnt++;
+					if(!visitor({readDeviceChangesQuery.value(0).toByteArray(), readDeviceChangesQuery.value(1).toString()},
+								readDeviceChangesQuery.value(2).toULongLong(),
+								readDeviceChangesQuery.value(3).toString(),
+								deviceId)) {
+						skip = true;
+						break;
+					}
 				}
 			}
 		}
@@ -558,12 +1719,84 @@ void LocalStore::markUnchanged(const ObjectKey &key, quint64 version, bool isDel
 
 void LocalStore::removeDeviceChange(const ObjectKey &key, QUuid deviceId)
 {
-	QSqlQuery rmDeviceQuery(_database);
-	rmDeviceQuery.prepare(QStringLiteral("DELETE FROM DeviceUploads WHERE Type = ? AND Id = ? AND Device = ?"));
-	rmDeviceQuery.addBindValue(key.typeName);
-	rmDeviceQuery.addBindValue(key.id);
-	rmDeviceQuery.addBindValue(deviceId);
-	exec(rmDeviceQuery);
+	beginWriteTransaction(key);
+
+	try {
+		//only uploads beyond the watermark of a device are pending
+		QByteArray markType;
+		QString markId;
+		{
+			CachedQuery markQuery{_database, QStringLiteral("SELECT Type, Id, (?, ?) > (Type, Id) FROM DeviceWatermarks WHERE Device = ?")};
+			markQuery->addBindValue(key.typeName);
+			markQuery->addBindValue(key.id);
+			markQuery->addBindValue(deviceId);
+			exec(*markQuery, key);
+			if(!markQuery->first() || !markQuery->value(2).toBool()) {
+				_database->rollback();
+				return;
+			}
+			markType = markQuery->value(0).toByteArray();
+			markId = markQuery->value(1).toString();
+		}
+
+		//datasets that were changed after the device was added have been acked already and are not counted
+		CachedQuery ackQuery{_database, QStringLiteral("INSERT OR IGNORE INTO DeviceUploadAcks (Type, Id, Device) VALUES(?, ?, ?)")};
+		ackQuery->addBindValue(key.typeName);
+		ackQuery->addBindValue(key.id);
+		ackQuery->addBindValue(deviceId);
+		exec(*ackQuery, key);
+		const auto acked = ackQuery->numRowsAffected() > 0 ? 1 : 0;
+
+		//move the watermark over all uploads that have been completed without a gap
+		auto finished = false;
+		forever {
+			CachedQuery nextQuery{_database, QStringLiteral("SELECT Type, Id FROM DataIndex "
+															"WHERE (Type, Id) > (?, ?) "
+															"ORDER BY Type ASC, Id ASC "
+															"LIMIT 1")};
+			nextQuery->addBindValue(markType);
+			nextQuery->addBindValue(markId);
+			exec(*nextQuery, key);
+			if(!nextQuery->first()) {
+				finished = true;
+				break;
+			}
+			const auto nextType = nextQuery->value(0).toByteArray();
+			const auto nextId = nextQuery->value(1).toString();
+
+			CachedQuery popQuery{_database, QStringLiteral("DELETE FROM DeviceUploadAcks WHERE Type = ? AND Id = ? AND Device = ?")};
+			popQuery->addBindValue(nextType);
+			popQuery->addBindValue(nextId);
+			popQuery->addBindValue(deviceId);
+			exec(*popQuery, key);
+			if(popQuery->numRowsAffected() == 0)
+				break;
+			markType = nextType;
+			markId = nextId;
+		}
+
+		if(finished) { //all datasets have been uploaded to the device
+			CachedQuery doneQuery{_database, QStringLiteral("DELETE FROM DeviceWatermarks WHERE Device = ?")};
+			doneQuery->addBindValue(deviceId);
+			exec(*doneQuery, key);
+			CachedQuery clearQuery{_database, QStringLiteral("DELETE FROM DeviceUploadAcks WHERE Device = ?")};
+			clearQuery->addBindValue(deviceId);
+			exec(*clearQuery, key);
+		} else { //reaching 0 remaining removes the watermark via trigger
+			CachedQuery updateQuery{_database, QStringLiteral("UPDATE DeviceWatermarks SET Type = ?, Id = ?, Remaining = Remaining - ? WHERE Device = ?")};
+			updateQuery->addBindValue(markType);
+			updateQuery->addBindValue(markId);
+			updateQuery->addBindValue(acked);
+			updateQuery->addBindValue(deviceId);
+			exec(*updateQuery, key);
+		}
+
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, key, _database->databaseName(), _database->lastError().text());
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
 }
 
 LocalStore::SyncScope LocalStore::startSync(const ObjectKey &key) const
@@ -575,16 +1808,15 @@ tuple<LocalStore::ChangeType, quint64, QString, QByteArray> LocalStore::loadChan
 {
 	SCOPE_ASSERT();
 
-	QSqlQuery loadChangeQuery(scope.d->database);
-	loadChangeQuery.prepare(QStringLiteral("SELECT Version, File, Checksum FROM DataIndex WHERE Type = ? AND Id = ?"));
-	loadChangeQuery.addBindValue(scope.d->key.typeName);
-	loadChangeQuery.addBindValue(scope.d->key.id);
-	exec(loadChangeQuery);
+	CachedQuery loadChangeQuery{scope.d->database, QStringLiteral("SELECT Version, File, Checksum FROM DataIndex WHERE Type = ? AND Id = ?")};
+	loadChangeQuery->addBindValue(scope.d->key.typeName);
+	loadChangeQuery->addBindValue(scope.d->key.id);
+	exec(*loadChangeQuery);
 
-	if(loadChangeQuery.first()) {
-		auto version = loadChangeQuery.value(0).toULongLong();
-		auto file = loadChangeQuery.value(1).toString();
-		auto checksum = loadChangeQuery.value(2).toByteArray();
+	if(loadChangeQuery->first()) {
+		auto version = loadChangeQuery->value(0).toULongLong();
+		auto file = loadChangeQuery->value(1).toString();
+		auto checksum = loadChangeQuery->value(2).toByteArray();
 		if(file.isNull())
 			return make_tuple(ExistsDeleted, version, QString(), QByteArray());
 		else
@@ -596,14 +1828,13 @@ tuple<LocalStore::ChangeType, quint64, QString, QByteArray> LocalStore::loadChan
 void LocalStore::updateVersion(SyncScope &scope, quint64 oldVersion, quint64 newVersion, bool changed)
 {
 	SCOPE_ASSERT();
-	QSqlQuery updateQuery(scope.d->database);
-	updateQuery.prepare(QStringLiteral("UPDATE DataIndex SET Version = ?, Changed = ? WHERE Type = ? AND Id = ? AND Version = ?"));
-	updateQuery.addBindValue(newVersion);
-	updateQuery.addBindValue(changed);
-	updateQuery.addBindValue(scope.d->key.typeName);
-	updateQuery.addBindValue(scope.d->key.id);
-	updateQuery.addBindValue(oldVersion);
-	exec(updateQuery, scope.d->key);
+	CachedQuery updateQuery{scope.d->database, QStringLiteral("UPDATE DataIndex SET Version = ?, Changed = ? WHERE Type = ? AND Id = ? AND Version = ?")};
+	updateQuery->addBindValue(newVersion);
+	updateQuery->addBindValue(changed);
+	updateQuery->addBindValue(scope.d->key.typeName);
+	updateQuery->addBindValue(scope.d->key.id);
+	updateQuery->addBindValue(oldVersion);
+	exec(*updateQuery, scope.d->key);
 
 	//notify change controller
 	if(changed) {
@@ -631,14 +1862,13 @@ void LocalStore::storeDeleted(SyncScope &scope, quint64 version, bool changed, C
 	switch (localState) {
 	case Exists:
 	{
-		QSqlQuery loadQuery(scope.d->database);
-		loadQuery.prepare(QStringLiteral("SELECT File FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL"));
-		loadQuery.addBindValue(scope.d->key.typeName);
-		loadQuery.addBindValue(scope.d->key.id);
-		exec(loadQuery, scope.d->key);
-
-		if(loadQuery.first())
-			fileName = filePath(scope.d->key, loadQuery.value(0).toString());
+		CachedQuery loadQuery{scope.d->database, QStringLiteral("SELECT File FROM DataIndex WHERE Type = ? AND Id = ? AND File IS NOT NULL")};
+		loadQuery->addBindValue(scope.d->key.typeName);
+		loadQuery->addBindValue(scope.d->key.id);
+		exec(*loadQuery, scope.d->key);
+
+		if(loadQuery->first() && loadQuery->value(0).toString() != InlineFile)
+			fileName = filePath(scope.d->key, loadQuery->value(0).toString());
 		Q_FALLTHROUGH();
 	}
 	case ExistsDeleted:
@@ -653,22 +1883,21 @@ void LocalStore::storeDeleted(SyncScope &scope, quint64 version, bool changed, C
 	}
 
 	if(existing) {
-		QSqlQuery updateQuery(scope.d->database);
-		updateQuery.prepare(QStringLiteral("UPDATE DataIndex SET Version = ?, File = NULL, Checksum = NULL, Changed = ? WHERE Type = ? AND Id = ?"));
-		updateQuery.addBindValue(version);
-		updateQuery.addBindValue(changed);
-		updateQuery.addBindValue(scope.d->key.typeName);
-		updateQuery.addBindValue(scope.d->key.id);
-		exec(updateQuery, scope.d->key);
+		CachedQuery updateQuery{scope.d->database, QStringLiteral("UPDATE DataIndex SET Version = ?, File = NULL, Checksum = NULL, Changed = ?, Data = NULL WHERE Type = ? AND Id = ?")};
+		updateQuery->addBindValue(version);
+		updateQuery->addBindValue(changed);
+		updateQuery->addBindValue(scope.d->key.typeName);
+		updateQuery->addBindValue(scope.d->key.id);
+		exec(*updateQuery, scope.d->key);
 	} else {
-		QSqlQuery insertQuery(scope.d->database);
-		insertQuery.prepare(QStringLiteral("INSERT INTO DataIndex (Type, Id, Version, File, Checksum, Changed) VALUES(?, ?, ?, NULL, NULL, ?)"));
-		insertQuery.addBindValue(scope.d->key.typeName);
-		insertQuery.addBindValue(scope.d->key.id);
-		insertQuery.addBindValue(version);
-		insertQuery.addBindValue(changed);
-		exec(insertQuery, scope.d->key);
+		CachedQuery insertQuery{scope.d->database, QStringLiteral("INSERT INTO DataIndex (Type, Id, Version, File, Checksum, Changed) VALUES(?, ?, ?, NULL, NULL, ?)")};
+		insertQuery->addBindValue(scope.d->key.typeName);
+		insertQuery->addBindValue(scope.d->key.id);
+		insertQuery->addBindValue(version);
+		insertQuery->addBindValue(changed);
+		exec(*insertQuery, scope.d->key);
 	}
+	updateIndexImpl(scope.d->database, scope.d->key);
 
 	//delete the file, if one exists
 	if(!fileName.isNull()) {
@@ -686,10 +1915,14 @@ void LocalStore::storeDeleted(SyncScope &scope, quint64 version, bool changed, C
 			//notify others
 			_emitter->triggerChange(key, true, changed);
 		};
-	} else if(changed){
-		scope.d->afterCommit = [this]() {
+	} else {
+		auto key = scope.d->key;
+		scope.d->afterCommit = [this, key, changed]() {
+			//drop a cached miss, as the dataset now exists as deleted
+			_emitter->dropCached(key);
 			//trigger a change upload
-			_emitter->triggerUpload();
+			if(changed)
+				_emitter->triggerUpload();
 		};
 	}
 }
@@ -716,13 +1949,45 @@ void LocalStore::commitSync(SyncScope &scope) const
 void LocalStore::prepareAccountAdded(QUuid deviceId)
 {
 	try {
-		QSqlQuery insertQuery(_database);
-		insertQuery.prepare(QStringLiteral("INSERT OR REPLACE INTO DeviceUploads (Type, Id, Device) "
-										   "SELECT Type, Id, ? FROM DataIndex"));
-		insertQuery.addBindValue(deviceId);
-		exec(insertQuery);
+		//no rows per dataset - the device walks over the whole store, starting before the first key
+		auto added = false;
+		beginWriteTransaction();
+		try {
+			QSqlQuery clearQuery(_database);
+			clearQuery.prepare(QStringLiteral("DELETE FROM DeviceUploadAcks WHERE Device = ?"));
+			clearQuery.addBindValue(deviceId);
+			exec(clearQuery);
+
+			QSqlQuery removeQuery(_database);
+			removeQuery.prepare(QStringLiteral("DELETE FROM DeviceWatermarks WHERE Device = ?"));
+			removeQuery.addBindValue(deviceId);
+			exec(removeQuery);
+
+			//changed datasets reach the device via the normal upload, so only the unchanged ones are remaining
+			QSqlQuery insertQuery(_database);
+			insertQuery.prepare(QStringLiteral("INSERT INTO DeviceWatermarks (Device, Type, Id, Remaining) "
+											   "SELECT ?, '', '', Count(*) FROM DataIndex WHERE Changed = 0 "
+											   "HAVING Count(*) > 0"));
+			insertQuery.addBindValue(deviceId);
+			exec(insertQuery);
+			added = insertQuery.numRowsAffected() != 0; //in case of -1 (unknown), simply assume changed
+
+			if(added) {
+				QSqlQuery ackQuery(_database);
+				ackQuery.prepare(QStringLiteral("INSERT INTO DeviceUploadAcks (Type, Id, Device) "
+												"SELECT Type, Id, ? FROM ChangeJournal"));
+				ackQuery.addBindValue(deviceId);
+				exec(ackQuery);
+			}
 
-		if(insertQuery.numRowsAffected() != 0) //in case of -1 (unknown), simply assue changed
+			if(!_database->commit())
+				throw LocalStoreException(_defaults, QByteArray("any"), _database->databaseName(), _database->lastError().text());
+		} catch(...) {
+			_database->rollback();
+			throw;
+		}
+
+		if(added)
 			_emitter->triggerUpload();
 	} catch(Exception &e) {
 		logCritical() << "Failed to prepare added account with error:" << e.what();
@@ -751,13 +2016,327 @@ QString LocalStore::filePath(const ObjectKey &key, const QString &baseName) cons
 	return filePath(typeDirectory(key), baseName);
 }
 
+bool LocalStore::isInlineMode() const
+{
+	return _defaults.property(Defaults::DataStorageMode).value<Setup::StorageMode>() == Setup::StorageMode::Inline;
+}
+
+QStringList LocalStore::indexedProperties(const QByteArray &typeName) const
+{
+	auto it = _indexedProperties.constFind(typeName);
+	if(it != _indexedProperties.constEnd())
+		return *it;
+
+	auto properties = typeProperties(typeName, Defaults::IndexedProperties, IndexClassInfo);
+	_indexedProperties.insert(typeName, properties);
+	return properties;
+}
+
+QStringList LocalStore::fullTextProperties(const QByteArray &typeName) const
+{
+	auto it = _fullTextProperties.constFind(typeName);
+	if(it != _fullTextProperties.constEnd())
+		return *it;
+
+	auto properties = typeProperties(typeName, Defaults::FullTextProperties, FullTextClassInfo);
+	_fullTextProperties.insert(typeName, properties);
+	return properties;
+}
+
+QStringList LocalStore::typeProperties(const QByteArray &typeName, Defaults::PropertyKey setupKey, const char *classInfo) const
+{
+	//properties from the setup
+	auto properties = _defaults.property(setupKey)
+					  .toHash()
+					  .value(QString::fromUtf8(typeName))
+					  .toStringList();
+	//properties from the class info of the type
+	auto metaObject = QMetaType::metaObjectForType(QMetaType::type(typeName));
+	if(metaObject) {
+		auto infoIndex = metaObject->indexOfClassInfo(classInfo);
+		if(infoIndex != -1) {
+			const auto infoList = QString::fromUtf8(metaObject->classInfo(infoIndex).value())
+								  .split(QLatin1Char(','), QString::SkipEmptyParts);
+			for(const auto &info : infoList)
+				properties.append(info.trimmed());
+		}
+	}
+	properties.removeDuplicates();
+	return properties;
+}
+
+QList<QJsonObject> LocalStore::findFullText(const QByteArray &typeName, const QString &query) const
+{
+	if(!_fullTextAvailable)
+		throw LocalStoreException(_defaults, typeName, query, QStringLiteral("Full text search is not supported by the database"));
+	if(fullTextProperties(typeName).isEmpty())
+		throw LocalStoreException(_defaults, typeName, query, QStringLiteral("Type has no full text properties"));
+
+	//read transaction used to prevent writes while reading json files
+	beginReadTransaction(typeName);
+
+	try {
+		//only the matches are read, ordered by their relevance
+		QSqlQuery findQuery(_database);
+		findQuery.prepare(QStringLiteral("SELECT DataIndex.Id, DataIndex.File, DataIndex.Data "
+										 "FROM FullTextIndex "
+										 "INNER JOIN FullTextKeys ON FullTextKeys.RowId = FullTextIndex.rowid "
+										 "INNER JOIN DataIndex ON DataIndex.Type = FullTextKeys.Type AND DataIndex.Id = FullTextKeys.Id "
+										 "WHERE FullTextIndex MATCH ? AND FullTextKeys.Type = ? AND DataIndex.File IS NOT NULL "
+										 "ORDER BY FullTextIndex.rank"));
+		findQuery.addBindValue(query);
+		findQuery.addBindValue(typeName);
+		exec(findQuery, typeName);
+
+		QList<ObjectKey> keys;
+		QList<QJsonObject> array;
+		while(findQuery.next()) {
+			ObjectKey key {typeName, findQuery.value(0).toString()};
+			auto json = readStored(key, findQuery.value(1).toString(), findQuery.value(2));
+			keys.append(key);
+			array.append(json);
+		}
+
+		_emitter->putCached(keys, array, true);
+
+		if(!_database->commit())
+			throw LocalStoreException(_defaults, typeName, _database->databaseName(), _database->lastError().text());
+
+		return array;
+	} catch(...) {
+		_database->rollback();
+		throw;
+	}
+}
+
+QVariant LocalStore::indexValue(const QJsonValue &value)
+{
+	switch(value.type()) {
+	case QJsonValue::Bool:
+		return value.toBool();
+	case QJsonValue::Double:
+		return value.toDouble();
+	case QJsonValue::String:
+		return value.toString();
+	case QJsonValue::Array:
+		return QString::fromUtf8(QJsonDocument{value.toArray()}.toJson(QJsonDocument::Compact));
+	case QJsonValue::Object:
+		return QString::fromUtf8(QJsonDocument{value.toObject()}.toJson(QJsonDocument::Compact));
+	default:
+		return {};
+	}
+}
+
+QString LocalStore::fullTextContent(const QJsonObject &data, const QStringList &properties)
+{
+	QStringList content;
+	for(const auto &property : properties) {
+		const auto value = data.value(property);
+		if(value.isArray()) { //lists of strings, like tags, are indexed word by word
+			for(const auto &element : value.toArray()) {
+				if(element.isString())
+					content.append(element.toString());
+			}
+		} else {
+			auto text = indexValue(value).toString();
+			if(!text.isEmpty())
+				content.append(text);
+		}
+	}
+	return content.join(QLatin1Char('\n'));
+}
+
+QJsonObject LocalStore::projectData(const QJsonObject &data, const QStringList &properties)
+{
+	QJsonObject result;
+	for(const auto &property : properties) {
+		auto it = data.constFind(property);
+		if(it != data.constEnd())
+			result.insert(property, *it);
+	}
+	return result;
+}
+
+QString LocalStore::queryStatement(const QByteArray &typeName, const DataQuery &query, const QString &columns, bool paged, QVariantList &bindValues, const QString &extraCondition, const QVariantList &extraValues, bool reversed) const
+{
+	const auto properties = indexedProperties(typeName);
+	QStringList joins;
+	QStringList conditions {QStringLiteral("DataIndex.Type = ?"), QStringLiteral("DataIndex.File IS NOT NULL")};
+	QStringList ordering;
+	QVariantList joinValues;
+	QVariantList conditionValues {typeName};
+
+	//every condition joins the index entry of its property
+	auto cIndex = 0;
+	for(const auto &condition : query.conditions()) {
+		if(!properties.contains(condition.property))
+			throw LocalStoreException(_defaults, typeName, condition.property, QStringLiteral("Property is not indexed"));
+
+		const auto alias = QStringLiteral("c%1").arg(cIndex++);
+		joins.append(QStringLiteral("INNER JOIN PropertyIndex AS %1 "
+									"ON %1.Type = DataIndex.Type AND %1.Id = DataIndex.Id AND %1.Property = ?")
+					 .arg(alias));
+		joinValues.append(condition.property);
+
+		QString op;
+		switch(condition.op) {
+		case DataQuery::Equal:
+			op = QStringLiteral("=");
+			break;
+		case DataQuery::NotEqual:
+			op = QStringLiteral("!=");
+			break;
+		case DataQuery::Less:
+			op = QStringLiteral("<");
+			break;
+		case DataQuery::LessEqual:
+			op = QStringLiteral("<=");
+			break;
+		case DataQuery::Greater:
+			op = QStringLiteral(">");
+			break;
+		case DataQuery::GreaterEqual:
+			op = QStringLiteral(">=");
+			break;
+		case DataQuery::Like:
+			op = QStringLiteral("LIKE");
+			break;
+		default:
+			Q_UNREACHABLE();
+			break;
+		}
+		conditions.append(QStringLiteral("%1.Value %2 ?").arg(alias, op));
+		conditionValues.append(indexValue(QJsonValue::fromVariant(condition.value)));
+	}
+	//extra conditions may refer to the sort values as o0, o1, ...
+	if(!extraCondition.isEmpty()) {
+		conditions.append(extraCondition);
+		conditionValues.append(extraValues);
+	}
+
+	//sorting joins optionally, so datasets without the property are kept
+	if(paged || !extraCondition.isEmpty()) {
+		auto oIndex = 0;
+		for(const auto &order : query.sortOrders()) {
+			if(!properties.contains(order.first))
+				throw LocalStoreException(_defaults, typeName, order.first, QStringLiteral("Property is not indexed"));
+
+			const auto alias = QStringLiteral("o%1").arg(oIndex++);
+			joins.append(QStringLiteral("LEFT JOIN PropertyIndex AS %1 "
+										"ON %1.Type = DataIndex.Type AND %1.Id = DataIndex.Id AND %1.Property = ?")
+						 .arg(alias));
+			joinValues.append(order.first);
+			ordering.append(QStringLiteral("%1.Value %2")
+							.arg(alias, (order.second == Qt::AscendingOrder) != reversed ? QStringLiteral("ASC") : QStringLiteral("DESC")));
+		}
+		//the key is always used last to get a stable order for paging
+		ordering.append(reversed ? QStringLiteral("DataIndex.Id DESC") : QStringLiteral("DataIndex.Id ASC"));
+	}
+
+	auto statement = QStringLiteral("SELECT %1 FROM DataIndex %2 WHERE %3")
+					 .arg(columns, joins.join(QLatin1Char(' ')), conditions.join(QStringLiteral(" AND ")));
+	bindValues = joinValues + conditionValues;
+	if(paged) {
+		statement += QStringLiteral(" ORDER BY ") + ordering.join(QStringLiteral(", "));
+		if(query.limit() >= 0 || query.offset() > 0) {
+			statement += QStringLiteral(" LIMIT ? OFFSET ?");
+			bindValues.append(query.limit());
+			bindValues.append(query.offset());
+		}
+	}
+	return statement;
+}
+
+int LocalStore::compressionLevel(const QByteArray &typeName) const
+{
+	auto it = _compressionLevels.constFind(typeName);
+	if(it != _compressionLevels.constEnd())
+		return *it;
+
+	auto level = _defaults.property(Defaults::CompressionLevels)
+				 .toHash()
+				 .value(QString::fromUtf8(typeName), 0)
+				 .toInt();
+	_compressionLevels.insert(typeName, level);
+	return level;
+}
+
+QByteArray LocalStore::serializeData(const ObjectKey &key, const QJsonObject &data) const
+{
+	auto binData = SyncHelper::encodeCbor(data);
+	auto level = compressionLevel(key.typeName);
+	if(level == 0)
+		return binData;
+	else
+		return CompressedMagic + qCompress(binData, level);
+}
+
+QByteArray LocalStore::uncompressData(const ObjectKey &key, const QByteArray &data, const QString &context) const
+{
+	//detect compression per dataset, so changing the setup does not require a migration
+	if(!data.startsWith(CompressedMagic))
+		return data;
+
+	auto binData = qUncompress(data.mid(CompressedMagic.size()));
+	if(binData.isEmpty())
+		throw LocalStoreException(_defaults, key, context, QStringLiteral("Stored data contains invalid compressed data"));
+	return binData;
+}
+
+QJsonObject LocalStore::deserializeData(const ObjectKey &key, const QByteArray &data, const QString &context, bool *legacy) const
+{
+	//detect the format per dataset as well
+	auto binData = uncompressData(key, data, context);
+	if(SyncHelper::isCbor(binData)) {
+		auto ok = false;
+		auto json = SyncHelper::decodeCbor(binData, &ok);
+		if(!ok)
+			throw LocalStoreException(_defaults, key, context, QStringLiteral("Stored data contains invalid cbor data"));
+		return json;
+	} else {
+		//data written before 4.3 - still readable, but gets rewritten by upgradePayloads
+		if(legacy)
+			*legacy = true;
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+		auto doc = QJsonDocument::fromBinaryData(binData);
+QT_WARNING_POP
+		if(!doc.isObject())
+			throw LocalStoreException(_defaults, key, context, QStringLiteral("Stored data contains invalid json data"));
+		return doc.object();
+	}
+}
+
+QJsonObject LocalStore::deserializeProperties(const ObjectKey &key, const QByteArray &data, const QString &context, const QStringList &properties) const
+{
+	auto binData = uncompressData(key, data, context);
+	if(SyncHelper::isCbor(binData)) {
+		auto ok = false;
+		auto json = SyncHelper::decodeCborProperties(binData, properties, &ok);
+		if(!ok)
+			throw LocalStoreException(_defaults, key, context, QStringLiteral("Stored data contains invalid cbor data"));
+		return json;
+	} else {
+		//legacy data cannot be read partially
+		return projectData(deserializeData(key, binData, context), properties);
+	}
+}
+
+QJsonObject LocalStore::readStored(const ObjectKey &key, const QString &fileName, const QVariant &inlineData, bool *legacy) const
+{
+	if(fileName == InlineFile)
+		return deserializeData(key, inlineData.toByteArray(), _database->databaseName(), legacy);
+	else
+		return readJson(key, fileName, legacy);
+}
+
 void LocalStore::beginReadTransaction(const ObjectKey &key) const
 {
 	if(!_database->transaction())
 		throw LocalStoreException(_defaults, key, _database->databaseName(), _database->lastError().text());
 }
 
-void LocalStore::beginWriteTransaction(const ObjectKey &key, bool exclusive)
+void LocalStore::beginWriteTransaction(const ObjectKey &key, bool exclusive) const
 {
 	QSqlQuery transactQuery(_database);
 	if(!transactQuery.exec(QStringLiteral("BEGIN %1 TRANSACTION")
@@ -769,6 +2348,25 @@ void LocalStore::beginWriteTransaction(const ObjectKey &key, bool exclusive)
 	}
 }
 
+LocalStore::CachedQuery::CachedQuery(const DatabaseRef &db, const QString &statement) :
+	_query{db.cachedQuery(statement)}
+{}
+
+LocalStore::CachedQuery::~CachedQuery()
+{
+	_query.finish();
+}
+
+QSqlQuery &LocalStore::CachedQuery::operator*()
+{
+	return _query;
+}
+
+QSqlQuery *LocalStore::CachedQuery::operator->()
+{
+	return &_query;
+}
+
 void LocalStore::exec(QSqlQuery &query, const ObjectKey &key) const
 {
 	if(!query.exec()) {
@@ -781,89 +2379,175 @@ void LocalStore::exec(QSqlQuery &query, const ObjectKey &key) const
 
 function<void()> LocalStore::storeChangedImpl(const DatabaseRef &db, const ObjectKey &key, quint64 version, const QString &fileName, const QJsonObject &data, bool changed, bool existing)
 {
-	auto tableDir = typeDirectory(key);
+	QString obsoleteFile;
+	writeDataImpl(db, key, version, fileName, data, changed, existing, obsoleteFile);
+
+	//update cache
+	_emitter->putCached(key, data);
+
+	return [this, key, changed, obsoleteFile]() {
+		//remove the file of a dataset that was moved into the database
+		if(!obsoleteFile.isNull() && !QFile::remove(obsoleteFile))
+			logWarning() << "Failed to remove obsolete file" << obsoleteFile;
+		//trigger change signals
+		_emitter->triggerChange(key, false, changed);
+	};
+}
+
+void LocalStore::writeDataImpl(const DatabaseRef &db, const ObjectKey &key, quint64 version, const QString &fileName, const QJsonObject &data, bool changed, bool existing, QString &obsoleteFile)
+{
+	const auto payload = serializeData(key, data);
+	const auto hasFile = existing && !fileName.isNull() && fileName != InlineFile;
+	QString storedFile;
+	QVariant storedData{QVariant::ByteArray};
 	QScopedPointer<QFileDevice> device;
 	function<bool(QFileDevice*)> fileCommitFn;
 
-	if(existing && !fileName.isNull()) {
-		auto file = new QSaveFile(filePath(tableDir, fileName));
-		device.reset(file);
-		if(!file->open(QIODevice::WriteOnly))
-			throw LocalStoreException(_defaults, key, file->fileName(), file->errorString());
-		fileCommitFn = [](QFileDevice *d){
-			return static_cast<QSaveFile*>(d)->commit();
-		};
+	if(isInlineMode()) {
+		storedFile = InlineFile;
+		storedData = payload;
+		if(hasFile) //stored as file before -> remove it once the data lives in the database
+			obsoleteFile = filePath(key, fileName);
 	} else {
-		auto newFileName = QStringLiteral("%1XXXXXX")
-						   .arg(QString::fromUtf8(QUuid::createUuid().toRfc4122().toHex()));
-		auto file = new QTemporaryFile(filePath(tableDir, newFileName));
-		device.reset(file);
-		if(!file->open())
-			throw LocalStoreException(_defaults, key, file->fileName(), file->errorString());
-		fileCommitFn = [](QFileDevice *d){
-			auto f = static_cast<QTemporaryFile*>(d);
-			f->close();
-			if(f->error() == QFile::NoError) {
-				f->setAutoRemove(false);
-				return true;
-			} else
-				return false;
-		};
-	}
+		auto tableDir = typeDirectory(key);
+		if(hasFile) {
+			auto file = new QSaveFile(filePath(tableDir, fileName));
+			device.reset(file);
+			if(!file->open(QIODevice::WriteOnly))
+				throw LocalStoreException(_defaults, key, file->fileName(), file->errorString());
+			fileCommitFn = [](QFileDevice *d){
+				return static_cast<QSaveFile*>(d)->commit();
+			};
+		} else {
+			auto newFileName = QStringLiteral("%1XXXXXX")
+							   .arg(QString::fromUtf8(QUuid::createUuid().toRfc4122().toHex()));
+			auto file = new QTemporaryFile(filePath(tableDir, newFileName));
+			device.reset(file);
+			if(!file->open())
+				throw LocalStoreException(_defaults, key, file->fileName(), file->errorString());
+			fileCommitFn = [](QFileDevice *d){
+				auto f = static_cast<QTemporaryFile*>(d);
+				f->close();
+				if(f->error() == QFile::NoError) {
+					f->setAutoRemove(false);
+					return true;
+				} else
+					return false;
+			};
+		}
 
-	//write the data & get the hash
-	device->write(QJsonDocument(data).toBinaryData());
-	if(device->error() != QFile::NoError)
-		throw LocalStoreException(_defaults, key, device->fileName(), device->errorString());
+		//write the data
+		device->write(payload);
+		if(device->error() != QFile::NoError)
+			throw LocalStoreException(_defaults, key, device->fileName(), device->errorString());
+		storedFile = tableDir.relativeFilePath(QFileInfo{device->fileName()}.completeBaseName());
+	}
 
 	//save key in database
-	QFileInfo info(device->fileName());
 	if(existing) {
-		QSqlQuery updateQuery(db);
-		updateQuery.prepare(QStringLiteral("UPDATE DataIndex SET Version = ?, File = ?, Checksum = ?, Changed = ? WHERE Type = ? AND Id = ?"));
-		updateQuery.addBindValue(version);
-		updateQuery.addBindValue(tableDir.relativeFilePath(info.completeBaseName())); //still update file, in case it was set to NULL
-		updateQuery.addBindValue(SyncHelper::jsonHash(data));
-		updateQuery.addBindValue(changed);
-		updateQuery.addBindValue(key.typeName);
-		updateQuery.addBindValue(key.id);
-		exec(updateQuery, key);
+		CachedQuery updateQuery{db, QStringLiteral("UPDATE DataIndex SET Version = ?, File = ?, Checksum = ?, Changed = ?, Data = ? WHERE Type = ? AND Id = ?")};
+		updateQuery->addBindValue(version);
+		updateQuery->addBindValue(storedFile); //still update file, in case it was set to NULL
+		updateQuery->addBindValue(SyncHelper::jsonHash(data));
+		updateQuery->addBindValue(changed);
+		updateQuery->addBindValue(storedData);
+		updateQuery->addBindValue(key.typeName);
+		updateQuery->addBindValue(key.id);
+		exec(*updateQuery, key);
 	} else {
-		QSqlQuery insertQuery(db);
-		insertQuery.prepare(QStringLiteral("INSERT INTO DataIndex (Type, Id, Version, File, Checksum, Changed) VALUES(?, ?, ?, ?, ?, ?)"));
-		insertQuery.addBindValue(key.typeName);
-		insertQuery.addBindValue(key.id);
-		insertQuery.addBindValue(version);
-		insertQuery.addBindValue(tableDir.relativeFilePath(info.completeBaseName()));
-		insertQuery.addBindValue(SyncHelper::jsonHash(data));
-		insertQuery.addBindValue(changed);
-		exec(insertQuery, key);
+		CachedQuery insertQuery{db, QStringLiteral("INSERT INTO DataIndex (Type, Id, Version, File, Checksum, Changed, Data) VALUES(?, ?, ?, ?, ?, ?, ?)")};
+		insertQuery->addBindValue(key.typeName);
+		insertQuery->addBindValue(key.id);
+		insertQuery->addBindValue(version);
+		insertQuery->addBindValue(storedFile);
+		insertQuery->addBindValue(SyncHelper::jsonHash(data));
+		insertQuery->addBindValue(changed);
+		insertQuery->addBindValue(storedData);
+		exec(*insertQuery, key);
 	}
+	updateIndexImpl(db, key, data);
 
 	//complete the file-save (last before commit!)
-	if(!fileCommitFn(device.data()))
+	if(device && !fileCommitFn(device.data()))
 		throw LocalStoreException(_defaults, key, device->fileName(), device->errorString());
+}
 
-	//update cache
-	_emitter->putCached(key, data, static_cast<int>(info.size()));
+void LocalStore::updateIndexImpl(const DatabaseRef &db, const ObjectKey &key, const QJsonObject &data)
+{
+	updatePropertyIndexImpl(db, key, data);
+	updateFullTextImpl(db, key, data);
+}
 
-	return [this, key, changed]() {
-		//trigger change signals
-		_emitter->triggerChange(key, false, changed);
-	};
+void LocalStore::updatePropertyIndexImpl(const DatabaseRef &db, const ObjectKey &key, const QJsonObject &data)
+{
+	const auto properties = indexedProperties(key.typeName);
+	if(properties.isEmpty())
+		return;
+
+	CachedQuery removeQuery{db, QStringLiteral("DELETE FROM PropertyIndex WHERE Type = ? AND Id = ?")};
+	removeQuery->addBindValue(key.typeName);
+	removeQuery->addBindValue(key.id);
+	exec(*removeQuery, key);
+
+	if(data.isEmpty())
+		return;
+	CachedQuery insertQuery{db, QStringLiteral("INSERT OR IGNORE INTO PropertyIndex (Type, Property, Value, Id) VALUES(?, ?, ?, ?)")};
+	for(const auto &property : properties) {
+		auto value = indexValue(data.value(property));
+		if(value.isNull())
+			continue;
+		insertQuery->addBindValue(key.typeName);
+		insertQuery->addBindValue(property);
+		insertQuery->addBindValue(value);
+		insertQuery->addBindValue(key.id);
+		exec(*insertQuery, key);
+	}
+}
+
+void LocalStore::updateFullTextImpl(const DatabaseRef &db, const ObjectKey &key, const QJsonObject &data)
+{
+	if(!_fullTextAvailable)
+		return;
+	const auto properties = fullTextProperties(key.typeName);
+	if(properties.isEmpty())
+		return;
+
+	//the trigger removes the index entry as well
+	CachedQuery removeQuery{db, QStringLiteral("DELETE FROM FullTextKeys WHERE Type = ? AND Id = ?")};
+	removeQuery->addBindValue(key.typeName);
+	removeQuery->addBindValue(key.id);
+	exec(*removeQuery, key);
+
+	if(data.isEmpty())
+		return;
+	const auto content = fullTextContent(data, properties);
+	if(content.isEmpty())
+		return;
+
+	CachedQuery insertKeyQuery{db, QStringLiteral("INSERT INTO FullTextKeys (Type, Id) VALUES(?, ?)")};
+	insertKeyQuery->addBindValue(key.typeName);
+	insertKeyQuery->addBindValue(key.id);
+	exec(*insertKeyQuery, key);
+
+	CachedQuery insertQuery{db, QStringLiteral("INSERT INTO FullTextIndex (rowid, Content) VALUES(?, ?)")};
+	insertQuery->addBindValue(insertKeyQuery->lastInsertId());
+	insertQuery->addBindValue(content);
+	exec(*insertQuery, key);
 }
 
 void LocalStore::markUnchangedImpl(const DatabaseRef &db, const ObjectKey &key, quint64 version, bool isDelete)
 {
-	QSqlQuery completeQuery(db);
-	if(isDelete && !_defaults.property(Defaults::PersistDeleted).toBool())
-		completeQuery.prepare(QStringLiteral("DELETE FROM DataIndex WHERE Type = ? AND Id = ? AND Version = ? AND File IS NULL"));
-	else
-		completeQuery.prepare(QStringLiteral("UPDATE DataIndex SET Changed = 0 WHERE Type = ? AND Id = ? AND Version = ?"));
-	completeQuery.addBindValue(key.typeName);
-	completeQuery.addBindValue(key.id);
-	completeQuery.addBindValue(version);
-	exec(completeQuery);
+	const auto removeEntry = isDelete && !_defaults.property(Defaults::PersistDeleted).toBool();
+	CachedQuery completeQuery{db, removeEntry ?
+				QStringLiteral("DELETE FROM DataIndex WHERE Type = ? AND Id = ? AND Version = ? AND File IS NULL") :
+				QStringLiteral("UPDATE DataIndex SET Changed = 0 WHERE Type = ? AND Id = ? AND Version = ?")};
+	completeQuery->addBindValue(key.typeName);
+	completeQuery->addBindValue(key.id);
+	completeQuery->addBindValue(version);
+	exec(*completeQuery);
+	//a cached miss of the deleted dataset would still claim it exists
+	if(removeEntry)
+		_emitter->dropCached(key);
 }
 
 // ------------- SyncScope -------------
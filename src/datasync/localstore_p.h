@@ -6,10 +6,12 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QJsonObject>
 #include <QtCore/QUuid>
 
 #include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
 
 #include "qtdatasync_global.h"
 #include "objectkey.h"
@@ -17,6 +19,7 @@
 #include "logger.h"
 #include "exception.h"
 #include "datastore.h"
+#include "dataquery.h"
 
 namespace QtDataSync {
 
@@ -54,23 +57,52 @@ public:
 		SyncScope(const Defaults &defaults, const ObjectKey &key, LocalStore *owner);
 	};
 
+	struct ChunkEntry {
+		QString id;
+		QJsonObject data;
+		QSharedPointer<QException> error;
+	};
+
+	static const QString InlineFile;
+	static const char * const IndexClassInfo;
+	static const char * const FullTextClassInfo;
+	static const QByteArray CompressedMagic;
+
 	explicit LocalStore(Defaults defaults, QObject *parent = nullptr);
 	~LocalStore() override;
 
-	QJsonObject readJson(const ObjectKey &key, const QString &filePath, int *costs = nullptr) const;
+	QJsonObject readJson(const ObjectKey &key, const QString &filePath, bool *legacy = nullptr) const;
+	void migrateStorage();
+	void upgradePayloads();
+	void rebuildIndexes();
 
 	// normal store access
 	quint64 count(const QByteArray &typeName) const;
 	QStringList keys(const QByteArray &typeName) const;
 	QList<QJsonObject> loadAll(const QByteArray &typeName) const;
+	QList<ChunkEntry> loadChunk(const QByteArray &typeName, const QString &afterId, int size) const;
 
 	bool contains(const ObjectKey &key) const;
 	QJsonObject load(const ObjectKey &key) const;
+	bool loadCachedValue(const ObjectKey &key, int metaTypeId, QVariant &value) const;
+	void cacheValue(const ObjectKey &key, const QJsonObject &source, int metaTypeId, const QVariant &value) const;
+	DataStore::CacheStatistics cacheStatistics(const QByteArray &typeName) const;
+	QJsonObject loadProperties(const ObjectKey &key, const QStringList &properties) const;
 	void save(const ObjectKey &key, const QJsonObject &data);
 	bool remove(const ObjectKey &key);
+	void saveAll(const QByteArray &typeName, const QHash<QString, QJsonObject> &data);
+	int removeAll(const QByteArray &typeName, const QStringList &ids);
 
 	QList<QJsonObject> find(const QByteArray &typeName, const QString &query, DataStore::SearchMode mode) const;
+	QList<DataStore::SearchMatch> fullTextMatches(const QByteArray &typeName, const QString &query, int limit) const;
+	QStringList indexedKeys(const QByteArray &typeName, const QString &property, const QVariant &value) const;
+	QList<QJsonObject> loadIndexed(const QByteArray &typeName, const QString &property, const QVariant &value) const;
+	quint64 count(const QByteArray &typeName, const DataQuery &query) const;
+	QStringList keys(const QByteArray &typeName, const DataQuery &query) const;
+	bool precedingKeys(const QByteArray &typeName, const DataQuery &query, const QString &key, int limit, QStringList &keys) const;
+	QList<QJsonObject> query(const QByteArray &typeName, const DataQuery &query) const;
 	void clear(const QByteArray &typeName);
+	void detachChanges();
 	void reset(bool keepData);
 
 	// change access
@@ -105,20 +137,64 @@ public:
 
 Q_SIGNALS:
 	void dataChanged(const QtDataSync::ObjectKey &key, bool deleted);
+	void dataChangedBatch(const QByteArray &typeName, const QStringList &ids, bool deleted);
 	void dataResetted();
 
 private:
+	//finishes the cached query once the scope is left, so no statement stays active
+	class CachedQuery
+	{
+		Q_DISABLE_COPY(CachedQuery)
+
+	public:
+		CachedQuery(const DatabaseRef &db, const QString &statement);
+		~CachedQuery();
+
+		QSqlQuery &operator*();
+		QSqlQuery *operator->();
+
+	private:
+		QSqlQuery _query;
+	};
+
 	Defaults _defaults;
 	Logger *_logger;
 	EmitterAdapter *_emitter;
 	DatabaseRef _database;
+	mutable QHash<QByteArray, QStringList> _indexedProperties;
+	mutable QHash<QByteArray, QStringList> _fullTextProperties;
+	bool _fullTextAvailable = false;
+	mutable QHash<QByteArray, int> _compressionLevels;
 
 	QDir typeDirectory(const ObjectKey &key) const;
 	QString filePath(const QDir &typeDir, const QString &baseName) const;
 	QString filePath(const ObjectKey &key, const QString &baseName) const;
+	bool isInlineMode() const;
+	QStringList indexedProperties(const QByteArray &typeName) const;
+	QStringList fullTextProperties(const QByteArray &typeName) const;
+	QStringList typeProperties(const QByteArray &typeName, Defaults::PropertyKey setupKey, const char *classInfo) const;
+	static QVariant indexValue(const QJsonValue &value);
+	static QString fullTextContent(const QJsonObject &data, const QStringList &properties);
+	static QJsonObject projectData(const QJsonObject &data, const QStringList &properties);
+	QString queryStatement(const QByteArray &typeName,
+						   const DataQuery &query,
+						   const QString &columns,
+						   bool paged,
+						   QVariantList &bindValues,
+						   const QString &extraCondition = {},
+						   const QVariantList &extraValues = {},
+						   bool reversed = false) const;
+
+	int compressionLevel(const QByteArray &typeName) const;
+
+	QByteArray serializeData(const ObjectKey &key, const QJsonObject &data) const;
+	QByteArray uncompressData(const ObjectKey &key, const QByteArray &data, const QString &context) const;
+	QJsonObject deserializeData(const ObjectKey &key, const QByteArray &data, const QString &context, bool *legacy = nullptr) const;
+	QJsonObject deserializeProperties(const ObjectKey &key, const QByteArray &data, const QString &context, const QStringList &properties) const;
+	QJsonObject readStored(const ObjectKey &key, const QString &fileName, const QVariant &inlineData, bool *legacy = nullptr) const;
 
 	void beginReadTransaction(const ObjectKey &key = ObjectKey{"any"}) const;
-	void beginWriteTransaction(const ObjectKey &key = ObjectKey{"any"}, bool exclusive = false);
+	void beginWriteTransaction(const ObjectKey &key = ObjectKey{"any"}, bool exclusive = false) const;
 	void exec(QSqlQuery &query, const ObjectKey &key = ObjectKey{"any"}) const;
 
 	Q_REQUIRED_RESULT std::function<void ()> storeChangedImpl(const DatabaseRef &db,
@@ -128,6 +204,24 @@ private:
 																 const QJsonObject &data,
 																 bool changed,
 																 bool existing);
+	void writeDataImpl(const DatabaseRef &db,
+					   const ObjectKey &key,
+					   quint64 version,
+					   const QString &filePath,
+					   const QJsonObject &data,
+					   bool changed,
+					   bool existing,
+					   QString &obsoleteFile);
+	void updateIndexImpl(const DatabaseRef &db,
+						 const ObjectKey &key,
+						 const QJsonObject &data = {});
+	void updatePropertyIndexImpl(const DatabaseRef &db,
+								 const ObjectKey &key,
+								 const QJsonObject &data);
+	void updateFullTextImpl(const DatabaseRef &db,
+							const ObjectKey &key,
+							const QJsonObject &data);
+	QList<QJsonObject> findFullText(const QByteArray &typeName, const QString &query) const;
 	void markUnchangedImpl(const DatabaseRef &db,
 						   const ObjectKey &key,
 						   quint64 version,
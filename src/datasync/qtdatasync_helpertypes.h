@@ -4,6 +4,8 @@
 #include <type_traits>
 
 #include <QtCore/qobject.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qlist.h>
 
 #include "QtDataSync/qtdatasync_global.h"
 
@@ -28,6 +30,23 @@ struct is_storable : public is_gadget<T> {};
 template <typename T>
 struct is_storable<T*> : public std::is_base_of<QObject, T> {};
 
+Q_DATASYNC_EXPORT void moveToThread(QVariant &value, QThread *thread);
+
+template <typename T>
+inline std::enable_if_t<is_object<T>::value> moveToThread(T &value, QThread *thread) {
+	if(value)
+		value->moveToThread(thread);
+}
+
+template <typename T>
+inline std::enable_if_t<!is_object<T>::value> moveToThread(T &, QThread *) {}
+
+template <typename T>
+inline void moveToThread(QList<T> &values, QThread *thread) {
+	for(auto &value : values)
+		moveToThread(value, thread);
+}
+
 }
 }
 
@@ -501,6 +501,8 @@ void RemoteConnector::binaryMessageReceived(const QByteArray &message)
 			onDeviceKeys(Message::deserializeMessage<DeviceKeysMessage>(stream));
 		else if(Message::isType<NewKeyAckMessage>(name))
 			onNewKeyAck(Message::deserializeMessage<NewKeyAckMessage>(stream));
+		else if(Message::isType<CapabilitiesMessage>(name))
+			onCapabilities(Message::deserializeMessage<CapabilitiesMessage>(stream));
 		else {
 			logWarning().noquote() << "Unknown message received:" << Message::typeName(name);
 			triggerError(true);
@@ -938,6 +940,8 @@ void RemoteConnector::onIdentify(const IdentifyMessage &message)
 		triggerError(true);
 	} else {
 		emit updateUploadLimit(message.uploadLimit);
+		//servers that do not negotiate capabilities only get text json
+		emit updatePayloadFormat(SyncHelper::JsonPayload);
 		if(!_deviceId.isNull()) {
 			LoginMessage msg(_deviceId,
 							 sValue(keyDeviceName).toString(),
@@ -1253,6 +1257,26 @@ void RemoteConnector::onNewKeyAck(const NewKeyAckMessage &message)
 	}
 }
 
+void RemoteConnector::onCapabilities(const CapabilitiesMessage &message)
+{
+	//sent right before the account, welcome or grant message, and again while idle whenever the account version changes
+	if(!_stateMachine->isActive(QStringLiteral("Registering")) &&
+	   !_stateMachine->isActive(QStringLiteral("LoggingIn")) &&
+	   !_stateMachine->isActive(QStringLiteral("Granting")) &&
+	   !_stateMachine->isActive(QStringLiteral("Idle"))) {
+		logWarning() << "Unexpected CapabilitiesMessage";
+		triggerError(true);
+	} else {
+		logDebug() << "Account protocol version:" << message.accountVersion;
+		//while idle, the server only accepts the new format after the echo confirmed it
+		if(_stateMachine->isActive(QStringLiteral("Idle")))
+			sendMessage(message);
+		emit updatePayloadFormat(message.hasCborPayloads() ?
+									 SyncHelper::CborPayload :
+									 SyncHelper::JsonPayload);
+	}
+}
+
 
 
 QByteArray ExportData::signData() const
@@ -15,6 +15,7 @@
 #include "defaults.h"
 #include "cryptocontroller_p.h"
 #include "accountmanager.h"
+#include "synchelper_p.h"
 
 #include "errormessage_p.h"
 #include "identifymessage_p.h"
@@ -30,6 +31,7 @@
 #include "macupdatemessage_p.h"
 #include "devicekeysmessage_p.h"
 #include "newkeymessage_p.h"
+#include "capabilitiesmessage_p.h"
 
 class ConnectorStateMachine;
 
@@ -121,6 +123,7 @@ Q_SIGNALS:
 	void finalized();
 
 	void updateUploadLimit(quint32 limit);
+	void updatePayloadFormat(QtDataSync::SyncHelper::PayloadFormat format);
 	void remoteEvent(RemoteEvent event);
 
 	void uploadDone(const QByteArray &key);
@@ -208,6 +211,7 @@ private:
 	void onMacUpdateAck(const MacUpdateAckMessage &message);
 	void onDeviceKeys(const DeviceKeysMessage &message);
 	void onNewKeyAck(const NewKeyAckMessage &message);
+	void onCapabilities(const CapabilitiesMessage &message);
 };
 
 }
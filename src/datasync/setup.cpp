@@ -210,6 +210,36 @@ Setup::EventMode Setup::eventLoggingMode() const
 	return d->properties.value(Defaults::EventLoggingMode).value<EventMode>();
 }
 
+Setup::StorageMode Setup::storageMode() const
+{
+	return d->properties.value(Defaults::DataStorageMode).value<StorageMode>();
+}
+
+Setup::JournalMode Setup::journalMode() const
+{
+	return d->properties.value(Defaults::DatabaseJournalMode).value<JournalMode>();
+}
+
+Setup::SynchronousMode Setup::synchronousMode() const
+{
+	return d->properties.value(Defaults::DatabaseSynchronous).value<SynchronousMode>();
+}
+
+qint64 Setup::mmapSize() const
+{
+	return d->properties.value(Defaults::DatabaseMmapSize).toLongLong();
+}
+
+int Setup::databaseCacheSize() const
+{
+	return d->properties.value(Defaults::DatabaseCacheSize).toInt();
+}
+
+bool Setup::isObjectCacheEnabled() const
+{
+	return d->properties.value(Defaults::ObjectCache).toBool();
+}
+
 Setup &Setup::setLocalDir(QString localDir)
 {
 	d->localDir = std::move(localDir);
@@ -319,6 +349,42 @@ Setup &Setup::setEventLoggingMode(Setup::EventMode eventLoggingMode)
 	return *this;
 }
 
+Setup &Setup::setStorageMode(Setup::StorageMode storageMode)
+{
+	d->properties.insert(Defaults::DataStorageMode, QVariant::fromValue(storageMode));
+	return *this;
+}
+
+Setup &Setup::setJournalMode(Setup::JournalMode journalMode)
+{
+	d->properties.insert(Defaults::DatabaseJournalMode, QVariant::fromValue(journalMode));
+	return *this;
+}
+
+Setup &Setup::setSynchronousMode(Setup::SynchronousMode synchronousMode)
+{
+	d->properties.insert(Defaults::DatabaseSynchronous, QVariant::fromValue(synchronousMode));
+	return *this;
+}
+
+Setup &Setup::setMmapSize(qint64 mmapSize)
+{
+	d->properties.insert(Defaults::DatabaseMmapSize, mmapSize);
+	return *this;
+}
+
+Setup &Setup::setDatabaseCacheSize(int databaseCacheSize)
+{
+	d->properties.insert(Defaults::DatabaseCacheSize, databaseCacheSize);
+	return *this;
+}
+
+Setup &Setup::setObjectCacheEnabled(bool objectCacheEnabled)
+{
+	d->properties.insert(Defaults::ObjectCache, objectCacheEnabled);
+	return *this;
+}
+
 Setup &Setup::resetLocalDir()
 {
 	d->localDir = SetupPrivate::DefaultLocalDir;
@@ -424,6 +490,36 @@ Setup &Setup::resetEventLoggingMode()
 	return setEventLoggingMode(EventMode::Unchanged);
 }
 
+Setup &Setup::resetStorageMode()
+{
+	return setStorageMode(StorageMode::Files);
+}
+
+Setup &Setup::resetJournalMode()
+{
+	return setJournalMode(JournalMode::Delete);
+}
+
+Setup &Setup::resetSynchronousMode()
+{
+	return setSynchronousMode(SynchronousMode::Full);
+}
+
+Setup &Setup::resetMmapSize()
+{
+	return setMmapSize(0);
+}
+
+Setup &Setup::resetDatabaseCacheSize()
+{
+	return setDatabaseCacheSize(-2000);
+}
+
+Setup &Setup::resetObjectCacheEnabled()
+{
+	return setObjectCacheEnabled(false);
+}
+
 Setup &Setup::setAccount(const QJsonObject &importData, bool keepData, bool allowFailure)
 {
 	d->initialImport = ExchangeEngine::ImportData {
@@ -467,6 +563,63 @@ Setup &Setup::setAccountTrusted(const QByteArray &importData, const QString &pas
 	}
 }
 
+QStringList Setup::indexedProperties(const QByteArray &typeName) const
+{
+	return d->properties.value(Defaults::IndexedProperties)
+			.toHash()
+			.value(QString::fromUtf8(typeName))
+			.toStringList();
+}
+
+Setup &Setup::setIndexedProperties(const QByteArray &typeName, const QStringList &properties)
+{
+	auto indexes = d->properties.value(Defaults::IndexedProperties).toHash();
+	if(properties.isEmpty())
+		indexes.remove(QString::fromUtf8(typeName));
+	else
+		indexes.insert(QString::fromUtf8(typeName), properties);
+	d->properties.insert(Defaults::IndexedProperties, indexes);
+	return *this;
+}
+
+QStringList Setup::fullTextProperties(const QByteArray &typeName) const
+{
+	return d->properties.value(Defaults::FullTextProperties)
+			.toHash()
+			.value(QString::fromUtf8(typeName))
+			.toStringList();
+}
+
+Setup &Setup::setFullTextProperties(const QByteArray &typeName, const QStringList &properties)
+{
+	auto indexes = d->properties.value(Defaults::FullTextProperties).toHash();
+	if(properties.isEmpty())
+		indexes.remove(QString::fromUtf8(typeName));
+	else
+		indexes.insert(QString::fromUtf8(typeName), properties);
+	d->properties.insert(Defaults::FullTextProperties, indexes);
+	return *this;
+}
+
+int Setup::compressionLevel(const QByteArray &typeName) const
+{
+	return d->properties.value(Defaults::CompressionLevels)
+			.toHash()
+			.value(QString::fromUtf8(typeName), 0)
+			.toInt();
+}
+
+Setup &Setup::setCompressionLevel(const QByteArray &typeName, int level)
+{
+	auto levels = d->properties.value(Defaults::CompressionLevels).toHash();
+	if(level == 0)
+		levels.remove(QString::fromUtf8(typeName));
+	else
+		levels.insert(QString::fromUtf8(typeName), qBound(-1, level, 9));
+	d->properties.insert(Defaults::CompressionLevels, levels);
+	return *this;
+}
+
 void Setup::create(const QString &name)
 {
 	QMutexLocker _(&SetupPrivate::setupMutex);
@@ -637,7 +790,13 @@ SetupPrivate::SetupPrivate() :
 		{Defaults::SignScheme, Setup::ED25519},
 		{Defaults::CryptScheme, Setup::ECIES_ECP_SHA3_512},
 		{Defaults::SymScheme, Setup::AES_EAX},
-		{Defaults::EventLoggingMode, QVariant::fromValue(Setup::EventMode::Unchanged)}
+		{Defaults::EventLoggingMode, QVariant::fromValue(Setup::EventMode::Unchanged)},
+		{Defaults::DataStorageMode, QVariant::fromValue(Setup::StorageMode::Files)},
+		{Defaults::DatabaseJournalMode, QVariant::fromValue(Setup::JournalMode::Delete)},
+		{Defaults::DatabaseSynchronous, QVariant::fromValue(Setup::SynchronousMode::Full)},
+		{Defaults::DatabaseMmapSize, 0ll},
+		{Defaults::DatabaseCacheSize, -2000},
+		{Defaults::ObjectCache, false}
 	}
 {}
 
@@ -14,6 +14,7 @@ class QLockFile;
 #include "QtDataSync/qtdatasync_global.h"
 #include "QtDataSync/exception.h"
 #include "QtDataSync/remoteconfig.h"
+#include "QtDataSync/qtdatasync_helpertypes.h"
 
 class QJsonSerializer;
 
@@ -97,6 +98,18 @@ class Q_DATASYNC_EXPORT Setup
 	Q_PROPERTY(qint32 cipherKeySize READ cipherKeySize WRITE setCipherKeySize RESET resetCipherKeySize) //MAJOR make uint
 	//! The logging mode for database change events
 	Q_PROPERTY(EventMode eventLoggingMode READ eventLoggingMode WRITE setEventLoggingMode RESET resetEventLoggingMode REVISION 2)
+	//! The engine used to persist the serialized datasets
+	Q_PROPERTY(StorageMode storageMode READ storageMode WRITE setStorageMode RESET resetStorageMode REVISION 3)
+	//! The journal mode of the local sqlite database
+	Q_PROPERTY(JournalMode journalMode READ journalMode WRITE setJournalMode RESET resetJournalMode REVISION 3)
+	//! The synchronous level of the local sqlite database
+	Q_PROPERTY(SynchronousMode synchronousMode READ synchronousMode WRITE setSynchronousMode RESET resetSynchronousMode REVISION 3)
+	//! The maximum number of bytes of the local sqlite database to be memory mapped
+	Q_PROPERTY(qint64 mmapSize READ mmapSize WRITE setMmapSize RESET resetMmapSize REVISION 3)
+	//! The page cache size of every connection to the local sqlite database
+	Q_PROPERTY(int databaseCacheSize READ databaseCacheSize WRITE setDatabaseCacheSize RESET resetDatabaseCacheSize REVISION 3)
+	//! Specify whether deserialized datasets should be cached in addition to their json data
+	Q_PROPERTY(bool objectCacheEnabled READ isObjectCacheEnabled WRITE setObjectCacheEnabled RESET resetObjectCacheEnabled REVISION 3)
 
 public:
 	//! Typedef of an error handler function. See Setup::fatalErrorHandler
@@ -175,6 +188,31 @@ public:
 	};
 	Q_ENUM(EventMode)
 
+	//! The storage engines supported for Setup::storageMode
+	enum class StorageMode {
+		Files, //!< Every dataset is stored in its own file within the storage directory
+		Inline //!< Datasets are stored inline within the local sqlite database
+	};
+	Q_ENUM(StorageMode)
+
+	//! The sqlite journal modes supported for Setup::journalMode
+	enum class JournalMode {
+		Delete, //!< Rollback journal, deleted after each transaction (sqlite default)
+		Truncate, //!< Rollback journal, truncated after each transaction
+		Persist, //!< Rollback journal, invalidated but kept after each transaction
+		Wal //!< Write-ahead log. Allows readers to proceed concurrently with a writer
+	};
+	Q_ENUM(JournalMode)
+
+	//! The sqlite synchronous levels supported for Setup::synchronousMode
+	enum class SynchronousMode {
+		Off, //!< Never sync to disk. Data can get corrupted on power loss
+		Normal, //!< Sync at the most critical moments. Safe in combination with JournalMode::Wal
+		Full, //!< Sync after every transaction (sqlite default)
+		Extra //!< Like Full, but additionally syncs the directory of the rollback journal
+	};
+	Q_ENUM(SynchronousMode)
+
 	//! Checks if a setup for the given name does already exist
 	static bool exists(const QString &name = DefaultSetup);
 	//! Sets the maximum timeout for shutting down setups
@@ -238,6 +276,18 @@ public:
 	qint32 cipherKeySize() const;
 	//! @readAcFn{Setup::eventLoggingMode}
 	EventMode eventLoggingMode() const;
+	//! @readAcFn{Setup::storageMode}
+	StorageMode storageMode() const;
+	//! @readAcFn{Setup::journalMode}
+	JournalMode journalMode() const;
+	//! @readAcFn{Setup::synchronousMode}
+	SynchronousMode synchronousMode() const;
+	//! @readAcFn{Setup::mmapSize}
+	qint64 mmapSize() const;
+	//! @readAcFn{Setup::databaseCacheSize}
+	int databaseCacheSize() const;
+	//! @readAcFn{Setup::objectCacheEnabled}
+	bool isObjectCacheEnabled() const;
 
 	//! @writeAcFn{Setup::localDir}
 	Setup &setLocalDir(QString localDir);
@@ -275,6 +325,18 @@ public:
 	Setup &setCipherKeySize(qint32 cipherKeySize);
 	//! @writeAcFn{Setup::eventLoggingMode}
 	Setup &setEventLoggingMode(EventMode eventLoggingMode);
+	//! @writeAcFn{Setup::storageMode}
+	Setup &setStorageMode(StorageMode storageMode);
+	//! @writeAcFn{Setup::journalMode}
+	Setup &setJournalMode(JournalMode journalMode);
+	//! @writeAcFn{Setup::synchronousMode}
+	Setup &setSynchronousMode(SynchronousMode synchronousMode);
+	//! @writeAcFn{Setup::mmapSize}
+	Setup &setMmapSize(qint64 mmapSize);
+	//! @writeAcFn{Setup::databaseCacheSize}
+	Setup &setDatabaseCacheSize(int databaseCacheSize);
+	//! @writeAcFn{Setup::objectCacheEnabled}
+	Setup &setObjectCacheEnabled(bool objectCacheEnabled);
 
 	//! @resetAcFn{Setup::localDir}
 	Setup &resetLocalDir();
@@ -312,6 +374,18 @@ public:
 	Setup &resetCipherKeySize();
 	//! @resetAcFn{Setup::resetEventLoggingMode}
 	Setup &resetEventLoggingMode();
+	//! @resetAcFn{Setup::storageMode}
+	Setup &resetStorageMode();
+	//! @resetAcFn{Setup::journalMode}
+	Setup &resetJournalMode();
+	//! @resetAcFn{Setup::synchronousMode}
+	Setup &resetSynchronousMode();
+	//! @resetAcFn{Setup::mmapSize}
+	Setup &resetMmapSize();
+	//! @resetAcFn{Setup::databaseCacheSize}
+	Setup &resetDatabaseCacheSize();
+	//! @resetAcFn{Setup::objectCacheEnabled}
+	Setup &resetObjectCacheEnabled();
 
 	//! Sets an account to be imported on creation of the instance
 	Setup &setAccount(const QJsonObject &importData, bool keepData = false, bool allowFailure = false);
@@ -322,6 +396,28 @@ public:
 	//! @copydoc Setup::setAccountTrusted(const QJsonObject &, const QString &, bool, bool)
 	Setup &setAccountTrusted(const QByteArray &importData, const QString &password, bool keepData = false, bool allowFailure = false);
 
+	//! Returns the properties of the given type that are indexed in the local store
+	QStringList indexedProperties(const QByteArray &typeName) const;
+	//! Sets the properties of the given type to be indexed in the local store
+	Setup &setIndexedProperties(const QByteArray &typeName, const QStringList &properties);
+	//! @copybrief Setup::setIndexedProperties(const QByteArray &, const QStringList &)
+	template <typename T>
+	Setup &setIndexedProperties(const QStringList &properties);
+	//! Returns the properties of the given type that are indexed for full text searches
+	QStringList fullTextProperties(const QByteArray &typeName) const;
+	//! Sets the properties of the given type to be indexed for full text searches
+	Setup &setFullTextProperties(const QByteArray &typeName, const QStringList &properties);
+	//! @copybrief Setup::setFullTextProperties(const QByteArray &, const QStringList &)
+	template <typename T>
+	Setup &setFullTextProperties(const QStringList &properties);
+	//! Returns the level used to compress stored datasets of the given type
+	int compressionLevel(const QByteArray &typeName) const;
+	//! Sets the level used to compress stored datasets of the given type
+	Setup &setCompressionLevel(const QByteArray &typeName, int level);
+	//! @copybrief Setup::setCompressionLevel(const QByteArray &, int)
+	template <typename T>
+	Setup &setCompressionLevel(int level);
+
 	//! Creates a datasync instance from this setup with the given name
 	void create(const QString &name = DefaultSetup);
 	//! Creates a passive setup with the given name that connects to the primary datasync instance
@@ -390,6 +486,27 @@ protected:
 
 // ------------- Generic Implementation -------------
 
+template <typename T>
+Setup &Setup::setIndexedProperties(const QStringList &properties)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return setIndexedProperties(QMetaType::typeName(qMetaTypeId<T>()), properties);
+}
+
+template <typename T>
+Setup &Setup::setFullTextProperties(const QStringList &properties)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return setFullTextProperties(QMetaType::typeName(qMetaTypeId<T>()), properties);
+}
+
+template <typename T>
+Setup &Setup::setCompressionLevel(int level)
+{
+	QTDATASYNC_STORE_ASSERT(T);
+	return setCompressionLevel(QMetaType::typeName(qMetaTypeId<T>()), level);
+}
+
 template<typename TRatio>
 Q_DECL_CONSTEXPR inline int ratioBytes(intmax_t value)
 {
@@ -0,0 +1,353 @@
+#include "storecache_p.h"
+
+#include <QtCore/QJsonArray>
+
+using namespace QtDataSync;
+
+const int StoreCache::ShardCount = 16;
+
+StoreCache::StoreCache(int maxCost, bool cacheValues) :
+	_maxCost{maxCost},
+	_shardMaxCost{qMax(1, maxCost / ShardCount)},
+	_cacheValues{cacheValues},
+	_shards{new Shard[ShardCount]}
+{}
+
+StoreCache::~StoreCache()
+{
+	for(auto i = 0; i < ShardCount; i++)
+		_shards[i].clear();
+	delete[] _shards;
+}
+
+int StoreCache::maxCost() const
+{
+	return _maxCost;
+}
+
+bool StoreCache::cachesValues() const
+{
+	return _cacheValues;
+}
+
+int StoreCache::totalCost() const
+{
+	auto cost = 0;
+	for(auto i = 0; i < ShardCount; i++) {
+		QMutexLocker _(&_shards[i].mutex);
+		cost += _shards[i].cost;
+	}
+	return cost;
+}
+
+int StoreCache::size() const
+{
+	auto size = 0;
+	for(auto i = 0; i < ShardCount; i++) {
+		QMutexLocker _(&_shards[i].mutex);
+		size += _shards[i].nodes.size();
+	}
+	return size;
+}
+
+StoreCache::Statistics StoreCache::statistics(const QByteArray &typeName) const
+{
+	Statistics result;
+	for(auto i = 0; i < ShardCount; i++) {
+		QMutexLocker _(&_shards[i].mutex);
+		const auto stats = _shards[i].stats.value(typeName);
+		result.hits += stats.hits;
+		result.misses += stats.misses;
+		result.evictions += stats.evictions;
+		result.cost += stats.cost;
+		result.entries += stats.entries;
+	}
+	return result;
+}
+
+bool StoreCache::lookup(const ObjectKey &key, QJsonObject &data, MissingState *missing)
+{
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	auto node = shard.nodes.value(key, nullptr);
+	if(!node) {
+		shard.stats[key.typeName].misses++;
+		return false;
+	}
+
+	//move to the front, which is why even reads need the exclusive shard lock
+	if(node != shard.first) {
+		shard.unlink(node);
+		shard.pushFront(node);
+	}
+	shard.stats[key.typeName].hits++;
+	if(missing)
+		*missing = node->missing;
+	if(node->missing != NotMissing)
+		return false;
+	data = node->data;
+	return true;
+}
+
+bool StoreCache::contains(const ObjectKey &key) const
+{
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	auto node = shard.nodes.value(key, nullptr);
+	return node && node->missing == NotMissing;
+}
+
+void StoreCache::insert(const ObjectKey &key, const QJsonObject &data, bool scan)
+{
+	//calculate the costs before locking, as it has to walk the whole object
+	const auto nodeCost = static_cast<int>(sizeof(Node)) +
+						  key.typeName.size() +
+						  key.id.size() * 2 +
+						  cost(data);
+
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	shard.generation++;
+	auto node = shard.nodes.value(key, nullptr);
+	if(scan) {
+		//scans must not displace the working set: keep existing entries where they are and only
+		//admit new ones into free space, as the first candidates for eviction
+		if(node && node->missing == NotMissing)
+			return;
+		if(node)
+			shard.removeNode(node);
+		if(shard.cost + nodeCost > _shardMaxCost)
+			return;
+	} else if(node)
+		shard.removeNode(node);
+	if(nodeCost > _shardMaxCost) //too big to be cached at all
+		return;
+
+	shard.addNode(new Node{key, data, {}, nodeCost}, !scan);
+	shard.trim(_shardMaxCost);
+}
+
+bool StoreCache::remove(const ObjectKey &key)
+{
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	//even without an entry, a pending insertMissing for the key must fail
+	shard.generation++;
+	auto node = shard.nodes.value(key, nullptr);
+	if(!node)
+		return false;
+	shard.removeNode(node);
+	return true;
+}
+
+void StoreCache::remove(const QByteArray &typeName, const QStringList &ids)
+{
+	for(const auto &id : ids)
+		remove({typeName, id});
+}
+
+void StoreCache::clear()
+{
+	for(auto i = 0; i < ShardCount; i++) {
+		QMutexLocker _(&_shards[i].mutex);
+		_shards[i].generation++;
+		_shards[i].clear();
+	}
+}
+
+quint64 StoreCache::generation(const ObjectKey &key) const
+{
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	return shard.generation;
+}
+
+void StoreCache::insertMissing(const ObjectKey &key, MissingState state, quint64 generation)
+{
+	Q_ASSERT(state != NotMissing);
+	const auto nodeCost = static_cast<int>(sizeof(Node)) +
+						  key.typeName.size() +
+						  key.id.size() * 2;
+
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	//the key may have been stored or invalidated since the generation was taken
+	if(shard.generation != generation || shard.nodes.contains(key))
+		return;
+	if(nodeCost > _shardMaxCost)
+		return;
+
+	auto node = new Node{key, {}, {}, nodeCost};
+	node->missing = state;
+	shard.addNode(node, true);
+	shard.trim(_shardMaxCost);
+}
+
+bool StoreCache::lookupValue(const ObjectKey &key, int metaTypeId, QVariant &value)
+{
+	if(!_cacheValues)
+		return false;
+
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	auto node = shard.nodes.value(key, nullptr);
+	if(!node)
+		return false;
+	auto it = node->values.constFind(metaTypeId);
+	if(it == node->values.constEnd())
+		return false;
+
+	if(node != shard.first) {
+		shard.unlink(node);
+		shard.pushFront(node);
+	}
+	shard.stats[key.typeName].hits++;
+	value = *it;
+	return true;
+}
+
+void StoreCache::insertValue(const ObjectKey &key, const QJsonObject &source, int metaTypeId, const QVariant &value)
+{
+	if(!_cacheValues || !isValueCacheable(metaTypeId))
+		return;
+
+	//the deserialized value is assumed to need about as much memory as the json it was created from
+	const auto valueCost = cost(source);
+
+	auto &shard = this->shard(key);
+	QMutexLocker _(&shard.mutex);
+	auto node = shard.nodes.value(key, nullptr);
+	//only attach to the data the value was created from, it might have been replaced in the meantime
+	if(!node || node->missing != NotMissing || node->values.contains(metaTypeId) || node->data != source)
+		return;
+
+	node->values.insert(metaTypeId, value);
+	node->cost += valueCost;
+	shard.cost += valueCost;
+	shard.stats[key.typeName].cost += valueCost;
+	shard.trim(_shardMaxCost);
+}
+
+bool StoreCache::isValueCacheable(int metaTypeId)
+{
+	//objects are owned by the caller, so every load must create a new one
+	const auto flags = QMetaType::typeFlags(metaTypeId);
+	return !flags.testFlag(QMetaType::PointerToQObject) &&
+			!flags.testFlag(QMetaType::SharedPointerToQObject) &&
+			!flags.testFlag(QMetaType::WeakPointerToQObject) &&
+			!flags.testFlag(QMetaType::TrackingPointerToQObject);
+}
+
+int StoreCache::cost(const QJsonObject &data)
+{
+	auto cost = 32;
+	for(auto it = data.constBegin(); it != data.constEnd(); ++it)
+		cost += 16 + it.key().size() * 2 + StoreCache::cost(it.value());
+	return cost;
+}
+
+int StoreCache::cost(const QJsonValue &value)
+{
+	switch(value.type()) {
+	case QJsonValue::String:
+		return 16 + value.toString().size() * 2;
+	case QJsonValue::Array:
+	{
+		auto cost = 32;
+		for(const auto &element : value.toArray())
+			cost += 8 + StoreCache::cost(element);
+		return cost;
+	}
+	case QJsonValue::Object:
+		return cost(value.toObject());
+	default:
+		return 8;
+	}
+}
+
+StoreCache::Shard &StoreCache::shard(const ObjectKey &key) const
+{
+	return _shards[qHash(key) % ShardCount];
+}
+
+
+
+void StoreCache::Shard::unlink(Node *node)
+{
+	if(node->prev)
+		node->prev->next = node->next;
+	else
+		first = node->next;
+	if(node->next)
+		node->next->prev = node->prev;
+	else
+		last = node->prev;
+	node->prev = nullptr;
+	node->next = nullptr;
+}
+
+void StoreCache::Shard::pushFront(Node *node)
+{
+	node->next = first;
+	if(first)
+		first->prev = node;
+	first = node;
+	if(!last)
+		last = node;
+}
+
+void StoreCache::Shard::pushBack(Node *node)
+{
+	node->prev = last;
+	if(last)
+		last->next = node;
+	last = node;
+	if(!first)
+		first = node;
+}
+
+void StoreCache::Shard::addNode(Node *node, bool front)
+{
+	nodes.insert(node->key, node);
+	if(front)
+		pushFront(node);
+	else
+		pushBack(node);
+	cost += node->cost;
+	auto &typeStats = stats[node->key.typeName];
+	typeStats.cost += node->cost;
+	typeStats.entries++;
+}
+
+void StoreCache::Shard::removeNode(Node *node)
+{
+	unlink(node);
+	nodes.remove(node->key);
+	cost -= node->cost;
+	auto &typeStats = stats[node->key.typeName];
+	typeStats.cost -= node->cost;
+	typeStats.entries--;
+	delete node;
+}
+
+void StoreCache::Shard::trim(int maxCost)
+{
+	while(cost > maxCost && last) {
+		stats[last->key.typeName].evictions++;
+		removeNode(last);
+	}
+}
+
+void StoreCache::Shard::clear()
+{
+	qDeleteAll(nodes);
+	nodes.clear();
+	first = nullptr;
+	last = nullptr;
+	cost = 0;
+	//keep the counters, only the resident data is gone
+	for(auto &typeStats : stats) {
+		typeStats.cost = 0;
+		typeStats.entries = 0;
+	}
+}
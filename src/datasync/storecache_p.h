@@ -0,0 +1,103 @@
+#ifndef QTDATASYNC_STORECACHE_P_H
+#define QTDATASYNC_STORECACHE_P_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonValue>
+#include <QtCore/QVariant>
+
+#include "qtdatasync_global.h"
+#include "objectkey.h"
+
+namespace QtDataSync {
+
+//export needed for tests
+class Q_DATASYNC_EXPORT StoreCache
+{
+	Q_DISABLE_COPY(StoreCache)
+
+public:
+	enum MissingState {
+		NotMissing,
+		Deleted, //the dataset exists, but without data
+		NoEntry //the dataset does not exist at all
+	};
+
+	struct Statistics {
+		quint64 hits = 0;
+		quint64 misses = 0;
+		quint64 evictions = 0;
+		qint64 cost = 0;
+		int entries = 0;
+	};
+
+	static const int ShardCount;
+
+	explicit StoreCache(int maxCost, bool cacheValues = false);
+	~StoreCache();
+
+	int maxCost() const;
+	bool cachesValues() const;
+	int totalCost() const;
+	int size() const;
+	Statistics statistics(const QByteArray &typeName) const;
+
+	bool lookup(const ObjectKey &key, QJsonObject &data, MissingState *missing = nullptr);
+	bool contains(const ObjectKey &key) const;
+	void insert(const ObjectKey &key, const QJsonObject &data, bool scan = false);
+	bool remove(const ObjectKey &key);
+	void remove(const QByteArray &typeName, const QStringList &ids);
+	void clear();
+
+	quint64 generation(const ObjectKey &key) const;
+	void insertMissing(const ObjectKey &key, MissingState state, quint64 generation);
+
+	bool lookupValue(const ObjectKey &key, int metaTypeId, QVariant &value);
+	void insertValue(const ObjectKey &key, const QJsonObject &source, int metaTypeId, const QVariant &value);
+	static bool isValueCacheable(int metaTypeId);
+
+	static int cost(const QJsonObject &data);
+	static int cost(const QJsonValue &value);
+
+private:
+	struct Node {
+		ObjectKey key;
+		QJsonObject data;
+		QHash<int, QVariant> values; //deserialized data, per metatype
+		int cost;
+		MissingState missing = NotMissing;
+		Node *prev = nullptr;
+		Node *next = nullptr;
+	};
+
+	//every shard is an independent lru list, so only threads using the same shard block each other
+	struct Shard {
+		mutable QMutex mutex;
+		QHash<ObjectKey, Node*> nodes;
+		Node *first = nullptr; //most recently used
+		Node *last = nullptr; //least recently used
+		int cost = 0;
+		quint64 generation = 0; //changes with every modification of the shard
+		QHash<QByteArray, Statistics> stats;
+
+		void unlink(Node *node);
+		void pushFront(Node *node);
+		void pushBack(Node *node);
+		void addNode(Node *node, bool front);
+		void removeNode(Node *node);
+		void trim(int maxCost);
+		void clear();
+	};
+
+	const int _maxCost;
+	const int _shardMaxCost;
+	const bool _cacheValues;
+	Shard *_shards;
+
+	Shard &shard(const ObjectKey &key) const;
+};
+
+}
+
+#endif // QTDATASYNC_STORECACHE_P_H
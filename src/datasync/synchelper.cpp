@@ -5,6 +5,8 @@
 #include <QtCore/QLocale>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonArray>
+#include <QtCore/QCborMap>
+#include <QtCore/QCborStreamReader>
 
 #include "message_p.h"
 
@@ -15,6 +17,19 @@ using std::make_tuple;
 
 namespace {
 void hashNext(QCryptographicHash &hash, const QJsonValue &value);
+
+//cbor data is prefixed with a magic and a format version (text json always starts with "{", binary json with "qbjs")
+const QByteArray CborMagic = QByteArrayLiteral("qdsc");
+const char CborFormatVersion = 1;
+const int CborHeaderSize = 5;
+
+//rejects data written by a newer format version
+bool isSupportedCbor(const QByteArray &data)
+{
+	return data.size() >= CborHeaderSize &&
+			SyncHelper::isCbor(data) &&
+			data[CborMagic.size()] == CborFormatVersion;
+}
 }
 
 QByteArray SyncHelper::jsonHash(const QJsonObject &object)
@@ -24,7 +39,77 @@ QByteArray SyncHelper::jsonHash(const QJsonObject &object)
 	return hash.result();
 }
 
-QByteArray SyncHelper::combine(const ObjectKey &key, quint64 version, const QJsonObject &data)
+QByteArray SyncHelper::encodeCbor(const QJsonObject &data)
+{
+	return CborMagic + CborFormatVersion + QCborMap::fromJsonObject(data).toCborValue().toCbor();
+}
+
+bool SyncHelper::isCbor(const QByteArray &data)
+{
+	return data.startsWith(CborMagic);
+}
+
+QJsonObject SyncHelper::decodeCbor(const QByteArray &data, bool *ok)
+{
+	if(ok)
+		*ok = false;
+	if(!isSupportedCbor(data))
+		return {};
+
+	QCborParserError error;
+	auto value = QCborValue::fromCbor(data.constData() + CborHeaderSize,
+									  data.size() - CborHeaderSize,
+									  &error);
+	if(error.error != QCborError::NoError || !value.isMap())
+		return {};
+
+	if(ok)
+		*ok = true;
+	return value.toMap().toJsonObject();
+}
+
+QJsonObject SyncHelper::decodeCborProperties(const QByteArray &data, const QStringList &properties, bool *ok)
+{
+	if(ok)
+		*ok = false;
+	if(!isSupportedCbor(data))
+		return {};
+
+	//only decode the requested values and skip over all others
+	QCborStreamReader reader(data.constData() + CborHeaderSize, data.size() - CborHeaderSize);
+	if(!reader.isMap() || !reader.enterContainer())
+		return {};
+
+	QJsonObject result;
+	while(reader.lastError() == QCborError::NoError && reader.hasNext()) {
+		//keys are always strings, as the data was created from a json object
+		if(!reader.isString())
+			return {};
+		QString key;
+		auto chunk = reader.readString();
+		while(chunk.status == QCborStreamReader::Ok) {
+			key += chunk.data;
+			chunk = reader.readString();
+		}
+		if(chunk.status == QCborStreamReader::Error)
+			return {};
+
+		if(properties.contains(key)) {
+			result.insert(key, QCborValue::fromCbor(reader).toJsonValue());
+			if(result.size() == properties.size())
+				break;
+		} else if(!reader.next())
+			return {};
+	}
+	if(reader.lastError() != QCborError::NoError)
+		return {};
+
+	if(ok)
+		*ok = true;
+	return result;
+}
+
+QByteArray SyncHelper::combine(const ObjectKey &key, quint64 version, const QJsonObject &data, PayloadFormat format)
 {
 	QByteArray out;
 	QDataStream stream(&out, QIODevice::WriteOnly | QIODevice::Unbuffered);
@@ -32,7 +117,9 @@ QByteArray SyncHelper::combine(const ObjectKey &key, quint64 version, const QJso
 
 	stream << key
 		   << version
-		   << QJsonDocument(data).toJson(QJsonDocument::Compact);
+		   << (format == CborPayload ?
+				   encodeCbor(data) :
+				   QJsonDocument(data).toJson(QJsonDocument::Compact));
 
 	if(stream.status() != QDataStream::Ok)
 		throw DataStreamException(stream);
@@ -71,7 +158,14 @@ tuple<bool, ObjectKey, quint64, QJsonObject> SyncHelper::extract(const QByteArra
 	QJsonObject obj;
 	if(jData.isNull())
 		stream.commitTransaction();
-	else {
+	else if(isCbor(jData)) {
+		auto ok = false;
+		obj = decodeCbor(jData, &ok);
+		if(ok)
+			stream.commitTransaction();
+		else
+			stream.abortTransaction();
+	} else {
 		QJsonParseError error;
 		auto doc = QJsonDocument::fromJson(jData, &error);
 		if(error.error != QJsonParseError::NoError || !doc.isObject())
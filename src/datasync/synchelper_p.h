@@ -4,6 +4,7 @@
 #include <tuple>
 
 #include <QtCore/QJsonObject>
+#include <QtCore/QStringList>
 
 #include "qtdatasync_global.h"
 #include "objectkey.h"
@@ -15,7 +16,17 @@ namespace SyncHelper {
 //exports are needed for tests
 Q_DATASYNC_EXPORT QByteArray jsonHash(const QJsonObject &object);
 
-Q_DATASYNC_EXPORT QByteArray combine(const ObjectKey &key, quint64 version, const QJsonObject &data);
+enum PayloadFormat {
+	JsonPayload, //text json, understood by all protocol versions
+	CborPayload //versioned cbor, requires all devices of the account to support it
+};
+
+Q_DATASYNC_EXPORT QByteArray encodeCbor(const QJsonObject &data);
+Q_DATASYNC_EXPORT bool isCbor(const QByteArray &data);
+Q_DATASYNC_EXPORT QJsonObject decodeCbor(const QByteArray &data, bool *ok = nullptr);
+Q_DATASYNC_EXPORT QJsonObject decodeCborProperties(const QByteArray &data, const QStringList &properties, bool *ok = nullptr);
+
+Q_DATASYNC_EXPORT QByteArray combine(const ObjectKey &key, quint64 version, const QJsonObject &data, PayloadFormat format = JsonPayload);
 Q_DATASYNC_EXPORT QByteArray combine(const ObjectKey &key, quint64 version);
 Q_DATASYNC_EXPORT std::tuple<bool, ObjectKey, quint64, QJsonObject> extract(const QByteArray &data); // (deleted, key, version, data)
 
@@ -112,6 +112,18 @@ QVariantList QQmlDataStore::search(const QString &typeName, const QString &query
 	}
 }
 
+DataCursor *QQmlDataStore::cursor(const QString &typeName) const
+{
+	try {
+		auto cursor = DataStore::cursor(QMetaType::type(typeName.toUtf8()));
+		QQmlEngine::setObjectOwnership(cursor, QQmlEngine::JavaScriptOwnership);
+		return cursor;
+	} catch(Exception &e) {
+		qmlWarning(this) << e.what();
+		return nullptr;
+	}
+}
+
 void QQmlDataStore::clear(const QString &typeName)
 {
 	try {
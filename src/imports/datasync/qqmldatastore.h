@@ -144,6 +144,14 @@ public:
 	 * @sa ::QtDataSync::DataStore::search(int, const QString &, DataStore::SearchMode) const
 	 */
 	Q_INVOKABLE QVariantList search(const QString &typeName, const QString &query, DataStore::SearchMode mode = DataStore::RegexpMode) const;
+	/*! @brief @copybrief ::QtDataSync::DataStore::cursor(QObject *) const
+	 *
+	 * @param typeName The QMetaType type name of the type
+	 * @returns A new cursor positioned before the first dataset, owned by the javascript engine
+	 *
+	 * @sa ::QtDataSync::DataStore::cursor(int, QObject *) const
+	 */
+	Q_INVOKABLE QtDataSync::DataCursor *cursor(const QString &typeName) const;
 	/*! @brief @copybrief ::QtDataSync::DataStore::clear()
 	 *
 	 * @param typeName The QMetaType type name of the type
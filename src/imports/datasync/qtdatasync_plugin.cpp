@@ -68,6 +68,7 @@ void QtDataSyncDeclarativeModule::registerTypes(const char *uri)
 
 	//Version 4.3
 	qmlRegisterModule(uri, 4, 3);
+	qmlRegisterUncreatableType<QtDataSync::DataCursor>(uri, 4, 3, "DataCursor", QStringLiteral("Use DataStore.cursor to create DataCursors"));
 
 	// Check to make shure no module update is forgotten
 	static_assert(VERSION_MAJOR == 4 && VERSION_MINOR == 3, "QML module version needs to be updated");
@@ -0,0 +1,18 @@
+#include "capabilitiesmessage_p.h"
+using namespace QtDataSync;
+
+const QVersionNumber CapabilitiesMessage::IntroducedVersion(2);
+
+CapabilitiesMessage::CapabilitiesMessage(QVersionNumber accountVersion) :
+	accountVersion{std::move(accountVersion)}
+{}
+
+bool CapabilitiesMessage::hasCborPayloads() const
+{
+	return accountVersion >= IntroducedVersion;
+}
+
+const QMetaObject *CapabilitiesMessage::getMetaObject() const
+{
+	return &staticMetaObject;
+}
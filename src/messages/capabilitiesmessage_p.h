@@ -0,0 +1,35 @@
+#ifndef QTDATASYNC_CAPABILITIESMESSAGE_P_H
+#define QTDATASYNC_CAPABILITIESMESSAGE_P_H
+
+#include <QtCore/QVersionNumber>
+
+#include "message_p.h"
+
+namespace QtDataSync {
+
+class Q_DATASYNC_EXPORT CapabilitiesMessage : public Message
+{
+	Q_GADGET
+
+	Q_PROPERTY(QVersionNumber accountVersion MEMBER accountVersion)
+
+public:
+	//the first protocol version that knows this message and cbor encoded payloads
+	static const QVersionNumber IntroducedVersion;
+
+	CapabilitiesMessage(QVersionNumber accountVersion = {});
+
+	//the lowest protocol version of all devices of the account
+	QVersionNumber accountVersion;
+
+	bool hasCborPayloads() const;
+
+protected:
+	const QMetaObject *getMetaObject() const override;
+};
+
+}
+
+Q_DECLARE_METATYPE(QtDataSync::CapabilitiesMessage)
+
+#endif // QTDATASYNC_CAPABILITIESMESSAGE_P_H
@@ -27,7 +27,8 @@ HEADERS += \
 	macupdatemessage_p.h \
 	keychangemessage_p.h \
 	devicekeysmessage_p.h \
-	newkeymessage_p.h
+	newkeymessage_p.h \
+	capabilitiesmessage_p.h
 
 SOURCES += \
 	message.cpp \
@@ -50,7 +51,8 @@ SOURCES += \
 	macupdatemessage.cpp \
 	keychangemessage.cpp \
 	devicekeysmessage.cpp \
-	newkeymessage.cpp
+	newkeymessage.cpp \
+	capabilitiesmessage.cpp
 
 DISTFILES += \
 	messages.pri
@@ -0,0 +1,6 @@
+include(../tests.pri)
+
+TARGET = tst_bench_datastoremodel
+
+SOURCES += \
+		tst_bench_datastoremodel.cpp
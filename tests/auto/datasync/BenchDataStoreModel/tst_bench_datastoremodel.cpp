@@ -0,0 +1,87 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <testlib.h>
+using namespace QtDataSync;
+
+class BenchDataStoreModel : public QObject
+{
+	Q_OBJECT
+
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void benchData_data();
+	void benchData();
+
+private:
+	static const int DataCount = 1000;
+	static const int ColumnCount = 50;
+	DataStore *store = nullptr;
+};
+
+void BenchDataStoreModel::initTestCase()
+{
+	try {
+		TestLib::init();
+		Setup setup;
+		TestLib::setup(setup);
+		setup.create();
+
+		store = new DataStore(this);
+		store->saveAll(TestLib::generateData(0, DataCount - 1));
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchDataStoreModel::cleanupTestCase()
+{
+	delete store;
+	store = nullptr;
+	Setup::removeSetup(DefaultSetup, true);
+}
+
+void BenchDataStoreModel::benchData_data()
+{
+	QTest::addColumn<bool>("projected");
+
+	QTest::newRow("objects") << false;
+	QTest::newRow("projected") << true;
+}
+
+void BenchDataStoreModel::benchData()
+{
+	QFETCH(bool, projected);
+
+	try {
+		DataStoreModel model{store};
+		model.setProjected(projected);
+		model.setTypeId<TestData>();
+		//a wide table, as presented by a table view
+		for(auto i = 0; i < ColumnCount; i++)
+			model.addColumn(QString::number(i), i % 2 == 0 ? "id" : "text");
+
+		while(model.canFetchMore({})) {
+			const auto rows = model.rowCount();
+			model.fetchMore({});
+			QTRY_VERIFY(model.rowCount() > rows);
+		}
+		QCOMPARE(model.rowCount(), DataCount);
+
+		//read every cell once per iteration, as a view repainting the whole table would
+		QBENCHMARK {
+			for(auto row = 0; row < DataCount; row++) {
+				for(auto column = 0; column < ColumnCount; column++)
+					model.data(model.index(row, column));
+			}
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+QTEST_MAIN(BenchDataStoreModel)
+
+#include "tst_bench_datastoremodel.moc"
@@ -0,0 +1,8 @@
+include(../tests.pri)
+
+QT       += concurrent
+
+TARGET = tst_bench_localstore
+
+SOURCES += \
+		tst_bench_localstore.cpp
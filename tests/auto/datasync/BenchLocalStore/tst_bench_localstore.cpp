@@ -0,0 +1,259 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <QtSql/QSqlQuery>
+#include <QtConcurrent>
+#include <testlib.h>
+#include <QtDataSync/private/localstore_p.h>
+#include <QtDataSync/private/defaults_p.h>
+#include <QtDataSync/private/storecache_p.h>
+using namespace QtDataSync;
+
+class BenchLocalStore : public QObject
+{
+	Q_OBJECT
+
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void benchPrepare_data();
+	void benchPrepare();
+	void benchCount();
+	void benchContains();
+	void benchLoad();
+	void benchSave();
+	void benchLoadChangeInfo();
+	void benchPayload_data();
+	void benchPayload();
+	void benchCacheContention_data();
+	void benchCacheContention();
+
+private:
+	static const int DataCount = 1000;
+	static const QByteArray PlainType;
+	static const QByteArray CompressedType;
+	LocalStore *store = nullptr;
+	int index = 0;
+
+	ObjectKey nextKey();
+	static QJsonObject generatePayload(int index);
+};
+
+const QByteArray BenchLocalStore::PlainType = "PlainPayload";
+const QByteArray BenchLocalStore::CompressedType = "CompressedPayload";
+
+void BenchLocalStore::initTestCase()
+{
+	try {
+		TestLib::init();
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setCacheSize(0) //measure the database, not the cache
+				.setStorageMode(Setup::StorageMode::Inline)
+				.setCompressionLevel(CompressedType, 6);
+		setup.create();
+
+		store = new LocalStore(DefaultsPrivate::obtainDefaults(DefaultSetup), this);
+		QHash<QString, QJsonObject> data;
+		for(auto i = 0; i < DataCount; i++)
+			data.insert(TestLib::generateDataKey(i), TestLib::generateDataJson(i));
+		store->saveAll(TestLib::TypeName, data);
+
+		QHash<QString, QJsonObject> payloads;
+		for(auto i = 0; i < DataCount; i++)
+			payloads.insert(QString::number(i), generatePayload(i));
+		store->saveAll(PlainType, payloads);
+		store->saveAll(CompressedType, payloads);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::cleanupTestCase()
+{
+	delete store;
+	store = nullptr;
+	Setup::removeSetup(DefaultSetup, true);
+}
+
+void BenchLocalStore::benchPrepare_data()
+{
+	QTest::addColumn<bool>("cached");
+
+	QTest::newRow("prepared") << false;
+	QTest::newRow("cached") << true;
+}
+
+void BenchLocalStore::benchPrepare()
+{
+	QFETCH(bool, cached);
+
+	const auto statement = QStringLiteral("SELECT Version, File FROM DataIndex WHERE Type = ? AND Id = ?");
+	auto database = Defaults{DefaultsPrivate::obtainDefaults(DefaultSetup)}.aquireDatabase(this);
+	QBENCHMARK {
+		auto key = nextKey();
+		auto query = cached ?
+						 database.cachedQuery(statement) :
+						 QSqlQuery{database.database()};
+		if(!cached)
+			QVERIFY(query.prepare(statement));
+		query.addBindValue(key.typeName);
+		query.addBindValue(key.id);
+		QVERIFY(query.exec());
+		QVERIFY(query.first());
+		query.finish();
+	}
+}
+
+void BenchLocalStore::benchCount()
+{
+	try {
+		QBENCHMARK {
+			QCOMPARE(store->count(TestLib::TypeName), static_cast<quint64>(DataCount));
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::benchContains()
+{
+	try {
+		QBENCHMARK {
+			QVERIFY(store->contains(nextKey()));
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::benchLoad()
+{
+	try {
+		QBENCHMARK {
+			store->load(nextKey());
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::benchSave()
+{
+	try {
+		QBENCHMARK {
+			auto key = nextKey();
+			store->save(key, TestLib::generateDataJson(key.id.toInt(), QStringLiteral("bench")));
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::benchLoadChangeInfo()
+{
+	try {
+		QBENCHMARK {
+			auto scope = store->startSync(nextKey());
+			store->loadChangeInfo(scope);
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::benchPayload_data()
+{
+	QTest::addColumn<QByteArray>("typeName");
+
+	QTest::newRow("plain") << PlainType;
+	QTest::newRow("compressed") << CompressedType;
+}
+
+void BenchLocalStore::benchPayload()
+{
+	QFETCH(QByteArray, typeName);
+
+	//disk footprint of the payloads
+	auto database = Defaults{DefaultsPrivate::obtainDefaults(DefaultSetup)}.aquireDatabase(this);
+	QSqlQuery sizeQuery{database.database()};
+	QVERIFY(sizeQuery.prepare(QStringLiteral("SELECT Sum(Length(Data)) FROM DataIndex WHERE Type = ?")));
+	sizeQuery.addBindValue(typeName);
+	QVERIFY(sizeQuery.exec());
+	QVERIFY(sizeQuery.first());
+	qInfo() << "Payload size of" << DataCount << "datasets:" << sizeQuery.value(0).toLongLong() << "bytes";
+	sizeQuery.finish();
+
+	//read latency
+	try {
+		QBENCHMARK {
+			store->load({typeName, QString::number(nextKey().id.toInt())});
+		}
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void BenchLocalStore::benchCacheContention_data()
+{
+	QTest::addColumn<int>("threads");
+
+	QTest::newRow("1") << 1;
+	QTest::newRow("2") << 2;
+	QTest::newRow("4") << 4;
+	QTest::newRow("8") << 8;
+}
+
+void BenchLocalStore::benchCacheContention()
+{
+	QFETCH(int, threads);
+	const auto lookupCount = 10000;
+
+	StoreCache cache{100 * 1024 * 1024};
+	for(auto i = 0; i < DataCount; i++)
+		cache.insert(TestLib::generateKey(i), TestLib::generateDataJson(i));
+
+	//every thread performs the same number of lookups, so ideal scaling keeps the time constant
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+	QBENCHMARK {
+		QList<QFuture<void>> futures;
+		for(auto t = 0; t < threads; t++) {
+			futures.append(QtConcurrent::run(&pool, [&cache, t](){
+				QJsonObject data;
+				for(auto i = 0; i < lookupCount; i++)
+					cache.lookup(TestLib::generateKey((t * 97 + i) % DataCount), data);
+			}));
+		}
+		for(auto &future : futures)
+			future.waitForFinished();
+	}
+}
+
+ObjectKey BenchLocalStore::nextKey()
+{
+	index = (index + 1) % DataCount;
+	return TestLib::generateKey(index);
+}
+
+QJsonObject BenchLocalStore::generatePayload(int index)
+{
+	//repetitive data, as typically produced by serialized objects
+	QJsonArray entries;
+	for(auto i = 0; i < 20; i++) {
+		entries.append(QJsonObject {
+			{QStringLiteral("id"), index * 100 + i},
+			{QStringLiteral("title"), QStringLiteral("Entry %1 of dataset %2").arg(i).arg(index)},
+			{QStringLiteral("done"), i % 3 == 0},
+			{QStringLiteral("tags"), QJsonArray{QStringLiteral("bench"), QStringLiteral("payload")}}
+		});
+	}
+	auto data = TestLib::generateDataJson(index);
+	data[QStringLiteral("entries")] = entries;
+	return data;
+}
+
+QTEST_MAIN(BenchLocalStore)
+
+#include "tst_bench_localstore.moc"
@@ -31,6 +31,7 @@
 #include <QtDataSync/private/newkeymessage_p.h>
 #include <QtDataSync/private/devicesmessage_p.h>
 #include <QtDataSync/private/removemessage_p.h>
+#include <QtDataSync/private/capabilitiesmessage_p.h>
 
 using namespace QtDataSync;
 
@@ -80,6 +81,7 @@ private Q_SLOTS:
 	void testKeyChangeNoAck();
 
 	void testListAndRemoveDevices();
+	void testMixedVersionAccount();
 
 	void testUnexpectedMessage_data();
 	void testUnexpectedMessage();
@@ -110,6 +112,7 @@ private:
 
 	void clean(bool disconnect = true);
 	void clean(MockClient *&client, bool disconnect = true);
+	bool waitForCapabilities(MockClient *client, const QVersionNumber &accountVersion = InitMessage::CurrentVersion);
 
 	template <typename TMessage, typename... Args>
 	inline QSharedPointer<Message> create(Args... args);
@@ -308,6 +311,7 @@ void TestAppServer::testRegister()
 						   }, crypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(client));
 		QVERIFY(client->waitForReply<AccountMessage>([&](AccountMessage message, bool &ok) {
 			devId = message.deviceId;
 			ok = true;
@@ -436,6 +440,7 @@ void TestAppServer::testLogin()
 						   }, crypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(client));
 		QVERIFY(client->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
 			QVERIFY(!message.hasChanges);
 			QCOMPARE(message.keyIndex, 0u);
@@ -526,6 +531,7 @@ void TestAppServer::testAddDevice(MockClient *&partner, QUuid &partnerDevId, boo
 		}));
 
 		//wait for granted
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<GrantMessage>([&](GrantMessage message, bool &ok) {
 			QCOMPARE(message.deviceId, partnerDevId);
 			QCOMPARE(message.index, keyIndex);
@@ -849,6 +855,7 @@ void TestAppServer::testAddDeviceInvalidKeyIndex()
 		}));
 
 		//wait for granted
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<GrantMessage>([&](GrantMessage message, bool &ok) {
 			QCOMPARE(message.deviceId, partnerDevId);
 			QCOMPARE(message.index, keyIndex);
@@ -943,6 +950,7 @@ void TestAppServer::testSendDoubleAccept()
 		}));
 
 		//wait for granted
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<GrantMessage>([&](GrantMessage message, bool &ok) {
 			QCOMPARE(message.deviceId, partnerDevId);
 			QCOMPARE(message.index, keyIndex);
@@ -1051,6 +1059,7 @@ void TestAppServer::testChangeDownloadOnLogin()
 						   }, partnerCrypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
 			QVERIFY(message.hasChanges);//Must have changes now
 			QCOMPARE(message.keyIndex, 0u);
@@ -1286,6 +1295,7 @@ void TestAppServer::testChangeKey()
 						   }, partnerCrypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
 			QVERIFY(!message.hasChanges);//Must have changes now
 			QCOMPARE(message.keyIndex, nextIndex);
@@ -1323,6 +1333,7 @@ void TestAppServer::testChangeKey()
 						   }, partnerCrypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
 			QVERIFY(!message.hasChanges);//Must have changes now
 			QCOMPARE(message.keyIndex, 0u);
@@ -1524,6 +1535,7 @@ void TestAppServer::testKeyChangeNoAck()
 						   }, partnerCrypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
 			QVERIFY(!message.hasChanges);//Must have changes now
 			QCOMPARE(message.keyIndex, nextIndex);
@@ -1554,6 +1566,7 @@ void TestAppServer::testKeyChangeNoAck()
 						   }, partnerCrypto);
 
 		//wait for the account message
+		QVERIFY(waitForCapabilities(partner));
 		QVERIFY(partner->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
 			QVERIFY(!message.hasChanges);//Must have changes now
 			QCOMPARE(message.keyIndex, nextIndex);
@@ -1654,6 +1667,124 @@ void TestAppServer::testListAndRemoveDevices()
 	}
 }
 
+void TestAppServer::testMixedVersionAccount()
+{
+	const QVersionNumber legacyVersion{1};
+	QByteArray pNonce = "legacy_nonce";
+	quint32 keyIndex = 0;
+	QByteArray keyScheme = "keyScheme";
+	QByteArray keySecret = "keySecret";
+
+	try {
+		QVERIFY(client);
+		QVERIFY(!partner);
+
+		//establish connection
+		partner = new MockClient(this);
+		QVERIFY(partner->waitForConnected());
+
+		//wait for identify message
+		QByteArray mNonce;
+		QVERIFY(partner->waitForReply<IdentifyMessage>([&](IdentifyMessage message, bool &ok) {
+			mNonce = message.nonce;
+			ok = true;
+		}));
+
+		//send an access message of a device that only knows the old protocol
+		AccessMessage accessMsg {
+			partnerName,
+			mNonce,
+			partnerCrypto->signKey(),
+			partnerCrypto->cryptKey(),
+			partnerCrypto,
+			pNonce,
+			devId,
+			"macscheme",
+			"cmac",
+			"trustmac"
+		};
+		accessMsg.protocolVersion = legacyVersion;
+		partner->sendSigned(accessMsg, partnerCrypto);
+
+		//wait for proof message on client
+		QUuid legacyDevId;
+		QVERIFY(client->waitForReply<ProofMessage>([&](ProofMessage message, bool &ok) {
+			QCOMPARE(message.pNonce, pNonce);
+			legacyDevId = message.deviceId;
+			ok = true;
+		}));
+
+		//accept the proof
+		AcceptMessage accMsg { legacyDevId };
+		accMsg.index = keyIndex;
+		accMsg.scheme = keyScheme;
+		accMsg.secret = keySecret;
+		client->sendSigned(accMsg, crypto);
+
+		//client must be downgraded before it uploads the data for the new device
+		QVERIFY(waitForCapabilities(client, legacyVersion));
+		QVERIFY(client->waitForReply<AcceptAckMessage>([&](AcceptAckMessage message, bool &ok) {
+			QCOMPARE(message.deviceId, legacyDevId);
+			ok = true;
+		}));
+
+		//the old device does not know the capabilities message
+		QVERIFY(partner->waitForReply<GrantMessage>([&](GrantMessage message, bool &ok) {
+			QCOMPARE(message.deviceId, legacyDevId);
+			ok = true;
+		}));
+
+		//changes sent before the client confirmed the downgrade are dropped
+		ChangeMessage changeMsg { "cbor_data" };
+		changeMsg.keyIndex = keyIndex;
+		changeMsg.salt = "salt";
+		changeMsg.data = "data";
+		client->send(changeMsg);
+		client->send(CapabilitiesMessage{legacyVersion});
+		changeMsg.dataId = "json_data";
+		client->send(changeMsg);
+		QVERIFY(client->waitForReply<ChangeAckMessage>([&](ChangeAckMessage message, bool &ok) {
+			QCOMPARE(message.dataId, QByteArray("json_data"));
+			ok = true;
+		}));
+
+		//reconnect the old device with the current protocol
+		clean(partner);
+		partner = new MockClient(this);
+		QVERIFY(partner->waitForConnected());
+		QVERIFY(partner->waitForReply<IdentifyMessage>([&](IdentifyMessage message, bool &ok) {
+			mNonce = message.nonce;
+			ok = true;
+		}));
+		partner->sendSigned(LoginMessage {
+								legacyDevId,
+								partnerName,
+								mNonce
+							}, partnerCrypto);
+		QVERIFY(waitForCapabilities(partner));
+		QVERIFY(partner->waitForReply<WelcomeMessage>([&](WelcomeMessage message, bool &ok) {
+			Q_UNUSED(message)
+			ok = true;
+		}));
+
+		//client must be upgraded again, while staying connected
+		QVERIFY(waitForCapabilities(client));
+		client->send(CapabilitiesMessage{InitMessage::CurrentVersion});
+
+		//remove the device again
+		client->send(RemoveMessage {legacyDevId});
+		QVERIFY(client->waitForReply<RemoveAckMessage>([&](RemoveAckMessage message, bool &ok) {
+			QCOMPARE(message.deviceId, legacyDevId);
+			ok = true;
+		}));
+		QVERIFY(partner->waitForDisconnect());
+		partner->deleteLater();
+		partner = nullptr;
+	} catch(std::exception &e) {
+		QFAIL(e.what());
+	}
+}
+
 void TestAppServer::testUnexpectedMessage_data()
 {
 	QTest::addColumn<QSharedPointer<Message>>("message");
@@ -1702,6 +1833,9 @@ void TestAppServer::testUnexpectedMessage_data()
 	QTest::newRow("NewKeyMessage") << create<NewKeyMessage>()
 								   << false
 								   << true;
+	QTest::newRow("CapabilitiesMessage") << create<CapabilitiesMessage>()
+										 << false
+										 << false;
 }
 
 void TestAppServer::testUnexpectedMessage()
@@ -1843,6 +1977,14 @@ void TestAppServer::clean(MockClient *&client, bool disconnect)
 	client = nullptr;
 }
 
+bool TestAppServer::waitForCapabilities(MockClient *client, const QVersionNumber &accountVersion)
+{
+	return client->waitForReply<CapabilitiesMessage>([&](CapabilitiesMessage message, bool &ok) {
+		QCOMPARE(message.accountVersion, accountVersion);
+		ok = true;
+	});
+}
+
 template<typename TMessage, typename... Args>
 inline QSharedPointer<Message> TestAppServer::create(Args... args)
 {
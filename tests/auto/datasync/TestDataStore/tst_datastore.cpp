@@ -21,14 +21,19 @@ private Q_SLOTS:
 	void testContains();
 	void testFind();
 	void testIterate();
+	void testCursor();
+	void testLoadProperties();
 	void testRemove_data();
 	void testRemove();
 	void testClear();
+	void testBatch();
+	void testAsync();
 
 	void testUpdate();
 	void testUpdateInvalid();
 
 	void testChangeSignals();
+	void testCountSignals();
 
 private:
 	DataStore *store;
@@ -190,6 +195,56 @@ void TestDataStore::testIterate()
 	}
 }
 
+void TestDataStore::testCursor()
+{
+	try {
+		QScopedPointer<DataCursor> cursor{store->cursor<TestData>()};
+		QVERIFY(cursor);
+		QCOMPARE(cursor->typeId(), qMetaTypeId<TestData>());
+		QVERIFY(!cursor->isValid());
+		cursor->setChunkSize(2);
+		QCOMPARE(cursor->chunkSize(), 2);
+
+		QList<TestData> objects = TestLib::generateData(429, 432);
+		while(cursor->next()) {
+			QVERIFY(cursor->isValid());
+			QVERIFY(!objects.isEmpty());
+			auto data = objects.takeFirst();
+			QCOMPARE(cursor->key(), QString::number(data.id));
+			QCOMPARE(cursor->value().value<TestData>(), data);
+		}
+		QVERIFY(objects.isEmpty());
+		QVERIFY(!cursor->isValid());
+		QVERIFY(!cursor->next());
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataStore::testLoadProperties()
+{
+	try {
+		const auto data = TestLib::generateData(430);
+		auto values = store->loadProperties<TestData>(430, {QStringLiteral("text")});
+		QCOMPARE(values.size(), 1);
+		QCOMPARE(values.value(QStringLiteral("text")).toString(), data.text);
+
+		values = store->loadProperties<TestData>(430, {
+													 QStringLiteral("id"),
+													 QStringLiteral("text"),
+													 QStringLiteral("invalid")
+												 });
+		QCOMPARE(values.size(), 2);
+		QCOMPARE(values.value(QStringLiteral("id")).userType(), static_cast<int>(QMetaType::Int));
+		QCOMPARE(values.value(QStringLiteral("id")).toInt(), data.id);
+		QCOMPARE(values.value(QStringLiteral("text")).toString(), data.text);
+
+		QVERIFY_EXCEPTION_THROWN(store->loadProperties<TestData>(42, {QStringLiteral("text")}), NoDataException);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
 void TestDataStore::testRemove_data()
 {
 	QTest::addColumn<int>("key");
@@ -225,6 +280,71 @@ void TestDataStore::testClear()
 	}
 }
 
+void TestDataStore::testBatch()
+{
+	try {
+		QList<TestData> data {
+			TestLib::generateData(50),
+			TestLib::generateData(51),
+			TestLib::generateData(52)
+		};
+
+		QCOMPARE(store->count<TestData>(), 0ull);
+		store->saveAll(data);
+		QCOMPARE(store->count<TestData>(), 3ull);
+		QCOMPAREUNORDERED(store->loadAll<TestData>(), data);
+
+		data[1].text = QStringLiteral("Some other text");
+		store->saveAll(data.mid(1, 1));
+		QCOMPARE(store->count<TestData>(), 3ull);
+		QCOMPARE(store->load<TestData>(51), data[1]);
+
+		QCOMPARE(store->removeAll<TestData>(QList<int>{50, 51, 99}), 2);
+		QCOMPARE(store->count<TestData>(), 1ull);
+		QVERIFY_EXCEPTION_THROWN(store->load<TestData>(50), NoDataException);
+		QCOMPARE(store->load<TestData>(52), data[2]);
+
+		QCOMPARE(store->removeAll<TestData>(QStringList{QStringLiteral("52")}), 1);
+		QCOMPARE(store->count<TestData>(), 0ull);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataStore::testAsync()
+{
+	try {
+		auto data = TestLib::generateData(600);
+
+		//ordered per key
+		auto saveFuture = store->saveAsync(data);
+		auto loadFuture = store->loadAsync<TestData>(QString::number(data.id));
+		QCOMPARE(loadFuture.result(), data);
+		QVERIFY(saveFuture.isFinished());
+		QCOMPARE(store->countAsync<TestData>().result(), store->count<TestData>());
+		QVERIFY(store->loadAllAsync<TestData>().result().contains(data));
+
+		QVERIFY(store->removeAsync<TestData>(QString::number(data.id)).result());
+		auto failFuture = store->loadAsync<TestData>(QString::number(data.id));
+		QVERIFY_EXCEPTION_THROWN(failFuture.waitForFinished(), NoDataException);
+
+		//objects are moved to the calling thread
+		auto dataObj = new TestObject(this);
+		dataObj->id = 601;
+		dataObj->text = QStringLiteral("async");
+		store->saveAsync(dataObj).waitForFinished();
+		auto loadedObj = store->loadAsync<TestObject*>(QString::number(dataObj->id)).result();
+		QVERIFY(loadedObj);
+		QCOMPARE(loadedObj->thread(), thread());
+		QCOMPARE(loadedObj->text, dataObj->text);
+		loadedObj->deleteLater();
+		QVERIFY(store->removeAsync<TestObject*>(QString::number(dataObj->id)).result());
+		dataObj->deleteLater();
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
 void TestDataStore::testUpdate()
 {
 	auto dataObj = new TestObject(this);
@@ -342,6 +462,50 @@ void TestDataStore::testChangeSignals()
 	}
 }
 
+void TestDataStore::testCountSignals()
+{
+	const auto key = 78;
+	auto data = TestLib::generateData(78);
+
+	QSignalSpy countSpy(store, &DataStore::countChanged);
+	QSignalSpy changeSpy(store, &DataStore::dataChanged);
+	do //clear out any remaining signals
+		changeSpy.clear();
+	while(changeSpy.wait());
+	countSpy.clear();
+
+	try {
+		const auto count = store->count<TestData>();
+
+		store->save(data);
+		QCOMPARE(store->count<TestData>(), count + 1);
+		QCOMPARE(countSpy.size(), 1);
+		auto sig = countSpy.takeFirst();
+		QCOMPARE(sig[0].toInt(), qMetaTypeId<TestData>());
+		QCOMPARE(sig[1].toLongLong(), count + 1);
+
+		//updates do not change the count
+		data.text = QStringLiteral("Some other text");
+		store->save(data);
+		QCOMPARE(store->count<TestData>(), count + 1);
+		QCOMPARE(countSpy.size(), 0);
+
+		QVERIFY(store->remove<TestData>(key));
+		QCOMPARE(store->count<TestData>(), count);
+		QCOMPARE(countSpy.size(), 1);
+		sig = countSpy.takeFirst();
+		QCOMPARE(sig[0].toInt(), qMetaTypeId<TestData>());
+		QCOMPARE(sig[1].toLongLong(), count);
+
+		//removing again does not change anything
+		QVERIFY(!store->remove<TestData>(key));
+		QCOMPARE(store->count<TestData>(), count);
+		QCOMPARE(countSpy.size(), 0);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
 QTEST_MAIN(TestDataStore)
 
 #include "tst_datastore.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+
+TARGET = tst_datastoremodel
+
+SOURCES += \
+		tst_datastoremodel.cpp
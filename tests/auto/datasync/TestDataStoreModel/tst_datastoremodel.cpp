@@ -0,0 +1,340 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <testlib.h>
+#include <testobject.h>
+using namespace QtDataSync;
+
+class TestDataStoreModel : public QObject
+{
+	Q_OBJECT
+
+private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void testQueriedChanges();
+	void testBackgroundFetch();
+	void testWindow();
+	void testObjectWindow();
+
+private:
+	DataStore *store = nullptr;
+
+	static QStringList modelKeys(const DataStoreModel &model);
+	static bool fetchAll(DataStoreModel &model);
+};
+
+void TestDataStoreModel::initTestCase()
+{
+	try {
+		TestLib::init();
+		Setup setup;
+		TestLib::setup(setup)
+				.setIndexedProperties(TestLib::TypeName, {QStringLiteral("text")});
+		setup.create();
+
+		store = new DataStore(this);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataStoreModel::cleanupTestCase()
+{
+	delete store;
+	store = nullptr;
+	Setup::removeSetup(DefaultSetup, true);
+}
+
+void TestDataStoreModel::testQueriedChanges()
+{
+	try {
+		store->saveAll<TestData>({
+			{10, QStringLiteral("b")},
+			{11, QStringLiteral("d")},
+			{12, QStringLiteral("f")},
+			{13, QStringLiteral("h")},
+			{14, QStringLiteral("j")}
+		});
+
+		DataStoreModel model{store};
+		model.setTypeId<TestData>();
+		const auto textRole = model.roleNames().key("text");
+		model.setSortRole(textRole);
+		model.setFilterRole(textRole);
+		model.setFilterOperator(DataQuery::Less);
+		model.setFilterValue(QStringLiteral("m"));
+		while(model.canFetchMore({})) {
+			const auto rows = model.rowCount();
+			model.fetchMore({});
+			QTRY_VERIFY(model.rowCount() > rows);
+		}
+		QCOMPARE(modelKeys(model), TestLib::generateDataKeys(10, 14));
+
+		QSignalSpy movedSpy{&model, &DataStoreModel::rowsMoved};
+		QVERIFY(movedSpy.isValid());
+		QSignalSpy insertedSpy{&model, &DataStoreModel::rowsInserted};
+		QVERIFY(insertedSpy.isValid());
+		QSignalSpy removedSpy{&model, &DataStoreModel::rowsRemoved};
+		QVERIFY(removedSpy.isValid());
+
+		//changed sort value -> moves to the front
+		store->save<TestData>({14, QStringLiteral("a")});
+		QTRY_COMPARE(movedSpy.size(), 1);
+		auto args = movedSpy.takeFirst();
+		QCOMPARE(args[1].toInt(), 4);
+		QCOMPARE(args[2].toInt(), 4);
+		QCOMPARE(args[4].toInt(), 0);
+		QCOMPARE(modelKeys(model), (QStringList{
+			TestLib::generateDataKey(14),
+			TestLib::generateDataKey(10),
+			TestLib::generateDataKey(11),
+			TestLib::generateDataKey(12),
+			TestLib::generateDataKey(13)
+		}));
+		QTRY_COMPARE(model.data(model.index(0), textRole).toString(), QStringLiteral("a"));
+
+		//filtered out -> removed
+		store->save<TestData>({11, QStringLiteral("z")});
+		QTRY_COMPARE(removedSpy.size(), 1);
+		args = removedSpy.takeFirst();
+		QCOMPARE(args[1].toInt(), 2);
+		QCOMPARE(args[2].toInt(), 2);
+		QCOMPARE(modelKeys(model), (QStringList{
+			TestLib::generateDataKey(14),
+			TestLib::generateDataKey(10),
+			TestLib::generateDataKey(12),
+			TestLib::generateDataKey(13)
+		}));
+
+		//matches again -> inserted at its new position
+		store->save<TestData>({11, QStringLiteral("g")});
+		QTRY_COMPARE(insertedSpy.size(), 1);
+		args = insertedSpy.takeFirst();
+		QCOMPARE(args[1].toInt(), 3);
+		QCOMPARE(args[2].toInt(), 3);
+		QCOMPARE(modelKeys(model), (QStringList{
+			TestLib::generateDataKey(14),
+			TestLib::generateDataKey(10),
+			TestLib::generateDataKey(12),
+			TestLib::generateDataKey(11),
+			TestLib::generateDataKey(13)
+		}));
+		QCOMPARE(model.data(model.index(3), textRole).toString(), QStringLiteral("g"));
+
+		//new datasets are only inserted if they match
+		store->saveAll<TestData>({
+			{15, QStringLiteral("c")},
+			{16, QStringLiteral("y")}
+		});
+		QTRY_COMPARE(insertedSpy.size(), 1);
+		args = insertedSpy.takeFirst();
+		QCOMPARE(args[1].toInt(), 2);
+		QCOMPARE(args[2].toInt(), 2);
+		QCOMPARE(modelKeys(model), (QStringList{
+			TestLib::generateDataKey(14),
+			TestLib::generateDataKey(10),
+			TestLib::generateDataKey(15),
+			TestLib::generateDataKey(12),
+			TestLib::generateDataKey(11),
+			TestLib::generateDataKey(13)
+		}));
+
+		//removed datasets are removed as well
+		QVERIFY(store->remove<TestData>(10));
+		QTRY_COMPARE(removedSpy.size(), 1);
+		args = removedSpy.takeFirst();
+		QCOMPARE(args[1].toInt(), 1);
+		QCOMPARE(args[2].toInt(), 1);
+		QVERIFY(movedSpy.isEmpty());
+		QVERIFY(insertedSpy.isEmpty());
+		QVERIFY(removedSpy.isEmpty());
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataStoreModel::testBackgroundFetch()
+{
+	try {
+		QSignalSpy batchSpy{store, &DataStore::dataChangedBatch};
+		QVERIFY(batchSpy.isValid());
+		store->clear<TestData>();
+		store->saveAll(TestLib::generateData(0, 149));
+		//the change signals must not reach the model while fetching
+		QTRY_VERIFY(!batchSpy.isEmpty() && !batchSpy.last()[2].toBool());
+
+		DataStoreModel model{store};
+		model.setTypeId<TestData>();
+		const auto textRole = model.roleNames().key("text");
+		QSignalSpy insertedSpy{&model, &DataStoreModel::rowsInserted};
+		QVERIFY(insertedSpy.isValid());
+		QSignalSpy changedSpy{&model, &DataStoreModel::dataChanged};
+		QVERIFY(changedSpy.isValid());
+
+		//rows are inserted once the entries were loaded in the background
+		QCOMPARE(model.rowCount(), 0);
+		QVERIFY(model.canFetchMore({}));
+		model.fetchMore({});
+		QCOMPARE(model.rowCount(), 0);
+
+		//a reset drops the running fetch
+		model.reload();
+		QTest::qWait(500);
+		QVERIFY(insertedSpy.isEmpty());
+		QCOMPARE(model.rowCount(), 0);
+		QVERIFY(model.canFetchMore({}));
+
+		//fetches requested while fetching are run afterwards
+		model.fetchMore({});
+		model.fetchMore({});
+		QTRY_COMPARE(model.rowCount(), 150);
+		QCOMPARE(insertedSpy.size(), 2);
+		QVERIFY(!model.canFetchMore({}));
+		QCOMPAREUNORDERED(modelKeys(model), TestLib::generateDataKeys(0, 149));
+		for(auto i = 0; i < model.rowCount(); i++) {
+			const auto index = model.index(i);
+			QCOMPARE(model.data(index, textRole).toString(), model.key(index));
+		}
+
+		//changes during a fetch are not lost, no matter whether they arrive before or after it finished
+		model.reload();
+		model.fetchMore({});
+		auto changed = TestLib::generateData(42);
+		changed.text = QStringLiteral("changed");
+		store->save(changed);
+		QVERIFY(fetchAll(model));
+		QCOMPARE(model.rowCount(), 150);
+		QTRY_COMPARE(model.data(model.idIndex(TestLib::generateDataKey(42)), textRole).toString(), QStringLiteral("changed"));
+
+		//fetched rows are reloaded in the background when changed
+		changedSpy.clear();
+		changed = TestLib::generateData(7);
+		changed.text = QStringLiteral("changed");
+		store->save(changed);
+		const auto index = model.idIndex(TestLib::generateDataKey(7));
+		QVERIFY(index.isValid());
+		QTRY_COMPARE(model.data(index, textRole).toString(), QStringLiteral("changed"));
+		QVERIFY(!changedSpy.isEmpty());
+		QCOMPARE(changedSpy.last()[0].toModelIndex(), index);
+		QCOMPARE(model.rowCount(), 150);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataStoreModel::testWindow()
+{
+	try {
+		QSignalSpy batchSpy{store, &DataStore::dataChangedBatch};
+		QVERIFY(batchSpy.isValid());
+		store->clear<TestData>();
+		store->saveAll(TestLib::generateData(0, 149));
+		QTRY_VERIFY(!batchSpy.isEmpty() && !batchSpy.last()[2].toBool());
+
+		DataStoreModel model{store};
+		model.setTypeId<TestData>();
+		const auto textRole = model.roleNames().key("text");
+		model.setWindowSize(-5);
+		QCOMPARE(model.windowSize(), 0);
+		model.setWindowSize(10);
+		QCOMPARE(model.windowSize(), 10);
+		QVERIFY(fetchAll(model));
+		QCOMPARE(model.rowCount(), 150);
+
+		//evicted entries are loaded again when accessed, in both directions
+		for(auto i = 0; i < model.rowCount(); i++) {
+			const auto index = model.index(i);
+			QCOMPARE(model.data(index, textRole).toString(), model.key(index));
+		}
+		for(auto i = model.rowCount() - 1; i >= 0; i--) {
+			const auto index = model.index(i);
+			QCOMPARE(model.data(index, textRole).toString(), model.key(index));
+		}
+
+		//changes of evicted entries are seen once they are accessed again
+		const auto index = model.index(149);
+		auto changed = TestLib::generateData(model.key(index).toInt());
+		changed.text = QStringLiteral("changed");
+		store->save(changed);
+		QTRY_COMPARE(model.data(index, textRole).toString(), QStringLiteral("changed"));
+		QCOMPARE(model.data(model.index(0), textRole).toString(), model.key(model.index(0)));
+
+		//disabling the window keeps everything loaded from then on
+		model.setWindowSize(0);
+		for(auto i = 0; i < model.rowCount(); i++)
+			QVERIFY(model.data(model.index(i), textRole).isValid());
+		QCOMPARE(model.rowCount(), 150);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataStoreModel::testObjectWindow()
+{
+	try {
+		QSignalSpy batchSpy{store, &DataStore::dataChangedBatch};
+		QVERIFY(batchSpy.isValid());
+		store->clear<TestObject*>();
+		QList<TestObject*> objects;
+		for(auto i = 0; i < 50; i++) {
+			auto object = new TestObject{this};
+			object->id = i;
+			object->text = QString::number(i);
+			objects.append(object);
+		}
+		store->saveAll(objects);
+		qDeleteAll(objects);
+		QTRY_VERIFY(!batchSpy.isEmpty() && !batchSpy.last()[2].toBool());
+
+		DataStoreModel model{store};
+		model.setTypeId<TestObject*>();
+		const auto textRole = model.roleNames().key("text");
+		model.setWindowSize(5);
+		QVERIFY(fetchAll(model));
+		QCOMPARE(model.rowCount(), 50);
+
+		//evicted objects are deleted once control returns to the eventloop
+		QPointer<TestObject> first = model.object(model.index(0)).value<TestObject*>();
+		QVERIFY(first);
+		for(auto i = 0; i < model.rowCount(); i++) {
+			const auto index = model.index(i);
+			QCOMPARE(model.data(index, textRole).toString(), model.key(index));
+		}
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		QVERIFY(!first);
+
+		//and created again when accessed
+		auto reloaded = model.object(model.index(0)).value<TestObject*>();
+		QVERIFY(reloaded);
+		QCOMPARE(QString::number(reloaded->id), model.key(model.index(0)));
+		QCOMPARE(model.data(model.index(0), textRole).toString(), model.key(model.index(0)));
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+QStringList TestDataStoreModel::modelKeys(const DataStoreModel &model)
+{
+	QStringList keys;
+	for(auto i = 0; i < model.rowCount(); i++)
+		keys.append(model.key(model.index(i)));
+	return keys;
+}
+
+bool TestDataStoreModel::fetchAll(DataStoreModel &model)
+{
+	//fetches finish in the background and may stop at entries that changed meanwhile
+	QElapsedTimer timer;
+	timer.start();
+	while(model.canFetchMore({}) && timer.elapsed() < 5000) {
+		model.fetchMore({});
+		QTest::qWait(10);
+	}
+	return !model.canFetchMore({});
+}
+
+QTEST_MAIN(TestDataStoreModel)
+
+#include "tst_datastoremodel.moc"
@@ -16,10 +16,16 @@ private Q_SLOTS:
 	void testSimple();
 	void testCachingGadget();
 	void testCachingObject();
+	void testCachingAsync();
+	void testCachingBounded();
+	void testCachingObjectAsync();
+	void testCachingObjectBounded();
 
 private:
 	DataStore *dataStore;
 
+	QList<TestObject*> generateObjects(int from, int to);
+
 	template<typename T>
 	void testCaching(std::function<QList<T>(int,int)> generator,
 					 std::function<bool(T,T)> equals = [](T a, T b){ return a == b; });
@@ -127,6 +133,233 @@ void TestDataTypeStore::testCachingObject()
 	});
 }
 
+void TestDataTypeStore::testCachingAsync()
+{
+	try {
+		dataStore->clear<TestData>();
+		dataStore->saveAll(TestLib::generateData(0, 249));
+
+		CachingDataTypeStore<TestData, int> store(dataStore, CachingDataTypeStoreBase::LoadAsynchronous, 0, this);
+		QSignalSpy readySpy(&store, &CachingDataTypeStoreBase::readyChanged);
+		QSignalSpy progressSpy(&store, &CachingDataTypeStoreBase::loadProgress);
+		QVERIFY(!store.isReady());
+
+		//usable while still loading
+		QCOMPARE(store.count(), 250);
+		QCOMPARE(store.load(42), TestLib::generateData(42));
+		QVERIFY(store.contains(200));
+		store.save(TestLib::generateData(250));
+		auto changed = TestLib::generateData(10);
+		changed.text = QStringLiteral("changed");
+		store.save(changed);
+		QVERIFY(store.remove(20));
+
+		QVERIFY(readySpy.wait());
+		QVERIFY(store.isReady());
+		QCOMPARE(readySpy.size(), 1);
+		QCOMPARE(readySpy.takeFirst()[0].toBool(), true);
+		//the keys might have been loaded before or after saving the new dataset
+		QCOMPARE(progressSpy.size(), 3);
+		QCOMPARE(progressSpy.first()[0].toInt(), 100);
+		QVERIFY(progressSpy.last()[0].toInt() >= 250);
+		QCOMPARE(progressSpy.last()[0], progressSpy.last()[1]);
+
+		//changes made while loading must not be overwritten
+		QCOMPARE(store.count(), 250);
+		QCOMPARE(store.load(10), changed);
+		QVERIFY(!store.contains(20));
+		QCOMPARE(store.load(250), TestLib::generateData(250));
+
+		store.clear();
+		QCOMPARE(store.count(), 0);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataTypeStore::testCachingBounded()
+{
+	try {
+		dataStore->clear<TestData>();
+		dataStore->saveAll(TestLib::generateData(0, 99));
+
+		CachingDataTypeStore<TestData, int> store(dataStore, CachingDataTypeStoreBase::LoadSynchronous, 10, this);
+		QSignalSpy changeSpy(&store, &DataTypeStoreBase::dataChanged);
+		QVERIFY(store.isReady());
+		QCOMPARE(store.maxSize(), 10);
+
+		//only the resident datasets can be iterated, but everything can be accessed
+		auto resident = 0;
+		for(auto it = store.begin(); it != store.end(); it++)
+			resident++;
+		QCOMPARE(resident, 10);
+		QCOMPARE(store.count(), 100);
+		QCOMPARE(store.keys().size(), 100);
+		QCOMPARE(store.loadAll().size(), 100);
+		for(auto i = 0; i < 100; i++)
+			QCOMPARE(store.load(i), TestLib::generateData(i));
+		QVERIFY(store.contains(99));
+		QVERIFY(!store.contains(100));
+		QCOMPARE(store.load(100), TestData());
+
+		resident = 0;
+		for(auto it = store.begin(); it != store.end(); it++)
+			resident++;
+		QVERIFY(resident <= 12);
+
+		//saves pass their data on, even for evicted datasets
+		auto changed = TestLib::generateData(0);
+		changed.text = QStringLiteral("changed");
+		store.save(changed);
+		QCOMPARE(changeSpy.size(), 1);
+		QCOMPARE(changeSpy.takeFirst()[1].value<TestData>(), changed);
+		QCOMPARE(store.load(0), changed);
+
+		QCOMPARE(store.take(50), TestLib::generateData(50));
+		QVERIFY(!store.contains(50));
+		QCOMPARE(store.count(), 99);
+
+		store.clear();
+		QCOMPARE(store.count(), 0);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataTypeStore::testCachingObjectAsync()
+{
+	try {
+		dataStore->clear<TestObject*>();
+		auto objects = generateObjects(0, 249);
+		dataStore->saveAll(objects);
+		qDeleteAll(objects);
+
+		CachingDataTypeStore<TestObject*, int> store(dataStore, CachingDataTypeStoreBase::LoadAsynchronous, 0, this);
+		QSignalSpy readySpy(&store, &CachingDataTypeStoreBase::readyChanged);
+		QVERIFY(!store.isReady());
+
+		//usable while still loading
+		QCOMPARE(store.count(), 250);
+		auto loaded = store.load(42);
+		QVERIFY(loaded);
+		QCOMPARE(loaded->parent(), &store);
+		QCOMPARE(loaded->text, QStringLiteral("42"));
+		QVERIFY(store.contains(200));
+		auto added = generateObjects(250, 250).first();
+		store.save(added);
+		auto changed = generateObjects(10, 10).first();
+		changed->text = QStringLiteral("changed");
+		store.save(changed);
+		QVERIFY(store.remove(20));
+		QCOMPARE(store.loadAll().size(), 250);
+
+		QVERIFY(readySpy.wait());
+		QVERIFY(store.isReady());
+
+		//changes made while loading must not be overwritten
+		QCOMPARE(store.count(), 250);
+		QCOMPARE(store.load(42), loaded);
+		QVERIFY(store.load(10)->equals(changed));
+		QVERIFY(!store.contains(20));
+		QVERIFY(store.load(250)->equals(added));
+		for(auto object : store.loadAll())
+			QCOMPARE(object->parent(), &store);
+		delete added;
+		delete changed;
+
+		store.clear();
+		QCOMPARE(store.count(), 0);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestDataTypeStore::testCachingObjectBounded()
+{
+	try {
+		dataStore->clear<TestObject*>();
+		auto objects = generateObjects(0, 99);
+		dataStore->saveAll(objects);
+		qDeleteAll(objects);
+
+		CachingDataTypeStore<TestObject*, int> store(dataStore, CachingDataTypeStoreBase::LoadSynchronous, 10, this);
+		QVERIFY(store.isReady());
+		QCOMPARE(store.count(), 100);
+
+		//bounded stores always hand out objects owned by the caller
+		auto all = store.loadAll();
+		QCOMPARE(all.size(), 100);
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		QList<int> keys;
+		for(auto object : all) {
+			QVERIFY(!object->parent());
+			keys.append(object->id);
+		}
+		QList<int> expected;
+		for(auto i = 0; i < 100; i++)
+			expected.append(i);
+		QCOMPAREUNORDERED(keys, expected);
+		qDeleteAll(all);
+
+		auto resident = 0;
+		for(auto it = store.begin(); it != store.end(); it++)
+			resident++;
+		QVERIFY(resident <= 12);
+
+		//loading cached and evicted objects returns copies, that survive the eviction
+		QList<TestObject*> loaded;
+		for(auto i = 0; i < 100; i++) {
+			auto object = store.load(i);
+			QVERIFY(object);
+			QVERIFY(!object->parent());
+			loaded.append(object);
+		}
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		for(auto i = 0; i < 100; i++)
+			QCOMPARE(loaded[i]->id, i);
+		qDeleteAll(loaded);
+		auto first = store.load(5);
+		auto second = store.load(5);
+		QVERIFY(first != second);
+		QCOMPARE(second->id, 5);
+		delete first;
+		delete second;
+
+		//taken objects belong to the caller, whether they were cached or not
+		auto taken = store.take(50);
+		QVERIFY(taken);
+		QCOMPARE(taken->id, 50);
+		QVERIFY(!taken->parent());
+		QVERIFY(!store.contains(50));
+		QCOMPARE(store.count(), 99);
+		delete taken;
+		taken = store.take(0);
+		QVERIFY(taken);
+		QCOMPARE(taken->id, 0);
+		QVERIFY(!taken->parent());
+		QCOMPARE(store.count(), 98);
+		delete taken;
+		QVERIFY(!store.take(50));
+
+		store.clear();
+		QCOMPARE(store.count(), 0);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+QList<TestObject*> TestDataTypeStore::generateObjects(int from, int to)
+{
+	QList<TestObject*> l;
+	for(auto i = from; i <= to; i++) {
+		auto obj = new TestObject();
+		obj->id = i;
+		obj->text = QString::number(i);
+		l.append(obj);
+	}
+	return l;
+}
+
 template<typename T>
 void TestDataTypeStore::testCaching(std::function<QList<T>(int,int)> generator, std::function<bool(T,T)> equals)
 {
@@ -233,6 +466,11 @@ Q_DECL_UNUSED static void dataTypeStoreCompiletest_DO_NOT_CALL()
 	t3.clear();
 	t3.begin();
 	t3.end();
+	t3.isReady();
+	t3.maxSize();
+
+	CachingDataTypeStore<TestData, int> t5(CachingDataTypeStoreBase::LoadAsynchronous, 100);
+	t5.load(0);
 
 	CachingDataTypeStore<TestObject*, int> t4;
 	t4.count();
@@ -246,6 +484,9 @@ Q_DECL_UNUSED static void dataTypeStoreCompiletest_DO_NOT_CALL()
 	t4.clear();
 	t4.begin();
 	t4.end();
+
+	CachingDataTypeStore<TestObject*, int> t6(CachingDataTypeStoreBase::LoadAsynchronous, 100);
+	t6.load(0);
 }
 
 QTEST_MAIN(TestDataTypeStore)
@@ -2,6 +2,7 @@
 #include <QtTest>
 #include <QCoreApplication>
 #include <QtConcurrent>
+#include <QtSql/QSqlQuery>
 #include <testlib.h>
 #include <QtDataSync/private/localstore_p.h>
 #include <QtDataSync/private/defaults_p.h>
@@ -37,9 +38,17 @@ private Q_SLOTS:
 	void testInfoOperations();
 
 	//special
+	void testBatchSignals();
 	void testChangeSignals();
 	void testAsync();
 	void testPassiveSetup();
+	void testInlineStorage();
+	void testDatabaseOptions();
+	void testIndexes();
+	void testQuery();
+	void testFullText();
+	void testCompression();
+	void testLegacyPayloads();
 
 private:
 	LocalStore *store;
@@ -132,6 +141,17 @@ void TestLocalStore::testContains()
 	try {
 		QVERIFY(store->contains(TestLib::generateKey(430)));
 		QVERIFY(!store->contains(TestLib::generateKey(440)));
+
+		//repeated misses are answered by the cache
+		const auto stats = store->cacheStatistics(TestLib::TypeName);
+		QVERIFY(!store->contains(TestLib::generateKey(440)));
+		QVERIFY_EXCEPTION_THROWN(store->load(TestLib::generateKey(440)), NoDataException);
+		QVERIFY_EXCEPTION_THROWN(store->load(TestLib::generateKey(441)), NoDataException);
+		QVERIFY(!store->contains(TestLib::generateKey(441)));
+		QVERIFY_EXCEPTION_THROWN(store->load(TestLib::generateKey(441)), NoDataException);
+		const auto newStats = store->cacheStatistics(TestLib::TypeName);
+		QCOMPARE(newStats.hits, stats.hits + 4);
+		QCOMPARE(newStats.misses, stats.misses + 1);
 	} catch(QException &e) {
 		QFAIL(e.what());
 	}
@@ -243,9 +263,64 @@ void TestLocalStore::testClear()
 
 void TestLocalStore::testChangeLoading()
 {
+	auto loadChangeKeys = [&]() {
+		QList<ObjectKey> keys;
+		store->loadChanges(10, [&](ObjectKey k, quint64, QString, QUuid) {
+			keys.append(k);
+			return true;
+		});
+		return keys;
+	};
+
 	try {
 		store->reset(false);
 
+		//changes are loaded first-in, first-out, independent of their keys
+		store->save(TestLib::generateKey(50), TestLib::generateDataJson(50));
+		store->save(TestLib::generateKey(20), TestLib::generateDataJson(20));
+		store->save(TestLib::generateKey(35), TestLib::generateDataJson(35));
+		store->save(TestLib::generateKey(10), TestLib::generateDataJson(10));
+		store->save(TestLib::generateKey(45), TestLib::generateDataJson(45));
+		QCOMPARE(loadChangeKeys(), (QList<ObjectKey>{
+			TestLib::generateKey(50),
+			TestLib::generateKey(20),
+			TestLib::generateKey(35),
+			TestLib::generateKey(10),
+			TestLib::generateKey(45)
+		}));
+
+		//saving a pending change again keeps its position
+		store->save(TestLib::generateKey(35), TestLib::generateDataJson(35, QStringLiteral("changed")));
+		QCOMPARE(loadChangeKeys(), (QList<ObjectKey>{
+			TestLib::generateKey(50),
+			TestLib::generateKey(20),
+			TestLib::generateKey(35),
+			TestLib::generateKey(10),
+			TestLib::generateKey(45)
+		}));
+
+		//uploaded changes leave gaps without changing the order of the others
+		store->markUnchanged(TestLib::generateKey(20), 1, false);
+		store->markUnchanged(TestLib::generateKey(10), 1, false);
+		QCOMPARE(store->changeCount(), 3u);
+		QCOMPARE(loadChangeKeys(), (QList<ObjectKey>{
+			TestLib::generateKey(50),
+			TestLib::generateKey(35),
+			TestLib::generateKey(45)
+		}));
+
+		//changing an uploaded dataset again queues it at the end
+		store->save(TestLib::generateKey(20), TestLib::generateDataJson(20, QStringLiteral("changed")));
+		QCOMPARE(loadChangeKeys(), (QList<ObjectKey>{
+			TestLib::generateKey(50),
+			TestLib::generateKey(35),
+			TestLib::generateKey(45),
+			TestLib::generateKey(20)
+		}));
+
+		store->reset(false);
+		QCOMPARE(store->changeCount(), 0u);
+
 		//create 2 changes
 		store->save(TestLib::generateKey(42), TestLib::generateDataJson(42));
 		store->save(TestLib::generateKey(13), TestLib::generateDataJson(13));
@@ -266,8 +341,11 @@ void TestLocalStore::testChangeLoading()
 		});
 		QCOMPARE(cCount, 1);
 		cCount = 0;
-		store->loadChanges(1, [&](ObjectKey, quint64, QString, QUuid) {
+		store->loadChanges(1, [&](ObjectKey k, quint64, QString, QUuid) {
 			cCount++;
+			[&](){
+				QCOMPARE(k, TestLib::generateKey(42)); //changes are loaded in the order they were made
+			}();
 			return true;
 		});
 		QCOMPARE(cCount, 1);
@@ -379,6 +457,68 @@ void TestLocalStore::testDeviceChanges()
 		QCOMPARE(store->changeCount(), 1u);
 		store->markUnchanged(TestLib::generateKey(43), 2, true);
 		QCOMPARE(store->changeCount(), 0u);
+
+		//completions out of order
+		store->save(TestLib::generateKey(44), TestLib::generateDataJson(44));
+		store->markUnchanged(TestLib::generateKey(44), 1, false);
+		auto devId2 = QUuid::createUuid();
+		store->prepareAccountAdded(devId2);
+		QCOMPARE(store->changeCount(), 2u);
+		store->removeDeviceChange(TestLib::generateKey(44), devId2);
+		QCOMPARE(store->changeCount(), 1u);
+		cCount = 0;
+		store->loadChanges(10, [&](ObjectKey k, quint64, QString, QUuid d) {
+			cCount++;
+			[&](){
+				QCOMPARE(k, TestLib::generateKey(42));
+				QCOMPARE(d, devId2);
+			}();
+			return true;
+		});
+		QCOMPARE(cCount, 1);
+		store->removeDeviceChange(TestLib::generateKey(42), devId2);
+		QCOMPARE(store->changeCount(), 0u);
+		cCount = 0;
+		store->loadChanges(10, [&](ObjectKey, quint64, QString, QUuid) {
+			cCount++;
+			return true;
+		});
+		QCOMPARE(cCount, 0);
+
+		//delete after ack
+		store->save(TestLib::generateKey(45), TestLib::generateDataJson(45));
+		store->markUnchanged(TestLib::generateKey(45), 1, false);
+		auto devId3 = QUuid::createUuid();
+		store->prepareAccountAdded(devId3);
+		QCOMPARE(store->changeCount(), 3u);
+		store->removeDeviceChange(TestLib::generateKey(45), devId3);
+		QCOMPARE(store->changeCount(), 2u);
+		store->remove(TestLib::generateKey(45));
+		QCOMPARE(store->changeCount(), 3u);
+		store->markUnchanged(TestLib::generateKey(45), 2, true);
+		QCOMPARE(store->changeCount(), 2u);
+
+		//changed datasets are only uploaded once, not for the device again
+		store->save(TestLib::generateKey(44), TestLib::generateDataJson(44));
+		QCOMPARE(store->changeCount(), 2u);
+		QList<QPair<ObjectKey, QUuid>> changes;
+		store->loadChanges(10, [&](ObjectKey k, quint64, QString, QUuid d) {
+			changes.append({k, d});
+			return true;
+		});
+		QCOMPARE(changes.size(), 2);
+		QVERIFY(changes.contains({TestLib::generateKey(44), QUuid{}}));
+		QVERIFY(changes.contains({TestLib::generateKey(42), devId3}));
+		store->markUnchanged(TestLib::generateKey(44), 2, false);
+		QCOMPARE(store->changeCount(), 1u);
+		store->removeDeviceChange(TestLib::generateKey(42), devId3);
+		QCOMPARE(store->changeCount(), 0u);
+		cCount = 0;
+		store->loadChanges(10, [&](ObjectKey, quint64, QString, QUuid) {
+			cCount++;
+			return true;
+		});
+		QCOMPARE(cCount, 0);
 	} catch(QException &e) {
 		QFAIL(e.what());
 	}
@@ -556,6 +696,72 @@ void TestLocalStore::testInfoOperations()
 	}
 }
 
+void TestLocalStore::testBatchSignals()
+{
+	const QByteArray typeName = "BatchData";
+	QSignalSpy store1Spy(store, &LocalStore::dataChangedBatch);
+	do //clear out any remaining signals
+		store1Spy.clear();
+	while(store1Spy.wait());
+
+	LocalStore second(DefaultsPrivate::obtainDefaults(DefaultSetup));
+	QSignalSpy store2Spy(&second, &LocalStore::dataChangedBatch);
+	QSignalSpy store2KeySpy(&second, &LocalStore::dataChanged);
+
+	try {
+		//bulk operations are one batch for all stores
+		QHash<QString, QJsonObject> data;
+		QStringList ids;
+		for(auto i = 0; i < 10; i++) {
+			ids.append(QString::number(i));
+			data.insert(ids.last(), TestLib::generateDataJson(i));
+		}
+		store->saveAll(typeName, data);
+
+		QCOMPARE(store1Spy.size(), 1);
+		auto sig = store1Spy.takeFirst();
+		QCOMPARE(sig[0].toByteArray(), typeName);
+		QCOMPAREUNORDERED(sig[1].toStringList(), ids);
+		QCOMPARE(sig[2].toBool(), false);
+
+		QVERIFY(store2Spy.wait());
+		QCOMPARE(store2Spy.size(), 1);
+		sig = store2Spy.takeFirst();
+		QCOMPARE(sig[0].toByteArray(), typeName);
+		QCOMPAREUNORDERED(sig[1].toStringList(), ids);
+		QCOMPARE(sig[2].toBool(), false);
+		QCOMPARE(store2KeySpy.size(), ids.size());
+		store2KeySpy.clear();
+
+		//single changes are coalesced for other stores, but stay in order
+		for(const auto &id : ids)
+			store->save({typeName, id}, TestLib::generateDataJson(id.toInt() + 10));
+		QVERIFY(store->remove({typeName, ids.first()}));
+		QCOMPARE(store1Spy.size(), ids.size() + 1);
+		store1Spy.clear();
+
+		QStringList changedIds;
+		auto removed = false;
+		while(!removed && store2Spy.wait()) {
+			while(!store2Spy.isEmpty()) {
+				sig = store2Spy.takeFirst();
+				QCOMPARE(sig[0].toByteArray(), typeName);
+				QVERIFY(!removed);
+				if(sig[2].toBool()) {
+					QCOMPARE(sig[1].toStringList(), QStringList{ids.first()});
+					removed = true;
+				} else
+					changedIds.append(sig[1].toStringList());
+			}
+		}
+		QVERIFY(removed);
+		QCOMPARE(changedIds, ids);
+		QCOMPARE(store2KeySpy.size(), ids.size() + 1);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
 void TestLocalStore::testChangeSignals()
 {
 	const auto key = TestLib::generateKey(77);
@@ -721,6 +927,433 @@ void TestLocalStore::testPassiveSetup()
 	}
 }
 
+void TestLocalStore::testInlineStorage()
+{
+	const auto nName = QStringLiteral("inlineSetup");
+	const auto nDir = TestLib::tDir.path() + QStringLiteral("/inline");
+	const auto key1 = TestLib::generateKey(88);
+	const auto data1 = TestLib::generateDataJson(88);
+	const auto key2 = TestLib::generateKey(89);
+	const auto data2 = TestLib::generateDataJson(89);
+
+	try {
+		//store data as files first
+		{
+			Setup setup;
+			TestLib::setup(setup);
+			setup.setLocalDir(nDir)
+					.setStorageMode(Setup::StorageMode::Files);
+			setup.create(nName);
+			{
+				LocalStore fileStore(DefaultsPrivate::obtainDefaults(nName));
+				fileStore.save(key1, data1);
+			}
+			Setup::removeSetup(nName, true);
+		}
+
+		QDir dataDir{nDir};
+		QVERIFY(dataDir.cd(QStringLiteral("store/data_") + QString::fromUtf8(TestLib::TypeName)));
+		QCOMPARE(dataDir.entryList(QDir::Files).size(), 1);
+
+		//reopen in inline mode and migrate
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(nDir)
+				.setStorageMode(Setup::StorageMode::Inline);
+		setup.create(nName);
+		{
+			LocalStore inlineStore(DefaultsPrivate::obtainDefaults(nName));
+			QCOMPARE(inlineStore.load(key1), data1);
+			inlineStore.migrateStorage();
+			QCOMPARE(dataDir.entryList(QDir::Files).size(), 0);
+			QCOMPARE(inlineStore.load(key1), data1);
+
+			inlineStore.save(key2, data2);
+			QCOMPARE(dataDir.entryList(QDir::Files).size(), 0);
+			QCOMPARE(inlineStore.count(TestLib::TypeName), 2ull);
+			QCOMPAREUNORDERED(inlineStore.loadAll(TestLib::TypeName), (QList<QJsonObject>{data1, data2}));
+			QCOMPARE(inlineStore.find(TestLib::TypeName, QStringLiteral("89"), DataStore::StartsWithMode), QList<QJsonObject>{data2});
+
+			QVERIFY(inlineStore.remove(key1));
+			QVERIFY_EXCEPTION_THROWN(inlineStore.load(key1), NoDataException);
+			QCOMPARE(inlineStore.count(TestLib::TypeName), 1ull);
+		}
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestLocalStore::testDatabaseOptions()
+{
+	const auto nName = QStringLiteral("walSetup");
+	try {
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(TestLib::tDir.path() + QStringLiteral("/wal"))
+				.setJournalMode(Setup::JournalMode::Wal)
+				.setSynchronousMode(Setup::SynchronousMode::Normal)
+				.setMmapSize(MB(8))
+				.setDatabaseCacheSize(-4096);
+		setup.create(nName);
+
+		{
+			Defaults defaults{DefaultsPrivate::obtainDefaults(nName)};
+			auto database = defaults.aquireDatabase(this);
+			QSqlQuery query(database.database());
+			QVERIFY(query.exec(QStringLiteral("PRAGMA journal_mode")));
+			QVERIFY(query.first());
+			QCOMPARE(query.value(0).toString().toLower(), QStringLiteral("wal"));
+			QVERIFY(query.exec(QStringLiteral("PRAGMA synchronous")));
+			QVERIFY(query.first());
+			QCOMPARE(query.value(0).toInt(), 1);
+			QVERIFY(query.exec(QStringLiteral("PRAGMA cache_size")));
+			QVERIFY(query.first());
+			QCOMPARE(query.value(0).toInt(), -4096);
+
+			//data access works as usual
+			LocalStore walStore(defaults);
+			const auto key = TestLib::generateKey(90);
+			const auto data = TestLib::generateDataJson(90);
+			walStore.save(key, data);
+			QCOMPARE(walStore.load(key), data);
+		}
+
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestLocalStore::testIndexes()
+{
+	const auto nName = QStringLiteral("indexSetup");
+	const auto nDir = TestLib::tDir.path() + QStringLiteral("/index");
+	const auto group = QStringLiteral("group");
+	const auto data1 = TestLib::generateDataJson(91, group);
+	const auto data2 = TestLib::generateDataJson(92, group);
+	const auto data3 = TestLib::generateDataJson(93, QStringLiteral("other"));
+
+	try {
+		//store data without indexes first
+		{
+			Setup setup;
+			TestLib::setup(setup);
+			setup.setLocalDir(nDir);
+			setup.create(nName);
+			{
+				LocalStore plainStore(DefaultsPrivate::obtainDefaults(nName));
+				plainStore.save(TestLib::generateKey(91), data1);
+				plainStore.save(TestLib::generateKey(93), data3);
+				QVERIFY_EXCEPTION_THROWN(plainStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), group), LocalStoreException);
+			}
+			Setup::removeSetup(nName, true);
+		}
+
+		//reopen with an index and rebuild it
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(nDir)
+				.setIndexedProperties(TestLib::TypeName, {QStringLiteral("text")});
+		QCOMPARE(setup.indexedProperties(TestLib::TypeName), QStringList{QStringLiteral("text")});
+		setup.create(nName);
+		{
+			LocalStore indexStore(DefaultsPrivate::obtainDefaults(nName));
+			indexStore.rebuildIndexes();
+			QCOMPARE(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), group), QStringList{QStringLiteral("91")});
+
+			//index follows writes
+			indexStore.save(TestLib::generateKey(92), data2);
+			QCOMPAREUNORDERED(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), group),
+							  (QStringList{QStringLiteral("91"), QStringLiteral("92")}));
+			QCOMPAREUNORDERED(indexStore.loadIndexed(TestLib::TypeName, QStringLiteral("text"), group),
+							  (QList<QJsonObject>{data1, data2}));
+
+			indexStore.save(TestLib::generateKey(91), TestLib::generateDataJson(91));
+			QCOMPARE(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), group), QStringList{QStringLiteral("92")});
+			QVERIFY(indexStore.remove(TestLib::generateKey(92)));
+			QVERIFY(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), group).isEmpty());
+			QCOMPARE(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), QStringLiteral("other")), QStringList{QStringLiteral("93")});
+
+			indexStore.clear(TestLib::TypeName);
+			QVERIFY(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("text"), QStringLiteral("other")).isEmpty());
+			QVERIFY_EXCEPTION_THROWN(indexStore.indexedKeys(TestLib::TypeName, QStringLiteral("id"), 91), LocalStoreException);
+		}
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestLocalStore::testQuery()
+{
+	const auto nName = QStringLiteral("querySetup");
+	try {
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(TestLib::tDir.path() + QStringLiteral("/query"))
+				.setStorageMode(Setup::StorageMode::Inline)
+				.setIndexedProperties(TestLib::TypeName, {QStringLiteral("id"), QStringLiteral("text")});
+		setup.create(nName);
+		{
+			LocalStore queryStore(DefaultsPrivate::obtainDefaults(nName));
+			QHash<QString, QJsonObject> data;
+			for(auto i = 100; i < 110; i++)
+				data.insert(QString::number(i), TestLib::generateDataJson(i, i % 2 == 0 ? QStringLiteral("even") : QStringLiteral("odd")));
+			queryStore.saveAll(TestLib::TypeName, data);
+
+			auto query = DataQuery{}.where(QStringLiteral("text"), QStringLiteral("even"));
+			QCOMPARE(queryStore.count(TestLib::TypeName, query), 5ull);
+
+			query.orderBy(QStringLiteral("id"), Qt::DescendingOrder)
+					.setLimit(2)
+					.setOffset(1);
+			QCOMPARE(queryStore.keys(TestLib::TypeName, query), (QStringList{QStringLiteral("106"), QStringLiteral("104")}));
+			QCOMPARE(queryStore.query(TestLib::TypeName, query), (QList<QJsonObject>{data.value(QStringLiteral("106")), data.value(QStringLiteral("104"))}));
+			QCOMPARE(queryStore.count(TestLib::TypeName, query), 5ull);
+
+			//preceding keys ignore the paging of the query, the closest first
+			QStringList preceding;
+			QVERIFY(queryStore.precedingKeys(TestLib::TypeName, query, QStringLiteral("104"), 2, preceding));
+			QCOMPARE(preceding, (QStringList{QStringLiteral("106"), QStringLiteral("108")}));
+			QVERIFY(!queryStore.precedingKeys(TestLib::TypeName, query, QStringLiteral("105"), 2, preceding));
+
+			query = DataQuery{}
+					.where(QStringLiteral("id"), DataQuery::GreaterEqual, 103)
+					.where(QStringLiteral("id"), DataQuery::Less, 106)
+					.orderBy(QStringLiteral("text"));
+			QCOMPARE(queryStore.keys(TestLib::TypeName, query), (QStringList{QStringLiteral("104"), QStringLiteral("103"), QStringLiteral("105")}));
+			QVERIFY(queryStore.precedingKeys(TestLib::TypeName, query, QStringLiteral("105"), 5, preceding));
+			QCOMPARE(preceding, (QStringList{QStringLiteral("103"), QStringLiteral("104")}));
+			QVERIFY(queryStore.precedingKeys(TestLib::TypeName, query, QStringLiteral("104"), 5, preceding));
+			QVERIFY(preceding.isEmpty());
+			query = DataQuery{}.where(QStringLiteral("text"), DataQuery::Like, QStringLiteral("o%"));
+			QCOMPARE(queryStore.count(TestLib::TypeName, query), 5ull);
+
+			QVERIFY_EXCEPTION_THROWN(queryStore.count(TestLib::TypeName, DataQuery{}.where(QStringLiteral("other"), 42)), LocalStoreException);
+			QVERIFY_EXCEPTION_THROWN(queryStore.keys(TestLib::TypeName, DataQuery{}.orderBy(QStringLiteral("other"))), LocalStoreException);
+		}
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestLocalStore::testFullText()
+{
+	const auto nName = QStringLiteral("fullTextSetup");
+	const auto nDir = TestLib::tDir.path() + QStringLiteral("/fulltext");
+	const auto data1 = TestLib::generateDataJson(111, QStringLiteral("the quick brown fox jumps over the lazy dog"));
+	const auto data2 = TestLib::generateDataJson(112, QStringLiteral("a fox, another fox and a third fox"));
+	const auto data3 = TestLib::generateDataJson(113, QStringLiteral("nothing to see here"));
+
+	try {
+		//store data without full text index first
+		{
+			Setup setup;
+			TestLib::setup(setup);
+			setup.setLocalDir(nDir);
+			setup.create(nName);
+			{
+				LocalStore plainStore(DefaultsPrivate::obtainDefaults(nName));
+				plainStore.save(TestLib::generateKey(111), data1);
+				plainStore.save(TestLib::generateKey(113), data3);
+				QVERIFY_EXCEPTION_THROWN(plainStore.fullTextMatches(TestLib::TypeName, QStringLiteral("fox"), -1), LocalStoreException);
+				QVERIFY_EXCEPTION_THROWN(plainStore.find(TestLib::TypeName, QStringLiteral("fox"), DataStore::FullTextMode), LocalStoreException);
+			}
+			Setup::removeSetup(nName, true);
+		}
+
+		//reopen with a full text index and rebuild it
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(nDir)
+				.setFullTextProperties(TestLib::TypeName, {QStringLiteral("text")});
+		QCOMPARE(setup.fullTextProperties(TestLib::TypeName), QStringList{QStringLiteral("text")});
+		setup.create(nName);
+		{
+			LocalStore textStore(DefaultsPrivate::obtainDefaults(nName));
+			textStore.rebuildIndexes();
+			auto matches = textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("fox"), -1);
+			QCOMPARE(matches.size(), 1);
+			QCOMPARE(matches[0].key, QStringLiteral("111"));
+			QVERIFY(matches[0].snippet.contains(QStringLiteral("<b>fox</b>")));
+
+			//index follows writes and is ranked
+			textStore.save(TestLib::generateKey(112), data2);
+			matches = textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("fox"), -1);
+			QCOMPARE(matches.size(), 2);
+			QCOMPARE(matches[0].key, QStringLiteral("112"));
+			QCOMPARE(matches[1].key, QStringLiteral("111"));
+			QVERIFY(matches[0].rank <= matches[1].rank);
+			QCOMPARE(textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("fox"), 1).size(), 1);
+			QCOMPARE(textStore.find(TestLib::TypeName, QStringLiteral("fox"), DataStore::FullTextMode),
+					 (QList<QJsonObject>{data2, data1}));
+			QCOMPARE(textStore.find(TestLib::TypeName, QStringLiteral("qui* AND dog"), DataStore::FullTextMode),
+					 QList<QJsonObject>{data1});
+
+			textStore.save(TestLib::generateKey(111), TestLib::generateDataJson(111, QStringLiteral("no animals")));
+			matches = textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("fox"), -1);
+			QCOMPARE(matches.size(), 1);
+			QCOMPARE(matches[0].key, QStringLiteral("112"));
+			QVERIFY(textStore.remove(TestLib::generateKey(112)));
+			QVERIFY(textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("fox"), -1).isEmpty());
+			QCOMPARE(textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("see"), -1).size(), 1);
+
+			textStore.clear(TestLib::TypeName);
+			QVERIFY(textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("see"), -1).isEmpty());
+			QVERIFY_EXCEPTION_THROWN(textStore.fullTextMatches(TestLib::TypeName, QStringLiteral("\"broken"), -1), LocalStoreException);
+		}
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestLocalStore::testCompression()
+{
+	const auto nName = QStringLiteral("compressSetup");
+	const auto nDir = TestLib::tDir.path() + QStringLiteral("/compress");
+	const auto key1 = TestLib::generateKey(94);
+	const auto data1 = TestLib::generateDataJson(94, QStringLiteral("compress").repeated(64));
+	const auto key2 = TestLib::generateKey(95);
+	const auto data2 = TestLib::generateDataJson(95, QStringLiteral("compress").repeated(64));
+
+	try {
+		//store uncompressed data first
+		{
+			Setup setup;
+			TestLib::setup(setup);
+			setup.setLocalDir(nDir)
+					.setStorageMode(Setup::StorageMode::Inline);
+			setup.create(nName);
+			{
+				LocalStore plainStore(DefaultsPrivate::obtainDefaults(nName));
+				plainStore.save(key1, data1);
+			}
+			Setup::removeSetup(nName, true);
+		}
+
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(nDir)
+				.setStorageMode(Setup::StorageMode::Inline)
+				.setCompressionLevel(TestLib::TypeName, 9);
+		QCOMPARE(setup.compressionLevel(TestLib::TypeName), 9);
+		setup.create(nName);
+		{
+			Defaults defaults{DefaultsPrivate::obtainDefaults(nName)};
+			LocalStore compressStore(defaults);
+			QCOMPARE(compressStore.load(key1), data1);
+			compressStore.save(key2, data2);
+			QCOMPARE(compressStore.load(key2), data2);
+
+			//check the raw payloads
+			auto database = defaults.aquireDatabase(this);
+			QSqlQuery query(database.database());
+			QVERIFY(query.prepare(QStringLiteral("SELECT Id, Data FROM DataIndex WHERE Type = ?")));
+			query.addBindValue(TestLib::TypeName);
+			QVERIFY(query.exec());
+			QHash<QString, QByteArray> payloads;
+			while(query.next())
+				payloads.insert(query.value(0).toString(), query.value(1).toByteArray());
+			query.finish();
+			QVERIFY(!payloads.value(key1.id).startsWith("qdsz"));
+			QVERIFY(payloads.value(key2.id).startsWith("qdsz"));
+			QVERIFY(payloads.value(key2.id).size() < payloads.value(key1.id).size());
+
+			//rewriting compresses existing data
+			compressStore.save(key1, data1);
+			QCOMPARE(compressStore.load(key1), data1);
+		}
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
+void TestLocalStore::testLegacyPayloads()
+{
+	const auto nName = QStringLiteral("legacySetup");
+	const auto nDir = TestLib::tDir.path() + QStringLiteral("/legacy");
+	const auto key = TestLib::generateKey(96);
+	const auto data = TestLib::generateDataJson(96);
+
+	auto readPayload = [&](const DatabaseRef &database) {
+		QSqlQuery query(database.database());
+		query.prepare(QStringLiteral("SELECT Data FROM DataIndex WHERE Type = ? AND Id = ?"));
+		query.addBindValue(key.typeName);
+		query.addBindValue(key.id);
+		if(!query.exec() || !query.first())
+			return QByteArray{};
+		return query.value(0).toByteArray();
+	};
+	auto readUserVersion = [](const DatabaseRef &database) {
+		QSqlQuery query(database.database());
+		if(!query.exec(QStringLiteral("PRAGMA user_version")) || !query.first())
+			return -1;
+		return query.value(0).toInt();
+	};
+
+	try {
+		//store data in the format of previous versions
+		{
+			Setup setup;
+			TestLib::setup(setup);
+			setup.setLocalDir(nDir)
+					.setStorageMode(Setup::StorageMode::Inline);
+			setup.create(nName);
+			{
+				Defaults defaults{DefaultsPrivate::obtainDefaults(nName)};
+				LocalStore legacyStore(defaults);
+				legacyStore.save(key, data);
+
+				auto database = defaults.aquireDatabase(this);
+				QVERIFY(readPayload(database).startsWith("qdsc"));
+				QSqlQuery query(database.database());
+				QVERIFY(query.prepare(QStringLiteral("UPDATE DataIndex SET Data = ? WHERE Type = ? AND Id = ?")));
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+				query.addBindValue(QJsonDocument(data).toBinaryData());
+QT_WARNING_POP
+				query.addBindValue(key.typeName);
+				query.addBindValue(key.id);
+				QVERIFY(query.exec());
+
+				//loading legacy data must not write to the store
+				QCOMPARE(legacyStore.load(key), data);
+				QVERIFY(readPayload(database).startsWith("qbjs"));
+
+				//make the engine check the store again on the next start
+				QTRY_COMPARE(readUserVersion(database), 1);
+				QSqlQuery resetQuery(database.database());
+				QVERIFY(resetQuery.exec(QStringLiteral("PRAGMA user_version = 0")));
+			}
+			Setup::removeSetup(nName, true);
+		}
+
+		Setup setup;
+		TestLib::setup(setup);
+		setup.setLocalDir(nDir)
+				.setStorageMode(Setup::StorageMode::Inline);
+		setup.create(nName);
+		{
+			Defaults defaults{DefaultsPrivate::obtainDefaults(nName)};
+			LocalStore upgradeStore(defaults);
+			auto database = defaults.aquireDatabase(this);
+
+			//the engine upgrades the legacy data on startup
+			QTRY_VERIFY(readPayload(database).startsWith("qdsc"));
+			QTRY_COMPARE(readUserVersion(database), 1);
+			QCOMPARE(upgradeStore.load(key), data);
+			QCOMPARE(upgradeStore.loadAll(TestLib::TypeName), QList<QJsonObject>{data});
+		}
+		Setup::removeSetup(nName, true);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
 QTEST_MAIN(TestLocalStore)
 
 #include "tst_localstore.moc"
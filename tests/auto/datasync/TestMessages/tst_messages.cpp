@@ -5,6 +5,7 @@
 #include <QtDataSync/private/message_p.h>
 #include <QtDataSync/private/accessmessage_p.h>
 #include <QtDataSync/private/accountmessage_p.h>
+#include <QtDataSync/private/capabilitiesmessage_p.h>
 #include <QtDataSync/private/changedmessage_p.h>
 #include <QtDataSync/private/changemessage_p.h>
 #include <QtDataSync/private/devicechangemessage_p.h>
@@ -267,6 +268,9 @@ void TestMessages::addAllData()
 	addData<AccountMessage>([&]() {
 		return AccountMessage(QUuid::createUuid());
 	});
+	addData<CapabilitiesMessage>([&]() {
+		return CapabilitiesMessage(QVersionNumber(2));
+	});
 	addData<WelcomeMessage>([&]() {
 		WelcomeMessage msg(true);
 		msg.keyIndex = 42;
@@ -0,0 +1,8 @@
+include(../tests.pri)
+
+QT       += concurrent
+
+TARGET = tst_storecache
+
+SOURCES += \
+		tst_storecache.cpp
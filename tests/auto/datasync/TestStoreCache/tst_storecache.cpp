@@ -0,0 +1,415 @@
+#include <QString>
+#include <QtTest>
+#include <QCoreApplication>
+#include <QtConcurrent>
+#include <testlib.h>
+#include <testobject.h>
+#include <QtDataSync/private/storecache_p.h>
+using namespace QtDataSync;
+
+class TestStoreCache : public QObject
+{
+	Q_OBJECT
+
+private Q_SLOTS:
+	void testCost();
+	void testInsertLookup();
+	void testEviction();
+	void testOversized();
+	void testRemove();
+	void testClear();
+	void testValues();
+	void testScanAdmission();
+	void testStatistics();
+	void testMissing();
+	void testConcurrentAccess();
+
+private:
+	static QJsonObject data(int index);
+	static QList<ObjectKey> shardKeys(int count);
+};
+
+void TestStoreCache::testCost()
+{
+	QCOMPARE(StoreCache::cost(QJsonObject{}), 32);
+	QCOMPARE(StoreCache::cost(QJsonValue{42}), 8);
+	QCOMPARE(StoreCache::cost(QJsonValue{QStringLiteral("text")}), 16 + 8);
+	QCOMPARE(StoreCache::cost(QJsonValue{QJsonArray{1, 2}}), 32 + 2 * (8 + 8));
+	QCOMPARE(StoreCache::cost(QJsonObject{{QStringLiteral("id"), 1}}), 32 + 16 + 4 + 8);
+
+	//more content means higher costs
+	QVERIFY(StoreCache::cost(QJsonValue{QStringLiteral("a longer text")}) >
+			StoreCache::cost(QJsonValue{QStringLiteral("text")}));
+}
+
+void TestStoreCache::testInsertLookup()
+{
+	StoreCache cache{1024 * 1024};
+	QCOMPARE(cache.size(), 0);
+	QCOMPARE(cache.totalCost(), 0);
+
+	const auto key = TestLib::generateKey(42);
+	QJsonObject result;
+	QVERIFY(!cache.lookup(key, result));
+	QVERIFY(!cache.contains(key));
+
+	cache.insert(key, data(42));
+	QVERIFY(cache.contains(key));
+	QVERIFY(cache.lookup(key, result));
+	QCOMPARE(result, data(42));
+	QCOMPARE(cache.size(), 1);
+	QVERIFY(cache.totalCost() > StoreCache::cost(data(42)));
+
+	//replacing does not add a second entry
+	const auto cost = cache.totalCost();
+	cache.insert(key, data(42));
+	QCOMPARE(cache.size(), 1);
+	QCOMPARE(cache.totalCost(), cost);
+}
+
+void TestStoreCache::testEviction()
+{
+	//find the cost of a single entry
+	const auto keys = shardKeys(4);
+	int entryCost;
+	{
+		StoreCache probe{1024 * 1024};
+		probe.insert(keys[0], data(0));
+		entryCost = probe.totalCost();
+	}
+
+	//every shard can hold exactly 2 entries
+	StoreCache cache{StoreCache::ShardCount * (entryCost * 2 + entryCost / 2)};
+	cache.insert(keys[0], data(0));
+	cache.insert(keys[1], data(1));
+	QCOMPARE(cache.size(), 2);
+
+	//use the first, so the second is the least recently used one
+	QJsonObject result;
+	QVERIFY(cache.lookup(keys[0], result));
+	cache.insert(keys[2], data(2));
+	QCOMPARE(cache.size(), 2);
+	QVERIFY(cache.contains(keys[0]));
+	QVERIFY(!cache.contains(keys[1]));
+	QVERIFY(cache.contains(keys[2]));
+
+	//without lookups the oldest one goes
+	cache.insert(keys[3], data(3));
+	QVERIFY(!cache.contains(keys[0]));
+	QVERIFY(cache.contains(keys[2]));
+	QVERIFY(cache.contains(keys[3]));
+	QVERIFY(cache.totalCost() <= cache.maxCost());
+}
+
+void TestStoreCache::testOversized()
+{
+	StoreCache cache{StoreCache::ShardCount * 64};
+	const auto key = TestLib::generateKey(42);
+	cache.insert(key, data(42));
+	QVERIFY(!cache.contains(key));
+	QCOMPARE(cache.totalCost(), 0);
+
+	//a disabled cache never holds data
+	StoreCache disabled{0};
+	disabled.insert(key, QJsonObject{});
+	QVERIFY(!disabled.contains(key));
+}
+
+void TestStoreCache::testRemove()
+{
+	StoreCache cache{1024 * 1024};
+	for(auto i = 0; i < 10; i++)
+		cache.insert(TestLib::generateKey(i), data(i));
+	QCOMPARE(cache.size(), 10);
+
+	QVERIFY(cache.remove(TestLib::generateKey(0)));
+	QVERIFY(!cache.remove(TestLib::generateKey(0)));
+	QVERIFY(!cache.contains(TestLib::generateKey(0)));
+	QCOMPARE(cache.size(), 9);
+
+	cache.remove(TestLib::TypeName, {
+					 QString::number(1),
+					 QString::number(2),
+					 QString::number(42)
+				 });
+	QCOMPARE(cache.size(), 7);
+	QVERIFY(!cache.contains(TestLib::generateKey(1)));
+	QVERIFY(!cache.contains(TestLib::generateKey(2)));
+	QVERIFY(cache.contains(TestLib::generateKey(3)));
+}
+
+void TestStoreCache::testClear()
+{
+	StoreCache cache{1024 * 1024};
+	for(auto i = 0; i < 100; i++)
+		cache.insert(TestLib::generateKey(i), data(i));
+	QCOMPARE(cache.size(), 100);
+
+	cache.clear();
+	QCOMPARE(cache.size(), 0);
+	QCOMPARE(cache.totalCost(), 0);
+	QVERIFY(!cache.contains(TestLib::generateKey(0)));
+}
+
+void TestStoreCache::testValues()
+{
+	const auto key = TestLib::generateKey(42);
+	const auto typeId = qMetaTypeId<TestData>();
+	const auto json = data(42);
+	const auto value = QVariant::fromValue(TestLib::generateData(42));
+
+	//disabled by default
+	StoreCache disabled{1024 * 1024};
+	QVERIFY(!disabled.cachesValues());
+	disabled.insert(key, json);
+	disabled.insertValue(key, json, typeId, value);
+	QVariant result;
+	QVERIFY(!disabled.lookupValue(key, typeId, result));
+
+	StoreCache cache{1024 * 1024, true};
+	QVERIFY(cache.cachesValues());
+
+	//only attached to cached json data
+	cache.insertValue(key, json, typeId, value);
+	QVERIFY(!cache.lookupValue(key, typeId, result));
+	cache.insert(key, json);
+	const auto jsonCost = cache.totalCost();
+	cache.insertValue(key, json, typeId, value);
+	QVERIFY(cache.lookupValue(key, typeId, result));
+	QCOMPARE(result.value<TestData>(), TestLib::generateData(42));
+	QVERIFY(cache.totalCost() > jsonCost);
+	QVERIFY(!cache.lookupValue(key, qMetaTypeId<QVariantMap>(), result));
+
+	//values created from outdated data are ignored
+	cache.remove(key);
+	cache.insert(key, json);
+	cache.insertValue(key, data(24), typeId, value);
+	QVERIFY(!cache.lookupValue(key, typeId, result));
+
+	//replacing the data drops the values
+	cache.insertValue(key, json, typeId, value);
+	QVERIFY(cache.lookupValue(key, typeId, result));
+	cache.insert(key, data(24));
+	QVERIFY(!cache.lookupValue(key, typeId, result));
+	QCOMPARE(cache.totalCost(), jsonCost);
+
+	//removing drops the values
+	cache.insertValue(key, data(24), typeId, value);
+	QVERIFY(cache.lookupValue(key, typeId, result));
+	cache.remove(key);
+	QVERIFY(!cache.lookupValue(key, typeId, result));
+
+	//objects are never cached
+	QVERIFY(StoreCache::isValueCacheable(typeId));
+	QVERIFY(!StoreCache::isValueCacheable(qMetaTypeId<TestObject*>()));
+	cache.insert(key, json);
+	cache.insertValue(key, json, qMetaTypeId<TestObject*>(), QVariant::fromValue<TestObject*>(nullptr));
+	QVERIFY(!cache.lookupValue(key, qMetaTypeId<TestObject*>(), result));
+}
+
+void TestStoreCache::testScanAdmission()
+{
+	const auto keys = shardKeys(5);
+	int entryCost;
+	{
+		StoreCache probe{1024 * 1024};
+		probe.insert(keys[0], data(0));
+		entryCost = probe.totalCost();
+	}
+
+	//every shard can hold exactly 3 entries
+	StoreCache cache{StoreCache::ShardCount * (entryCost * 3 + entryCost / 2)};
+	cache.insert(keys[0], data(0));
+	cache.insert(keys[1], data(1));
+
+	//scans only fill free space
+	cache.insert(keys[2], data(2), true);
+	cache.insert(keys[3], data(3), true);
+	cache.insert(keys[4], data(4), true);
+	QCOMPARE(cache.size(), 3);
+	QVERIFY(cache.contains(keys[0]));
+	QVERIFY(cache.contains(keys[1]));
+	QVERIFY(cache.contains(keys[2]));
+
+	//scanned entries are evicted first, even if inserted last
+	cache.insert(keys[3], data(3));
+	QVERIFY(cache.contains(keys[0]));
+	QVERIFY(cache.contains(keys[1]));
+	QVERIFY(!cache.contains(keys[2]));
+	QVERIFY(cache.contains(keys[3]));
+
+	//scans do not replace or promote existing entries
+	cache.insert(keys[0], data(42), true);
+	QJsonObject result;
+	QVERIFY(cache.lookup(keys[0], result));
+	QCOMPARE(result, data(0));
+	cache.insert(keys[1], data(1), true);
+	cache.insert(keys[4], data(4));
+	QVERIFY(!cache.contains(keys[1]));
+	QVERIFY(cache.contains(keys[0]));
+}
+
+void TestStoreCache::testStatistics()
+{
+	const auto otherType = QByteArrayLiteral("OtherType");
+	const auto keys = shardKeys(3);
+	int entryCost;
+	{
+		StoreCache probe{1024 * 1024};
+		probe.insert(keys[0], data(0));
+		entryCost = probe.totalCost();
+	}
+	StoreCache cache{StoreCache::ShardCount * (entryCost * 2 + entryCost / 2)};
+
+	auto stats = cache.statistics(TestLib::TypeName);
+	QCOMPARE(stats.hits, 0ull);
+	QCOMPARE(stats.misses, 0ull);
+	QCOMPARE(stats.evictions, 0ull);
+	QCOMPARE(stats.cost, 0ll);
+	QCOMPARE(stats.entries, 0);
+
+	QJsonObject result;
+	QVERIFY(!cache.lookup(keys[0], result));
+	cache.insert(keys[0], data(0));
+	QVERIFY(cache.lookup(keys[0], result));
+	QVERIFY(cache.lookup(keys[0], result));
+	cache.insert(keys[1], data(1));
+	cache.insert(keys[2], data(2));
+	QVERIFY(!cache.lookup({otherType, keys[0].id}, result));
+
+	stats = cache.statistics(TestLib::TypeName);
+	QCOMPARE(stats.hits, 2ull);
+	QCOMPARE(stats.misses, 1ull);
+	QCOMPARE(stats.evictions, 1ull);
+	QCOMPARE(stats.cost, static_cast<qint64>(cache.totalCost()));
+	QCOMPARE(stats.entries, 2);
+	stats = cache.statistics(otherType);
+	QCOMPARE(stats.misses, 1ull);
+	QCOMPARE(stats.entries, 0);
+
+	//removing is not an eviction, and clearing keeps the counters
+	cache.remove(keys[1]);
+	stats = cache.statistics(TestLib::TypeName);
+	QCOMPARE(stats.evictions, 1ull);
+	QCOMPARE(stats.entries, 1);
+	cache.clear();
+	stats = cache.statistics(TestLib::TypeName);
+	QCOMPARE(stats.hits, 2ull);
+	QCOMPARE(stats.cost, 0ll);
+	QCOMPARE(stats.entries, 0);
+}
+
+void TestStoreCache::testMissing()
+{
+	StoreCache cache{1024 * 1024};
+	const auto key = TestLib::generateKey(42);
+	QJsonObject result;
+	auto missing = StoreCache::NotMissing;
+
+	cache.insertMissing(key, StoreCache::NoEntry, cache.generation(key));
+	QVERIFY(!cache.contains(key));
+	QVERIFY(!cache.lookup(key, result, &missing));
+	QCOMPARE(missing, StoreCache::NoEntry);
+	QCOMPARE(cache.size(), 1);
+
+	//storing data replaces the entry
+	cache.insert(key, data(42));
+	QVERIFY(cache.lookup(key, result, &missing));
+	QCOMPARE(missing, StoreCache::NotMissing);
+	QCOMPARE(result, data(42));
+
+	//never replaces data
+	cache.insertMissing(key, StoreCache::Deleted, cache.generation(key));
+	QVERIFY(cache.lookup(key, result));
+
+	//removing drops the entry
+	cache.remove(key);
+	cache.insertMissing(key, StoreCache::Deleted, cache.generation(key));
+	QVERIFY(!cache.lookup(key, result, &missing));
+	QCOMPARE(missing, StoreCache::Deleted);
+	cache.remove(key);
+	missing = StoreCache::NotMissing;
+	QVERIFY(!cache.lookup(key, result, &missing));
+	QCOMPARE(missing, StoreCache::NotMissing);
+
+	//outdated generations are ignored, even if the change did not touch a cached entry
+	auto generation = cache.generation(key);
+	cache.remove(key);
+	cache.insertMissing(key, StoreCache::NoEntry, generation);
+	QVERIFY(!cache.lookup(key, result, &missing));
+	QCOMPARE(missing, StoreCache::NotMissing);
+	generation = cache.generation(key);
+	cache.clear();
+	cache.insertMissing(key, StoreCache::NoEntry, generation);
+	QCOMPARE(cache.size(), 0);
+
+	//scans replace misses as well
+	cache.insertMissing(key, StoreCache::NoEntry, cache.generation(key));
+	cache.insert(key, data(42), true);
+	QVERIFY(cache.lookup(key, result));
+	QCOMPARE(result, data(42));
+}
+
+void TestStoreCache::testConcurrentAccess()
+{
+	const auto entryCount = 200;
+	StoreCache cache{StoreCache::ShardCount * 4096};
+
+	QAtomicInt mismatches{0};
+	QThreadPool pool;
+	pool.setMaxThreadCount(8);
+	QList<QFuture<void>> futures;
+	for(auto t = 0; t < 8; t++) {
+		futures.append(QtConcurrent::run(&pool, [&cache, &mismatches, t, entryCount](){
+			for(auto i = 0; i < 5000; i++) {
+				const auto index = (t * 31 + i) % entryCount;
+				const auto key = TestLib::generateKey(index);
+				QJsonObject result;
+				if(cache.lookup(key, result)) {
+					if(result != data(index))
+						mismatches.ref();
+				} else if(i % 7 == 0)
+					cache.remove(key);
+				else
+					cache.insert(key, data(index));
+			}
+		}));
+	}
+	for(auto &future : futures)
+		future.waitForFinished();
+
+	QCOMPARE(mismatches.load(), 0);
+	QVERIFY(cache.totalCost() <= cache.maxCost());
+	for(auto i = 0; i < entryCount; i++) {
+		const auto key = TestLib::generateKey(i);
+		QJsonObject result;
+		if(cache.lookup(key, result))
+			QCOMPARE(result, data(i));
+	}
+}
+
+QJsonObject TestStoreCache::data(int index)
+{
+	//constant size, so all entries have the same costs
+	auto json = TestLib::generateDataJson(index, QStringLiteral("data"));
+	json[QStringLiteral("id")] = 0;
+	json[QStringLiteral("index")] = QString::number(index).rightJustified(4, QLatin1Char('0'));
+	return json;
+}
+
+QList<ObjectKey> TestStoreCache::shardKeys(int count)
+{
+	//keys with the same id length that land in the same shard
+	QList<ObjectKey> keys;
+	const auto first = TestLib::generateKey(1000);
+	for(auto i = 1000; keys.size() < count; i++) {
+		const auto key = TestLib::generateKey(i);
+		if(qHash(key) % StoreCache::ShardCount == qHash(first) % StoreCache::ShardCount)
+			keys.append(key);
+	}
+	return keys;
+}
+
+QTEST_MAIN(TestStoreCache)
+
+#include "tst_storecache.moc"
@@ -27,6 +27,8 @@ private Q_SLOTS:
 	void testResolver_data();
 	void testResolver();
 
+	void testPayloadFormats();
+
 private:
 	LocalStore *store;
 	SyncController *controller;
@@ -581,6 +583,46 @@ void TestSyncController::testResolver()
 	}
 }
 
+void TestSyncController::testPayloadFormats()
+{
+	const auto key = TestLib::generateKey(77);
+	auto data = TestLib::generateDataJson(77);
+	data.insert(QStringLiteral("list"), QJsonArray{1, 2.5, QStringLiteral("three"), QJsonValue::Null});
+
+	try {
+		const auto jsonMessage = SyncHelper::combine(key, 3, data);
+		const auto cborMessage = SyncHelper::combine(key, 3, data, SyncHelper::CborPayload);
+		QVERIFY(jsonMessage != cborMessage);
+
+		//both formats must be understood, regardless of the negotiated one
+		for(const auto &message : {jsonMessage, cborMessage}) {
+			auto result = SyncHelper::extract(message);
+			QCOMPARE(std::get<0>(result), false);
+			QCOMPARE(std::get<1>(result), key);
+			QCOMPARE(std::get<2>(result), 3ull);
+			QCOMPARE(std::get<3>(result), data);
+			QCOMPARE(SyncHelper::jsonHash(std::get<3>(result)), SyncHelper::jsonHash(data));
+		}
+
+		//cbor from a newer format version is rejected
+		auto payload = SyncHelper::encodeCbor(data);
+		QVERIFY(SyncHelper::isCbor(payload));
+		auto ok = false;
+		QCOMPARE(SyncHelper::decodeCbor(payload, &ok), data);
+		QVERIFY(ok);
+		QJsonObject partial {
+			{QStringLiteral("list"), data.value(QStringLiteral("list"))}
+		};
+		QCOMPARE(SyncHelper::decodeCborProperties(payload, {QStringLiteral("list"), QStringLiteral("invalid")}, &ok), partial);
+		QVERIFY(ok);
+		payload[4] = 42;
+		SyncHelper::decodeCbor(payload, &ok);
+		QVERIFY(!ok);
+	} catch(QException &e) {
+		QFAIL(e.what());
+	}
+}
+
 QTEST_MAIN(TestSyncController)
 
 #include "tst_synccontroller.moc"
@@ -5,6 +5,7 @@ SUBDIRS += \
 	TestSetup \
 	TestLocalStore \
 	TestDataStore \
+	TestDataStoreModel \
 	TestDataTypeStore \
 	TestChangeController \
 	TestCryptoController \
@@ -14,7 +15,8 @@ SUBDIRS += \
 	TestKeystorePlugins \
 	TestRemoteConnector \
 	TestMigrationHelper \
-	TestEventCursor
+	TestEventCursor \
+	TestStoreCache
 
 include_server_tests {
 	SUBDIRS += \
@@ -24,6 +26,12 @@ include_server_tests {
 	IntegrationTest.depends += TestAppServer #ensure those two don't run in parallel
 }
 
+include_benchmarks {
+	SUBDIRS += \
+		BenchLocalStore \
+		BenchDataStoreModel
+}
+
 include_server_tests: message("Please run 'sudo docker-compose -f $$absolute_path(../../../tools/appserver/docker-compose.yaml) up -d' to start the services needed for server tests")
 
 for(subdir, SUBDIRS):!equals(subdir, "TestLib"): $${subdir}.depends += TestLib
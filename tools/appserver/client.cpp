@@ -131,6 +131,14 @@ void Client::notifyChanged()
 	});
 }
 
+void Client::notifyAccountVersion()
+{
+	run([this]() {
+		if(_state == Idle) //clients in other states get the version on login
+			sendCapabilities(false);
+	});
+}
+
 void Client::proofResult(bool success, const AcceptMessage &message)
 {
 	run([this, success, message](){
@@ -147,6 +155,7 @@ void Client::proofResult(bool success, const AcceptMessage &message)
 				}
 
 				auto pDevId = _cachedAccessRequest.partnerId;
+				_protocolVersion = _cachedAccessRequest.protocolVersion;
 				_database->addNewDeviceToUser(_deviceId,
 											  pDevId,
 											  _cachedAccessRequest.deviceName,
@@ -154,11 +163,13 @@ void Client::proofResult(bool success, const AcceptMessage &message)
 											  _cachedAccessRequest.signKey,
 											  _cachedAccessRequest.cryptAlgorithm,
 											  _cachedAccessRequest.cryptKey,
-											  _cachedFingerPrint);
+											  _cachedFingerPrint,
+											  _protocolVersion);
 				_cachedAccessRequest = AccessMessage();
 				_cachedFingerPrint.clear();
 
 				qDebug() << "Created new device and added to account of device" << pDevId;
+				sendCapabilities();
 				sendMessage(GrantMessage{message});
 				_state = Idle;
 				emit connected(_deviceId);
@@ -239,6 +250,8 @@ void Client::binaryMessageReceived(const QByteArray &message)
 				onKeyChange(Message::deserializeMessage<KeyChangeMessage>(stream));
 			else if(Message::isType<NewKeyMessage>(name))
 				onNewKey(Message::deserializeMessage<NewKeyMessage>(stream), stream);
+			else if(Message::isType<CapabilitiesMessage>(name))
+				onCapabilities(Message::deserializeMessage<CapabilitiesMessage>(stream));
 			else {
 				qWarning() << "Unknown message received:" << Message::typeName(name);
 				sendError({
@@ -358,6 +371,18 @@ void Client::sendMessage(const Message &message)
 							  Q_ARG(QByteArray, message.serialize()));
 }
 
+void Client::sendCapabilities(bool confirmed)
+{
+	//older clients do not know the message, and must not receive it
+	if(_protocolVersion >= CapabilitiesMessage::IntroducedVersion) {
+		CapabilitiesMessage message{_database->accountVersion(_deviceId)};
+		//during login the format applies right away, idle clients confirm it by echoing the message
+		if(confirmed)
+			_cborPayloads = message.hasCborPayloads();
+		sendMessage(message);
+	}
+}
+
 void Client::sendError(const ErrorMessage &message)
 {
 	_state = Error;
@@ -388,7 +413,8 @@ void Client::onRegister(const RegisterMessage &message, QDataStream &stream)
 											message.cryptAlgorithm,
 											message.cryptKey,
 											crypto->ownFingerprint(),
-											message.cmac);
+											message.cmac,
+											message.protocolVersion);
 	} catch(CryptoPP::SignatureVerificationFilter::SignatureVerificationFailed &e) {
 		qWarning() << "Authentication error:" << e.what();
 		throw ClientErrorException(ErrorMessage::AuthenticationError);
@@ -398,6 +424,8 @@ void Client::onRegister(const RegisterMessage &message, QDataStream &stream)
 	_logCat.reset(new QLoggingCategory(_catStr.constData()));
 
 	qDebug() << "Created new device and user accounts";
+	_protocolVersion = message.protocolVersion;
+	sendCapabilities();
 	sendMessage(AccountMessage{_deviceId});
 	_state = Idle;
 	emit connected(_deviceId);
@@ -426,8 +454,10 @@ void Client::onLogin(const LoginMessage &message, QDataStream &stream)
 	_catStr = catBaseStr() + _deviceId.toByteArray();
 	_logCat.reset(new QLoggingCategory(_catStr.constData()));
 
-	_database->updateLogin(_deviceId, message.deviceName);
+	_database->updateLogin(_deviceId, message.deviceName, message.protocolVersion);
 	qDebug() << "Device successfully logged in";
+	_protocolVersion = message.protocolVersion;
+	sendCapabilities();
 
 	//load changecount early to find out if data changed
 	_cachedChanges = _database->changeCount(_deviceId);
@@ -480,14 +510,23 @@ void Client::onChange(const ChangeMessage &message)
 {
 	checkIdle(message);
 
-	if(_database->addChange(_deviceId,
-							message.dataId,
-							message.keyIndex,
-							message.salt,
-							message.data))
+	switch(_database->addChange(_deviceId,
+								message.dataId,
+								message.keyIndex,
+								message.salt,
+								message.data,
+								_cborPayloads)) {
+	case DatabaseController::ChangeAdded:
 		sendMessage(ChangeAckMessage{message});
-	else
+		break;
+	case DatabaseController::ChangeRejected:
+		//not acked, the client uploads it again once it confirmed the older format
+		qDebug() << "Dropped cbor change, as the account contains older devices";
+		break;
+	case DatabaseController::QuotaHit:
 		sendError(ErrorMessage::QuotaHitError);
+		break;
+	}
 }
 
 void Client::onDeviceChange(const DeviceChangeMessage &message)
@@ -622,6 +661,13 @@ void Client::onNewKey(const NewKeyMessage &message, QDataStream &stream)
 		sendError(ErrorMessage::KeyIndexError);
 }
 
+void Client::onCapabilities(const CapabilitiesMessage &message)
+{
+	checkIdle(message);
+	_cborPayloads = message.hasCborPayloads();
+	qDebug() << "Client confirmed account version" << message.accountVersion;
+}
+
 void Client::triggerDownload(bool forceUpdate, bool skipNoChanges)
 {
 	auto updateChange = forceUpdate;
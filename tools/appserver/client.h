@@ -34,6 +34,7 @@
 #include "macupdatemessage_p.h"
 #include "keychangemessage_p.h"
 #include "newkeymessage_p.h"
+#include "capabilitiesmessage_p.h"
 
 class Client : public QObject
 {
@@ -53,6 +54,7 @@ public:
 public Q_SLOTS:
 	void dropConnection();
 	void notifyChanged();
+	void notifyAccountVersion();
 	void proofResult(bool success, const QtDataSync::AcceptMessage &message = {}); //empty key equals denied
 	void sendProof(const QtDataSync::ProofMessage &message);
 	void acceptDone(QUuid deviceId);
@@ -106,6 +108,8 @@ private:
 	//following members must only be accessed from within a task (to ensure thread safety)
 	State _state = Authenticating;
 	QUuid _deviceId;
+	QVersionNumber _protocolVersion;
+	bool _cborPayloads = false; //whether the client confirmed it uploads cbor payloads
 	QByteArray _loginNonce;
 	quint32 _cachedChanges = 0;
 	QList<quint64> _activeDownloads;
@@ -123,6 +127,7 @@ private:
 	void close();
 	void closeLater();
 	void sendMessage(const QtDataSync::Message &message);
+	void sendCapabilities(bool confirmed = true);
 	void sendError(const QtDataSync::ErrorMessage &message);
 	Q_INVOKABLE void doSend(const QByteArray &message);
 
@@ -140,6 +145,7 @@ private:
 	void onMacUpdate(const QtDataSync::MacUpdateMessage &message);
 	void onKeyChange(const QtDataSync::KeyChangeMessage &message);
 	void onNewKey(const QtDataSync::NewKeyMessage &message, QDataStream &stream);
+	void onCapabilities(const QtDataSync::CapabilitiesMessage &message);
 
 	void triggerDownload(bool forceUpdate = false, bool skipNoChanges = false);
 };
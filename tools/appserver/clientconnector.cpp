@@ -13,6 +13,9 @@ ClientConnector::ClientConnector(DatabaseController *database, QObject *parent)
 	connect(database, &DatabaseController::notifyChanged,
 			this, &ClientConnector::notifyChanged,
 			Qt::QueuedConnection);
+	connect(database, &DatabaseController::notifyAccountVersion,
+			this, &ClientConnector::notifyAccountVersion,
+			Qt::QueuedConnection);
 }
 
 void ClientConnector::recreateServer()
@@ -158,6 +161,13 @@ void ClientConnector::notifyChanged(QUuid deviceId)
 		client->notifyChanged();
 }
 
+void ClientConnector::notifyAccountVersion(QUuid deviceId)
+{
+	auto client = clients.value(deviceId);
+	if(client)
+		client->notifyAccountVersion();
+}
+
 void ClientConnector::verifySecret(QWebSocketCorsAuthenticator *authenticator)
 {
 	if(secret.isNull())
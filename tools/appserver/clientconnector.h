@@ -22,6 +22,7 @@ public:
 
 public Q_SLOTS:
 	void notifyChanged(QUuid deviceId);
+	void notifyAccountVersion(QUuid deviceId);
 
 Q_SIGNALS:
 	void disconnectAll();
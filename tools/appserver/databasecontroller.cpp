@@ -1,5 +1,6 @@
 #include "databasecontroller.h"
 #include "datasyncservice.h"
+#include "capabilitiesmessage_p.h"
 
 #include <QtCore/QJsonDocument>
 
@@ -106,7 +107,7 @@ void DatabaseController::cleanupDevices()
 	});
 }
 
-QUuid DatabaseController::addNewDevice(const QString &name, const QByteArray &signScheme, const QByteArray &signKey, const QByteArray &cryptScheme, const QByteArray &cryptKey, const QByteArray &fingerprint, const QByteArray &keyCmac)
+QUuid DatabaseController::addNewDevice(const QString &name, const QByteArray &signScheme, const QByteArray &signKey, const QByteArray &cryptScheme, const QByteArray &cryptKey, const QByteArray &fingerprint, const QByteArray &keyCmac, const QVersionNumber &protocolVersion)
 {
 	auto db = _threadStore.localData().database();
 	if(!db.transaction())
@@ -126,8 +127,8 @@ QUuid DatabaseController::addNewDevice(const QString &name, const QByteArray &si
 		auto deviceId = QUuid::createUuid();
 		Query createDeviceQuery(db);
 		createDeviceQuery.prepare(QStringLiteral("INSERT INTO devices "
-												 "(id, userid, name, signscheme, signkey, cryptscheme, cryptkey, fingerprint, keymac) "
-												 "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+												 "(id, userid, name, signscheme, signkey, cryptscheme, cryptkey, fingerprint, keymac, protocol) "
+												 "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
 		createDeviceQuery.addBindValue(deviceId);
 		createDeviceQuery.addBindValue(userId);
 		createDeviceQuery.addBindValue(name);
@@ -137,6 +138,7 @@ QUuid DatabaseController::addNewDevice(const QString &name, const QByteArray &si
 		createDeviceQuery.addBindValue(cryptKey);
 		createDeviceQuery.addBindValue(fingerprint);
 		createDeviceQuery.addBindValue(keyCmac);
+		createDeviceQuery.addBindValue(protocolVersion.majorVersion());
 		createDeviceQuery.exec();
 
 		if(!db.commit())
@@ -149,14 +151,15 @@ QUuid DatabaseController::addNewDevice(const QString &name, const QByteArray &si
 	}
 }
 
-void DatabaseController::addNewDeviceToUser(QUuid newDeviceId, QUuid partnerDeviceId, const QString &name, const QByteArray &signScheme, const QByteArray &signKey, const QByteArray &cryptScheme, const QByteArray &cryptKey, const QByteArray &fingerprint)
+void DatabaseController::addNewDeviceToUser(QUuid newDeviceId, QUuid partnerDeviceId, const QString &name, const QByteArray &signScheme, const QByteArray &signKey, const QByteArray &cryptScheme, const QByteArray &cryptKey, const QByteArray &fingerprint, const QVersionNumber &protocolVersion)
 {
 	auto db = _threadStore.localData().database();
+	auto oldVersion = accountVersion(partnerDeviceId);
 
 	Query createDeviceQuery(db);
 	createDeviceQuery.prepare(QStringLiteral("INSERT INTO devices "
-											 "(id, userid, name, signscheme, signkey, cryptscheme, cryptkey, fingerprint) "
-											 "VALUES(?, deviceUserId(?), ?, ?, ?, ?, ?, ?) "));
+											 "(id, userid, name, signscheme, signkey, cryptscheme, cryptkey, fingerprint, protocol) "
+											 "VALUES(?, deviceUserId(?), ?, ?, ?, ?, ?, ?, ?) "));
 	createDeviceQuery.addBindValue(newDeviceId);
 	createDeviceQuery.addBindValue(partnerDeviceId);
 	createDeviceQuery.addBindValue(name);
@@ -165,7 +168,10 @@ void DatabaseController::addNewDeviceToUser(QUuid newDeviceId, QUuid partnerDevi
 	createDeviceQuery.addBindValue(QString::fromUtf8(cryptScheme));
 	createDeviceQuery.addBindValue(cryptKey);
 	createDeviceQuery.addBindValue(fingerprint);
+	createDeviceQuery.addBindValue(protocolVersion.majorVersion());
 	createDeviceQuery.exec();
+
+	checkAccountVersion(newDeviceId, oldVersion);
 }
 
 AsymmetricCryptoInfo *DatabaseController::loadCrypto(QUuid deviceId, CryptoPP::RandomNumberGenerator &rng, QObject *parent)
@@ -189,16 +195,52 @@ AsymmetricCryptoInfo *DatabaseController::loadCrypto(QUuid deviceId, CryptoPP::R
 									parent);
 }
 
-void DatabaseController::updateLogin(QUuid deviceId, const QString &name)
+void DatabaseController::updateLogin(QUuid deviceId, const QString &name, const QVersionNumber &protocolVersion)
 {
 	auto db = _threadStore.localData().database();
+	auto oldVersion = accountVersion(deviceId);
 
 	Query updateNameQuery(db);
-	updateNameQuery.prepare(QStringLiteral("UPDATE devices SET name = ?, lastlogin = current_date "
+	updateNameQuery.prepare(QStringLiteral("UPDATE devices SET name = ?, protocol = ?, lastlogin = current_date "
 										   "WHERE id = ?"));
 	updateNameQuery.addBindValue(name);
+	updateNameQuery.addBindValue(protocolVersion.majorVersion());
 	updateNameQuery.addBindValue(deviceId);
 	updateNameQuery.exec();
+
+	checkAccountVersion(deviceId, oldVersion);
+}
+
+QVersionNumber DatabaseController::accountVersion(QUuid deviceId)
+{
+	auto db = _threadStore.localData().database();
+
+	Query accountVersionQuery(db);
+	accountVersionQuery.prepare(QStringLiteral("SELECT MIN(protocol) FROM devices "
+											   "WHERE userid = deviceUserId(?)"));
+	accountVersionQuery.addBindValue(deviceId);
+	accountVersionQuery.exec();
+	if(accountVersionQuery.first() && !accountVersionQuery.value(0).isNull())
+		return QVersionNumber{accountVersionQuery.value(0).toInt()};
+	else
+		return {};
+}
+
+void DatabaseController::checkAccountVersion(QUuid deviceId, const QVersionNumber &oldVersion)
+{
+	if(accountVersion(deviceId) == oldVersion)
+		return;
+
+	//the payload format of all other devices depends on the account version -> tell them
+	auto db = _threadStore.localData().database();
+	Query otherDevicesQuery(db);
+	otherDevicesQuery.prepare(QStringLiteral("SELECT id FROM devices "
+											 "WHERE userid = deviceUserId(?) AND id != ?"));
+	otherDevicesQuery.addBindValue(deviceId);
+	otherDevicesQuery.addBindValue(deviceId);
+	otherDevicesQuery.exec();
+	while(otherDevicesQuery.next())
+		emit notifyAccountVersion(otherDevicesQuery.value(0).toUuid());
 }
 
 bool DatabaseController::updateCmac(QUuid deviceId, quint32 keyIndex, const QByteArray &cmac)
@@ -284,6 +326,7 @@ void DatabaseController::removeDevice(QUuid deviceId, QUuid deleteId)
 		}
 
 		auto userId = userIdQuery.value(0).toULongLong();
+		auto oldVersion = accountVersion(deviceId);
 		Query deleteDeviceQuery(db);
 		deleteDeviceQuery.prepare(QStringLiteral("DELETE FROM devices "
 												 "WHERE id = ? AND userid = ?"));
@@ -301,21 +344,49 @@ void DatabaseController::removeDevice(QUuid deviceId, QUuid deleteId)
 		deleteUserQuery.addBindValue(userId);
 		deleteUserQuery.exec();
 
+		//removing the oldest device raises the account version -> tell all remaining devices, including the requesting one
+		QList<QUuid> notifyDevices;
+		Query remainingDevicesQuery(db);
+		remainingDevicesQuery.prepare(QStringLiteral("SELECT id, MIN(protocol) OVER () FROM devices "
+													 "WHERE userid = ?"));
+		remainingDevicesQuery.addBindValue(userId);
+		remainingDevicesQuery.exec();
+		while(remainingDevicesQuery.next()) {
+			if(QVersionNumber{remainingDevicesQuery.value(1).toInt()} != oldVersion)
+				notifyDevices.append(remainingDevicesQuery.value(0).toUuid());
+		}
+
 		if(!db.commit())
 			throw DatabaseException(db);
+		for(auto notifyId : notifyDevices)
+			emit notifyAccountVersion(notifyId);
 	} catch(...) {
 		db.rollback();
 		throw;
 	}
 }
 
-bool DatabaseController::addChange(QUuid deviceId, const QByteArray &dataId, const quint32 keyIndex, const QByteArray &salt, const QByteArray &data)
+DatabaseController::ChangeResult DatabaseController::addChange(QUuid deviceId, const QByteArray &dataId, const quint32 keyIndex, const QByteArray &salt, const QByteArray &data, bool cborPayload)
 {
 	auto db = _threadStore.localData().database();
 	if(!db.transaction())
 		throw DatabaseException(db);
 
 	try {
+		if(cborPayload) {
+			// lock the account, so no older device can be added before the change was stored
+			Query lockUserQuery(db);
+			lockUserQuery.prepare(QStringLiteral("SELECT id FROM users WHERE id = deviceUserId(?) FOR UPDATE"));
+			lockUserQuery.addBindValue(deviceId);
+			lockUserQuery.exec();
+
+			// older devices cannot read cbor payloads -> the client has to upload it again as json
+			if(accountVersion(deviceId) < CapabilitiesMessage::IntroducedVersion) {
+				db.rollback();
+				return ChangeRejected;
+			}
+		}
+
 		// delete the entry, in case it already exists. Will do nothing if nothing exists
 		Query deleteOldQuery(db);
 		deleteOldQuery.prepare(QStringLiteral("DELETE FROM datachanges WHERE deviceid = ? AND dataid = ?"));
@@ -361,14 +432,14 @@ bool DatabaseController::addChange(QUuid deviceId, const QByteArray &dataId, con
 
 		if(!db.commit())
 			throw DatabaseException(db);
-		return true;
+		return ChangeAdded;
 	} catch(DatabaseException &e) {
 		//check_violation from https://www.postgresql.org/docs/current/static/errcodes-appendix.html
 		auto isCheck = (e.error().nativeErrorCode() == QStringLiteral("23514"));
 		db.rollback();
 		if(isCheck) {
 			qWarning() << "Device" << deviceId << "hit quota limit";
-			return false;
+			return QuotaHit;
 		} else
 			throw;
 	} catch(...) {
@@ -807,7 +878,8 @@ void DatabaseController::initDatabase(quint64 quota, bool forceQuota)
 												  "		cryptkey	BYTEA NOT NULL, "
 												  "		fingerprint	BYTEA NOT NULL, "
 												  "		keymac		BYTEA, "
-												  "		lastlogin	DATE NOT NULL DEFAULT current_date "
+												  "		lastlogin	DATE NOT NULL DEFAULT current_date, "
+												  "		protocol	INT NOT NULL DEFAULT 1 "
 												  ")"))) {
 				throw DatabaseException(createDevices);
 			}
@@ -826,6 +898,13 @@ void DatabaseController::initDatabase(quint64 quota, bool forceQuota)
 			}
 
 			qDebug() << "Created table devices (+ functions and triggers)";
+		} else {
+			//devices created before protocol version 2 did not track their version
+			QSqlQuery updateDevices(db);
+			if(!updateDevices.exec(QStringLiteral("ALTER TABLE devices "
+												  "ADD COLUMN IF NOT EXISTS protocol INT NOT NULL DEFAULT 1"))) {
+				throw DatabaseException(updateDevices);
+			}
 		}
 
 		if(!db.tables().contains(QStringLiteral("datachanges"))) {
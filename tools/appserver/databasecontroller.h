@@ -8,6 +8,7 @@
 #include <QtCore/QThreadPool>
 #include <QtCore/QThreadStorage>
 #include <QtCore/QUuid>
+#include <QtCore/QVersionNumber>
 #include <QtCore/QJsonObject>
 #include <QtCore/QException>
 #include <QtCore/QTimer>
@@ -41,6 +42,12 @@ class DatabaseController : public QObject
 	Q_OBJECT
 
 public:
+	enum ChangeResult {
+		ChangeAdded,
+		ChangeRejected, //the account contains devices that cannot read cbor payloads
+		QuotaHit
+	};
+
 	explicit DatabaseController(QObject *parent = nullptr);
 
 	void initialize();
@@ -54,7 +61,8 @@ public:
 					   const QByteArray &cryptScheme,
 					   const QByteArray &cryptKey,
 					   const QByteArray &fingerprint,
-					   const QByteArray &keyCmac);
+					   const QByteArray &keyCmac,
+					   const QVersionNumber &protocolVersion);
 	void addNewDeviceToUser(QUuid newDeviceId,
 							QUuid partnerDeviceId,
 							const QString &name,
@@ -62,20 +70,23 @@ public:
 							const QByteArray &signKey,
 							const QByteArray &cryptScheme,
 							const QByteArray &cryptKey,
-							const QByteArray &fingerprint);
+							const QByteArray &fingerprint,
+							const QVersionNumber &protocolVersion);
 	QtDataSync::AsymmetricCryptoInfo *loadCrypto(QUuid deviceId,
 												 CryptoPP::RandomNumberGenerator &rng,
 												 QObject *parent = nullptr);
-	void updateLogin(QUuid deviceId, const QString &name);
+	void updateLogin(QUuid deviceId, const QString &name, const QVersionNumber &protocolVersion);
+	QVersionNumber accountVersion(QUuid deviceId);
 	bool updateCmac(QUuid deviceId, quint32 keyIndex, const QByteArray &cmac);
 	QList<std::tuple<QUuid, QString, QByteArray>> listDevices(QUuid deviceId); // (deviceid, name, fingerprint)
 	void removeDevice(QUuid deviceId, QUuid deleteId);
 
-	bool addChange(QUuid deviceId,
-				   const QByteArray &dataId,
-				   const quint32 keyIndex,
-				   const QByteArray &salt,
-				   const QByteArray &data);
+	ChangeResult addChange(QUuid deviceId,
+						   const QByteArray &dataId,
+						   const quint32 keyIndex,
+						   const QByteArray &salt,
+						   const QByteArray &data,
+						   bool cborPayload);
 	bool addDeviceChange(QUuid deviceId,
 						 QUuid targetId,
 						 const QByteArray &dataId,
@@ -96,6 +107,7 @@ public:
 
 Q_SIGNALS:
 	void notifyChanged(QUuid deviceId);
+	void notifyAccountVersion(QUuid deviceId);
 
 	void databaseInitDone(bool success);
 
@@ -122,6 +134,7 @@ private:
 
 	void initDatabase(quint64 quota, bool forceQuota);
 	void updateQuotaLimit(quint64 quota, bool forceQuota);
+	void checkAccountVersion(QUuid deviceId, const QVersionNumber &oldVersion);
 };
 
 #endif // DATABASECONTROLLER_H